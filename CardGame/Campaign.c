@@ -0,0 +1,232 @@
+/**
+* @file Campaign.c
+* Implementation of checkpointed simulation campaigns.
+*
+* @date 19.10.2026
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Campaign.h"
+#include "bench.h"
+#include "Simulator.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define CAMPAIGN_PATH_MAX 4096 // longest checkpoint path, including ".tmp"
+
+typedef struct {
+	uint32_t magic; // CAMPAIGN_MAGIC
+	uint16_t version; // CAMPAIGN_VERSION
+	uint16_t size; // sizeof(CampaignFile)
+	uint64_t seed;
+	uint64_t numGames;
+	uint64_t nextGame;
+	int32_t numPacks;
+	int32_t maxTurns;
+	CampaignStats stats;
+	uint64_t checksum; // FNV-1a of everything before it
+} CampaignFile;
+
+_Static_assert(sizeof(CampaignFile) == 104, "CampaignFile must have no padding");
+
+/**
+* 64-bit FNV-1a hash, catches a checkpoint that was cut short or damaged.
+*/
+static uint64_t Campaign_checksum(const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/**
+* @brief Sets up a campaign that has not played any games yet
+*
+* @param campaign The campaign to set up
+* @param seed Seed of the campaign, game g uses stream g of it
+* @param numGames Games in the whole campaign
+* @param numPacks Packs in the shoe of every game
+* @param maxTurns Turn limit of every game
+*/
+void Campaign_init(Campaign* campaign, uint64_t seed, uint64_t numGames, int numPacks, int maxTurns) {
+	memset(campaign, 0, sizeof(*campaign));
+	campaign->seed = seed;
+	campaign->numGames = numGames;
+	campaign->numPacks = numPacks;
+	campaign->maxTurns = maxTurns;
+}
+
+/**
+* @brief Plays the next batch of games and adds them to the totals
+*
+* @param campaign The campaign
+* @param batchSize Most games to play, fewer if the campaign ends first
+* @return Number of games played, 0 when the campaign is over, -1 if allocation or
+* writing the results fails or a game lost or doubled a card (see Game_checkCards)
+*/
+int Campaign_playBatch(Campaign* campaign, int batchSize) {
+	uint64_t left = campaign->numGames - campaign->nextGame;
+	if (left == 0) return 0;
+	int count = batchSize > 0 ? batchSize : CAMPAIGN_BATCH;
+	if ((uint64_t)count > left) count = (int)left;
+
+	Simulator* sim = Simulator_createRange(campaign->nextGame, count, campaign->numPacks, campaign->seed, campaign->maxTurns);
+	if (sim == NULL || Simulator_runInterleaved(sim, CAMPAIGN_WIDTH) < 0) {
+		Simulator_delete(sim);
+		return -1;
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (!Game_checkCards(&sim->games[i].game)) {
+			Simulator_delete(sim);
+			return -1;
+		}
+	}
+
+	CampaignStats* stats = &campaign->stats;
+	for (int i = 0; i < count; i++) {
+		const SimGame* game = &sim->games[i];
+		uint64_t turns = (uint64_t)game->turns;
+		stats->turns += turns;
+		stats->turnsSquared += turns * turns;
+		if (turns > stats->longest) stats->longest = turns;
+		if (game->game.status == win) {
+			stats->wins[game->game.turn]++; // the winner keeps the turn
+		}
+		else {
+			stats->unfinished++;
+		}
+	}
+	stats->games += (uint64_t)count;
+
+	int failed = 0;
+	if (campaign->results != NULL) {
+		GameResult* results = (GameResult*)malloc((size_t)count * sizeof(GameResult));
+		for (int i = 0; i < count && results != NULL; i++) {
+			GameResult_capture(&sim->games[i].game, campaign->nextGame + (uint64_t)i, sim->games[i].turns, &results[i]);
+		}
+		failed = results == NULL || ResultWriter_add(campaign->results, results, count) != 0;
+		free(results);
+	}
+	campaign->nextGame += (uint64_t)count;
+	Simulator_delete(sim);
+	return failed ? -1 : count;
+}
+
+/**
+* @brief Plays the rest of a campaign, saving a checkpoint now and then
+* @details A checkpoint is saved whenever checkpointSeconds have passed
+* since the last one, and once more at the end. To resume a stopped run,
+* Campaign_load the checkpoint and call this again.
+*
+* @param campaign The campaign, e.g. from Campaign_init or Campaign_load
+* @param batchSize Games per batch, 0 or less uses CAMPAIGN_BATCH
+* @param path Checkpoint file, NULL saves none
+* @param checkpointSeconds Time between checkpoints, 0 saves after every batch
+* @return 0, or -1 if allocation or saving a checkpoint fails
+*/
+int Campaign_run(Campaign* campaign, int batchSize, const char* path, double checkpointSeconds) {
+	double lastSave = Bench_seconds();
+	int played;
+	while ((played = Campaign_playBatch(campaign, batchSize)) > 0) {
+		if (path != NULL && Bench_seconds() - lastSave >= checkpointSeconds) {
+			if (Campaign_save(campaign, path) != 0) return -1;
+			lastSave = Bench_seconds();
+		}
+	}
+	if (played < 0) return -1;
+	return path != NULL ? Campaign_save(campaign, path) : 0;
+}
+
+/**
+* Replaces path with the file at temporary, in one step where the system allows it.
+*
+* @return 0, or -1 if renaming fails
+*/
+static int Campaign_replace(const char* temporary, const char* path) {
+#ifdef _WIN32
+	return MoveFileExA(temporary, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+#else
+	return rename(temporary, path) == 0 ? 0 : -1; // atomic on POSIX, even over an existing file
+#endif
+}
+
+/**
+* @brief Saves a checkpoint of a campaign
+* @details The checkpoint is written next to path first and only renamed
+* to path once it is on disk, so path always holds a complete checkpoint.
+*
+* @param campaign The campaign
+* @param path Checkpoint file, an existing one is replaced
+* @return 0, or -1 if the file cannot be written
+*/
+int Campaign_save(const Campaign* campaign, const char* path) {
+	char temporary[CAMPAIGN_PATH_MAX];
+	if (snprintf(temporary, sizeof(temporary), "%s.tmp", path) >= (int)sizeof(temporary)) return -1;
+
+	CampaignFile file;
+	memset(&file, 0, sizeof(file));
+	file.magic = CAMPAIGN_MAGIC;
+	file.version = CAMPAIGN_VERSION;
+	file.size = (uint16_t)sizeof(CampaignFile);
+	file.seed = campaign->seed;
+	file.numGames = campaign->numGames;
+	file.nextGame = campaign->nextGame;
+	file.numPacks = campaign->numPacks;
+	file.maxTurns = campaign->maxTurns;
+	file.stats = campaign->stats;
+	file.checksum = Campaign_checksum(&file, offsetof(CampaignFile, checksum));
+
+	FILE* out = fopen(temporary, "wb");
+	if (out == NULL) return -1;
+	int failed = fwrite(&file, sizeof(file), 1, out) != 1 || fflush(out) != 0;
+#ifdef _WIN32
+	failed |= _commit(_fileno(out)) != 0;
+#else
+	failed |= fsync(fileno(out)) != 0;
+#endif
+	failed |= fclose(out) != 0;
+	if (failed || Campaign_replace(temporary, path) != 0) {
+		remove(temporary);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+* @brief Loads a campaign from a checkpoint
+*
+* @param campaign Receives the campaign without a result writer, unchanged if loading fails
+* @param path Checkpoint file
+* @return 0, or -1 if the file is missing, damaged or not a checkpoint
+*/
+int Campaign_load(Campaign* campaign, const char* path) {
+	FILE* in = fopen(path, "rb");
+	if (in == NULL) return -1;
+	CampaignFile file;
+	int complete = fread(&file, sizeof(file), 1, in) == 1;
+	fclose(in);
+	if (!complete || file.magic != CAMPAIGN_MAGIC || file.version != CAMPAIGN_VERSION || file.size != sizeof(CampaignFile) ||
+		file.checksum != Campaign_checksum(&file, offsetof(CampaignFile, checksum)) || file.nextGame > file.numGames) {
+		return -1;
+	}
+
+	campaign->seed = file.seed;
+	campaign->numGames = file.numGames;
+	campaign->nextGame = file.nextGame;
+	campaign->numPacks = file.numPacks;
+	campaign->maxTurns = file.maxTurns;
+	campaign->stats = file.stats;
+	campaign->results = NULL;
+	return 0;
+}
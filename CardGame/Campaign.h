@@ -0,0 +1,65 @@
+/**
+ * @file Campaign.h
+ * Provides interface for long simulation campaigns that survive being
+ * stopped: many games played in batches on a Simulator, with the totals
+ * saved to a checkpoint file that a later run resumes from.
+ *
+ * Game g of a campaign (counting from 0) shuffles with stream g of the
+ * campaign's seed, the same as game g of a Simulator created with seed.
+ * The generator of every game is therefore known from its number alone,
+ * and the position of the whole campaign in its random streams is just
+ * the number of the next game. A checkpoint stores that number with the
+ * settings and the totals, 104 bytes in all, and resuming from it gives
+ * bit-identical totals to a run that was never stopped, whatever the
+ * batch size or checkpoint interval of either run.
+ *
+ * A checkpoint is written to "<path>.tmp", flushed to disk and then
+ * renamed over the old one, so a run killed while saving leaves the
+ * previous checkpoint intact. Numbers are stored in the byte order of the
+ * machine that wrote the file, like scenario files.
+ *
+ * If results is set, the outcome of every game is also added to a result
+ * file (ResultFile.h), numbered with the game's stream. The writer is not
+ * part of the checkpoint; a resumed run writes the games it plays to a
+ * result file of its own.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef CAMPAIGN_H
+#define CAMPAIGN_H
+
+#include <stdint.h>
+#include "ResultFile.h"
+
+#define CAMPAIGN_MAGIC 0x504B4343u // "CCKP" when read as little endian
+#define CAMPAIGN_VERSION 2
+#define CAMPAIGN_BATCH 16384 // default games per Simulator batch
+#define CAMPAIGN_WIDTH 16 // games in flight in Simulator_runInterleaved
+
+typedef struct {
+	uint64_t games; // games played
+	uint64_t turns; // turns played over all games
+	uint64_t wins[2]; // games won by player 1 and player 2
+	uint64_t unfinished; // games stopped at the turn limit
+	uint64_t turnsSquared; // sum of the squared turns of every game, for the variance
+	uint64_t longest; // most turns of any game
+} CampaignStats;
+
+typedef struct {
+	uint64_t seed; // game g uses stream g of this seed
+	uint64_t numGames; // games in the whole campaign
+	uint64_t nextGame; // first game not played yet
+	int numPacks; // packs in the shoe of every game
+	int maxTurns; // turn limit of every game
+	CampaignStats stats; // totals of the games played so far
+	ResultWriter* results; // receives the result of every game played, NULL for none
+} Campaign;
+
+void Campaign_init(Campaign* campaign, uint64_t seed, uint64_t numGames, int numPacks, int maxTurns);
+int Campaign_playBatch(Campaign* campaign, int batchSize);
+int Campaign_run(Campaign* campaign, int batchSize, const char* path, double checkpointSeconds);
+int Campaign_save(const Campaign* campaign, const char* path);
+int Campaign_load(Campaign* campaign, const char* path);
+
+#endif
@@ -6,6 +6,7 @@
 */
 
 #include "Card.h"
+#include "CardFormat.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -16,6 +17,32 @@ int rankCount = sizeof(rankNames) / sizeof(rankNames[0]);
 
 const Card INVALID_CARD = { INVALID_SUIT, INVALID_RANK }; // represents a non-usable card. return it whenever a "Card" type function encounters an error.
 
+// every rank of one suit, in rank order
+#define PACK_SUIT(suit) \
+	{ suit, TWO }, { suit, THREE }, { suit, FOUR }, { suit, FIVE }, { suit, SIX }, { suit, SEVEN }, { suit, EIGHT }, \
+	{ suit, NINE }, { suit, TEN }, { suit, JACK }, { suit, QUEEN }, { suit, KING }, { suit, ACE }
+
+// one complete pack sorted by suit then rank, used as the template for filling decks
+const Card orderedPack[PACK_SIZE] = { PACK_SUIT(CLUB), PACK_SUIT(SPADE), PACK_SUIT(HEART), PACK_SUIT(DIAMOND) };
+
+// random 64-bit key of every packed card, then one for any invalid card; see Card_key
+const uint64_t cardKeys[PACK_SIZE + 1] = {
+	0xfddca3f7dc481b11ull, 0x6a7f3e068f4e8a54ull, 0xe6c55224dd105545ull, 0x0c6e21b1e4b7f28bull,
+	0xbe172bcfe4a03204ull, 0x849c49b787a30d09ull, 0xa1b896cbe345913cull, 0x28ae7d441ef6e7dbull,
+	0xfe7cfc213ad55c6full, 0x5cc7920b2d5893cfull, 0x3065b45944a28929ull, 0x69c05313bfd34b2full,
+	0x884431de8c58b9ebull, 0xb3520e12dbc5207cull, 0xb346b850bcf0043bull, 0x797ba7ec530090abull,
+	0xcc033b3ec4979d0full, 0x161e0f0bcaaceaa1ull, 0x0ec474a440ee590aull, 0x2e5b711061ecdde3ull,
+	0xe216ce876bcd8e7aull, 0x7a0ba5208f0fe83bull, 0xe47b7117b6231046ull, 0x376061dabe9b6f72ull,
+	0x282ccc25014f820dull, 0x206a6297f6e163f3ull, 0xdb02921379c061dbull, 0x812160b7d2a9528bull,
+	0x686c5b339ed867b6ull, 0xfc20b9940f7fd80bull, 0xe257361869d4937full, 0xedf447d7d5530202ull,
+	0x3539481e7b787cf1ull, 0x077c25c583ef5a06ull, 0xe99fe78d0b0a31bdull, 0x77ac73ba866d6880ull,
+	0x2d18573fea86dc83ull, 0xe2aeffec275225bfull, 0x2af67e3b643df1d0ull, 0x1a39298e332aaa1full,
+	0x5409fd7fe031f6c6ull, 0x88dcfd072206f379ull, 0xb47c2e743ba55a86ull, 0xb01f296f22e530d0ull,
+	0xf1818e1c029c4f28ull, 0xf225e46466b89f41ull, 0x392b5bcfceaae6f5ull, 0x0898e0b420079c3bull,
+	0xa9375964f741c324ull, 0x9a424655dd7584e0ull, 0xefcba430483297f7ull, 0xaa0f08ece174853eull,
+	0x38283d4db88c37afull
+};
+
 /**
 * Allocates and initializes a single card structure.
 * 
@@ -67,6 +94,9 @@ Card* Card_create2(Card* newCard) {
 * 
 */
 void Card_print(Card* card) {
-	printf("Card: %s-%s\n", suitNames[card->suit], rankNames[card->rank]);
+	char line[32] = "Card: ";
+	size_t length = 6 + CardFormat_card(*card, formatLong, line + 6, sizeof(line) - 7);
+	line[length++] = '\n';
+	fwrite(line, 1, length, stdout);
 }
 
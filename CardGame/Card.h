@@ -15,6 +15,10 @@
 #ifndef CARD_H
 #define CARD_H
 
+#include <stdint.h>
+
+#define PACK_SIZE 52 // number of cards in one complete pack
+
 typedef enum {
 	CLUB,
 	SPADE,
@@ -46,7 +50,12 @@ typedef struct {
 	Rank rank;
 } Card;
 
+// a card packed into one byte: suit * 13 + rank, 0..51 for valid cards
+typedef unsigned char PackedCard;
+
 extern const Card INVALID_CARD;
+extern const Card orderedPack[PACK_SIZE];
+extern const uint64_t cardKeys[PACK_SIZE + 1];
 extern const char* suitNames[4];
 extern int suitCount; 
 extern const char* rankNames[13];
@@ -57,4 +66,28 @@ void Card_create(Card* card, Suit suit, Rank rank);
 Card* Card_create2(Card* newCard);
 void Card_print(Card* card);
 
+/**
+* Packs a valid card into one byte.
+*/
+static inline PackedCard Card_pack(Card card) {
+	return (PackedCard)(card.suit * 13 + card.rank);
+}
+
+/**
+* Unpacks a byte made by Card_pack.
+*/
+static inline Card Card_unpack(PackedCard packed) {
+	return orderedPack[packed]; // orderedPack is exactly the cards in packed order
+}
+
+/**
+* Returns the random key of a card, the same for every copy of it.
+* Sums of keys are multiset checksums: adding a card adds its key and
+* removing it subtracts it again, in any order, and two different sets of
+* cards practically never have the same sum. Invalid cards share one key.
+*/
+static inline uint64_t Card_key(Card card) {
+	return (unsigned)card.suit < 4 && (unsigned)card.rank < 13 ? cardKeys[Card_pack(card)] : cardKeys[PACK_SIZE];
+}
+
 #endif
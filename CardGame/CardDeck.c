@@ -9,8 +9,228 @@
 #include <stdio.h>
 #include "CardDeck.h"
 #include "Card.h"
+#include "CardFormat.h"
+#include "Instrument.h"
+#include "Trace.h"
+#include "Rng.h"
 #include <stdbool.h>
 #include <time.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+#ifdef _MSC_VER
+#define CARDDECK_THREAD_LOCAL __declspec(thread)
+#else
+#define CARDDECK_THREAD_LOCAL _Thread_local
+#endif
+
+/************************************************************
+* Node Pool
+* Card nodes are carved out of slabs instead of being malloc'd one
+* at a time. Released nodes go onto the releasing thread's free list
+* and are handed out again before any new slab is allocated.
+* When a thread exits, its free list goes to the shared pool, which a
+* thread takes from before it allocates a slab. So the slabs only ever
+* grow to the most nodes in use at once plus the free lists of the
+* running threads, however many threads come and go. The slabs are
+* freed at exit.
+************************************************************/
+
+#define CARDNODE_SLAB_NODES 256 // nodes per slab for single node allocations
+
+typedef struct CardSlab {
+	struct CardSlab* next; // next slab on the global list
+	CardNode nodes[]; // the nodes carved out of this slab
+} CardSlab;
+
+static _Atomic(CardSlab*) cardSlabs = NULL; // every slab ever allocated, freed at exit
+static atomic_llong cardSlabNodes = 0; // nodes in all slabs
+static CARDDECK_THREAD_LOCAL CardNode* freeNodes = NULL; // this thread's released nodes
+static CARDDECK_THREAD_LOCAL int freeNodeCount = 0; // length of freeNodes
+static CARDDECK_THREAD_LOCAL int freeNodesOwned = 0; // set once the thread's free list is handed on at its exit
+
+static once_flag cardPoolOnce = ONCE_FLAG_INIT;
+static tss_t cardPoolKey; // its destructor hands an exiting thread's free list to the shared pool
+static mtx_t cardPoolLock; // guards the three below
+static CardNode* sharedNodes = NULL; // nodes left by threads that exited
+static CardNode* sharedTail = NULL; // last node of sharedNodes
+static int sharedNodeCount = 0; // length of sharedNodes
+
+/**
+* Moves the calling thread's free list to the shared pool.
+* Runs as the destructor of cardPoolKey when a thread exits.
+*/
+static void CardPool_threadExit(void* unused) {
+	if (freeNodes == NULL) return;
+	CardNode* tail = freeNodes;
+	while (tail->successor != NULL) tail = tail->successor;
+
+	mtx_lock(&cardPoolLock);
+	tail->successor = sharedNodes;
+	sharedNodes = freeNodes;
+	if (sharedTail == NULL) sharedTail = tail;
+	sharedNodeCount += freeNodeCount;
+	mtx_unlock(&cardPoolLock);
+	freeNodes = NULL;
+	freeNodeCount = 0;
+}
+
+/**
+* Frees every slab. Runs at exit, when no deck is used any more.
+*/
+static void CardPool_free(void) {
+	CardSlab* slab = atomic_exchange(&cardSlabs, NULL);
+	atomic_store(&cardSlabNodes, 0);
+	while (slab != NULL) {
+		CardSlab* next = slab->next;
+		free(slab);
+		slab = next;
+	}
+	freeNodes = NULL;
+	freeNodeCount = 0;
+	sharedNodes = sharedTail = NULL;
+	sharedNodeCount = 0;
+}
+
+static void CardPool_init(void) {
+	mtx_init(&cardPoolLock, mtx_plain);
+	tss_create(&cardPoolKey, CardPool_threadExit);
+	atexit(CardPool_free);
+}
+
+/**
+* Makes sure the calling thread's free list goes to the shared pool when the thread exits.
+*/
+static void CardPool_own(void) {
+	call_once(&cardPoolOnce, CardPool_init);
+	tss_set(cardPoolKey, &freeNodes); // any value but NULL makes the destructor run
+	freeNodesOwned = 1;
+}
+
+/**
+* Moves the whole shared pool onto the calling thread's free list.
+*/
+static void CardPool_take(void) {
+	call_once(&cardPoolOnce, CardPool_init);
+	mtx_lock(&cardPoolLock);
+	if (sharedNodes != NULL) {
+		sharedTail->successor = freeNodes;
+		freeNodes = sharedNodes;
+		freeNodeCount += sharedNodeCount;
+		sharedNodes = sharedTail = NULL;
+		sharedNodeCount = 0;
+	}
+	mtx_unlock(&cardPoolLock);
+}
+
+/**
+* Allocates one slab of count nodes and records it on the slab list.
+* The nodes are left unlinked.
+*/
+static CardSlab* CardSlab_create(int count) {
+	CardSlab* slab = (CardSlab*)malloc(sizeof(CardSlab) + (size_t)count * sizeof(CardNode));
+	if (slab == NULL) return NULL;
+
+	atomic_fetch_add(&cardSlabNodes, count);
+	slab->next = atomic_load(&cardSlabs);
+	while (!atomic_compare_exchange_weak(&cardSlabs, &slab->next, slab)) {
+	}
+	return slab;
+}
+
+/**
+* Takes one node from the free list, refilling it from the shared pool or
+* a new slab when empty.
+*
+* @return The node, or NULL if no memory is available
+*/
+static CardNode* CardNode_new(void) {
+	if (freeNodes == NULL) {
+		if (!freeNodesOwned) CardPool_own();
+		CardPool_take();
+	}
+	if (freeNodes == NULL) {
+		CardSlab* slab = CardSlab_create(CARDNODE_SLAB_NODES);
+		if (slab == NULL) return NULL;
+
+		for (int i = 0; i < CARDNODE_SLAB_NODES - 1; i++) {
+			slab->nodes[i].successor = &slab->nodes[i + 1];
+		}
+		slab->nodes[CARDNODE_SLAB_NODES - 1].successor = NULL;
+		freeNodes = slab->nodes;
+		freeNodeCount = CARDNODE_SLAB_NODES;
+	}
+
+	CardNode* node = freeNodes;
+	freeNodes = node->successor;
+	freeNodeCount--;
+	return node;
+}
+
+/**
+* Returns a node to the calling thread's free list.
+*/
+static void CardNode_release(CardNode* node) {
+	if (!freeNodesOwned) CardPool_own();
+	node->successor = freeNodes;
+	freeNodes = node;
+	freeNodeCount++;
+}
+
+/**
+* @brief Returns how many card nodes the pool has allocated, in use or free
+*
+* @return The number of nodes in all slabs
+*/
+long long CardDeck_poolNodes(void) {
+	return atomic_load(&cardSlabNodes);
+}
+
+/**
+* Takes count nodes already linked in order, with the last node's
+* successor set to NULL. Released nodes are reused first; whatever
+* is still missing comes from a single new slab, so building a large
+* shoe costs at most one malloc.
+*
+* @param count Number of nodes, must be at least 1
+* @param last Receives the last node of the run
+* @return The first node of the run, or NULL if no memory is available
+*/
+static CardNode* CardNode_newRun(int count, CardNode** last) {
+	if (count > freeNodeCount) CardPool_take();
+	int fromSlab = count > freeNodeCount ? count - freeNodeCount : 0;
+	CardSlab* slab = NULL;
+
+	if (fromSlab > 0) {
+		slab = CardSlab_create(fromSlab);
+		if (slab == NULL) return NULL;
+
+		for (int i = 0; i < fromSlab - 1; i++) {
+			slab->nodes[i].successor = &slab->nodes[i + 1];
+		}
+		slab->nodes[fromSlab - 1].successor = NULL;
+	}
+
+	// the free list is already linked: cut its first (count - fromSlab) nodes off
+	CardNode* first;
+	CardNode* tail = NULL;
+	if (count - fromSlab > 0) {
+		first = freeNodes;
+		tail = freeNodes;
+		for (int i = 1; i < count - fromSlab; i++) {
+			tail = tail->successor;
+		}
+		freeNodes = tail->successor;
+		freeNodeCount -= count - fromSlab;
+		tail->successor = slab != NULL ? slab->nodes : NULL;
+	}
+	else {
+		first = slab->nodes;
+	}
+
+	*last = slab != NULL ? &slab->nodes[fromSlab - 1] : tail;
+	return first;
+}
 
 /************************************************************
 * Linked List Operations
@@ -24,24 +244,60 @@
 * Used for player hands, and the temporary deck during shuffling.
 */
 CardDeck* CardDeck_create() {
+	INSTR_FUNC(CardDeck_create);
 	CardDeck* deck = (CardDeck*)malloc(sizeof(CardDeck)); // create and allocate for deck
 	if (deck == NULL) return NULL; // return null if memory allocation fails
+	INSTR_ALLOC(CardDeck_create);
 	
-	deck->head = (CardNode*)malloc(sizeof(CardNode)); // create and allocate for head node of deck
+	deck->head = CardNode_new(); // create and allocate for head node of deck
 	if (deck->head == NULL) { // free deck and return null if memory allocation for deck head fails
 		free(deck);
+		INSTR_FREE(CardDeck_create);
 		return NULL;
 	}
+	INSTR_ALLOC(CardDeck_create);
 
 	// code for actually initializing an empty deck
 	deck->head->successor = NULL; // creates tail of deck
 	deck->current = deck->head; // sets current node to point towards head node
+	deck->tally = 0; // no cards yet
 	return deck;
 }
 
+/**
+* Initializes an empty card deck that is not allocated on its own,
+* e.g. the decks inside a Game.
+*
+* @param deck Card deck to be initialized.
+* @return ok, illegalCard if deck is NULL, noMemory if the head node cannot be allocated
+*/
+deckError CardDeck_init(CardDeck* deck) {
+	if (deck == NULL) return illegalCard;
+	deck->head = CardNode_new(); // create and allocate for head node of deck
+	if (deck->head == NULL) {
+		deck->current = NULL;
+		return noMemory;
+	}
+	deck->head->successor = NULL; // creates tail of deck
+	deck->current = deck->head; // sets current node to point towards head node
+	deck->tally = 0;
+	return ok;
+}
+
+/**
+* Returns the tally of one complete pack.
+*/
+static uint64_t CardDeck_packTally(void) {
+	uint64_t tally = 0;
+	for (int c = 0; c < PACK_SIZE; c++) tally += cardKeys[c];
+	return tally;
+}
+
 /**
 * @brief Fills the deck with cards
 * @details This method takes in the pack number prompted by the user.
+* The cards are copied from the precomputed orderedPack into one
+* pre-linked run of nodes, which is then linked in after the current node.
 *  
 * Formula: numPacks=numPacks*52 
 * Each pack is 52 cards
@@ -50,45 +306,41 @@ CardDeck* CardDeck_create() {
 * @param deck Pointer to the CardDeck
 * @param numPacks Number of card packs to add to the deck
 * @author Diana Ogualiri 24353051
-* @return Pointer to the filled CardDeck
+* @return Pointer to the filled CardDeck, NULL if no memory is available
 * 
 * 
 * 
 * 
 **/
 CardDeck* CardDeck_fillDeck(CardDeck* deck,int numPacks) {
+	INSTR_FUNC(CardDeck_fillDeck);
 	//creating a deck with a number the user chooses
 
-	
-	
-	Card* newCard=malloc(sizeof(Card));
+	if (deck == NULL || deck->current == NULL) return NULL; // nowhere to insert the cards
+	if (numPacks <= 0) return deck; // nothing to add
 
-	if(newCard==NULL){
+	// every node of the shoe comes from one run, so this is at most one allocation
+	CardNode* last;
+	CardNode* node = CardNode_newRun(numPacks * PACK_SIZE, &last);
+	if (node == NULL) {
 		return NULL; //return null if memory allocation fails
-	}	
-	//looping through elements in pack
-	//adding cards with suits and ranks 
-	//then putting each card into the deck
+	}
+	INSTR_ALLOC(CardDeck_fillDeck);
+	CardNode* first = node;
 
-	//Each card is created and inserted after the current node using insertAfter function
+	//stamping the precomputed ordered pack into the run, once per pack
 	for (int i = 0; i < numPacks; i++) {
-		
-		 for (int suit = 0; suit < suitCount; suit++) {
-			 for (int rank = 0; rank < rankCount; rank++) {
-
-				 newCard->rank = rank;//inserts rank into the card
-				 newCard->suit = suit;//inserts suit into the card
-				
-				 CardDeck_insertAfter(newCard, deck);//each card is inserted after the current node
-				 CardDeck_gotoNextCard(deck);//goes to next card after insertion
-
-
-			 }
-			
-
-		 }//each card is filled 
-		
+		for (int c = 0; c < PACK_SIZE; c++) {
+			node->card = orderedPack[c];
+			node = node->successor;
+		}
 	}
+
+	//linking the run in after the current node, current ends on the last card like repeated insertAfter + gotoNextCard
+	last->successor = deck->current->successor;
+	deck->current->successor = first;
+	deck->current = last;
+	deck->tally += (uint64_t)numPacks * CardDeck_packTally();
 	return deck;// deck returned
 }
 
@@ -102,18 +354,19 @@ CardDeck* CardDeck_fillDeck(CardDeck* deck,int numPacks) {
 * @return Enum value indicating allocation success status
 */
 deckError CardDeck_insertAfter(Card* card, CardDeck* deck) {
+	INSTR_FUNC(CardDeck_insertAfter);
 	if (deck->current == NULL) return illegalCard; // if current node is somehow null (maybe its a tail), return error
 
-	CardNode* newNode = (CardNode*)malloc(sizeof(CardNode)); // create and allocate newNode
-	
-
+	CardNode* newNode = CardNode_new(); // create and allocate newNode
 	if (newNode == NULL) return noMemory; // return noMemory if allocation fails
+	INSTR_ALLOC(CardDeck_insertAfter);
 	
 	// begin inserting card after current node
 	newNode->card = *card; // associate card with newNode
 
 	newNode->successor = deck->current->successor; // point newNode's successor towards next node
 	deck->current->successor = newNode; // point current node's successor towards newNode
+	deck->tally += Card_key(*card);
 
 	return ok;
 }
@@ -124,11 +377,14 @@ deckError CardDeck_insertAfter(Card* card, CardDeck* deck) {
 * @param deck The deck to delete the card from
 */
 deckError CardDeck_deleteNext(CardDeck* deck) {
+	INSTR_FUNC(CardDeck_deleteNext);
 	CHECK_DECK_VALID(deck); // return invalidCard if current card or next card is invalid
 	
 	CardNode* toDelete = deck->current->successor; // save pointer of next node
 	deck->current->successor = toDelete->successor; // point current node's successor to the node after the node to be deleted
-	free(toDelete); // deallocate deleted node from memory
+	deck->tally -= Card_key(toDelete->card);
+	CardNode_release(toDelete); // deallocate deleted node from memory
+	INSTR_FREE(CardDeck_deleteNext);
 	toDelete = NULL; // clear the pointer
 	return ok;
 }
@@ -139,6 +395,7 @@ deckError CardDeck_deleteNext(CardDeck* deck) {
 * @param deck Card deck to be deleted.
 */
 void CardDeck_delete(CardDeck* deck) {
+	INSTR_FUNC(CardDeck_delete);
 	if (deck == NULL) return; // if deck doesn't exist, do nothing
 
 	// set current node of deck towards head node
@@ -150,8 +407,29 @@ void CardDeck_delete(CardDeck* deck) {
 	}
 
 	// only the deck, head, and tail are left, so we can delete them
-	if(deck->head != NULL) free(deck->head);
+	if(deck->head != NULL) CardNode_release(deck->head);
 	free(deck);
+	INSTR_FREE(CardDeck_delete);
+	INSTR_FREE(CardDeck_delete);
+}
+
+/**
+* Frees all nodes of a deck set up with CardDeck_init(),
+* but not the deck itself.
+*
+* @param deck Card deck to be destroyed.
+*/
+void CardDeck_destroy(CardDeck* deck) {
+	if (deck == NULL) return;
+	CardNode* node = deck->head;
+	while (node != NULL) {
+		CardNode* next = node->successor;
+		CardNode_release(node);
+		node = next;
+	}
+	deck->head = NULL;
+	deck->current = NULL;
+	deck->tally = 0;
 }
 
 /**
@@ -161,6 +439,7 @@ void CardDeck_delete(CardDeck* deck) {
 * @param deck Card deck to be deleted.
 */
 deckError CardDeck_gotoTop(CardDeck* deck) {
+	INSTR_FUNC(CardDeck_gotoTop);
 	CHECK_DECK_VALID(deck); // return illegalCard if top card isn't valid
 
 	// set current to top card
@@ -174,6 +453,7 @@ deckError CardDeck_gotoTop(CardDeck* deck) {
 * @param deck Card deck whose current node will be changed.
 */
 deckError CardDeck_gotoNextCard(CardDeck* deck) {
+	INSTR_FUNC(CardDeck_gotoNextCard);
 	CHECK_DECK_VALID(deck); // return illegalCard if next card isn't valid
 
 	deck->current = deck->current->successor;
@@ -185,6 +465,7 @@ deckError CardDeck_gotoNextCard(CardDeck* deck) {
 ************************************************************/
 
 Card* CardDeck_seeTop(CardDeck* deck) {
+	INSTR_FUNC(CardDeck_seeTop);
 	if (deck == NULL) return NULL; // if deck is null, return null
 	if (deck->head->successor == NULL) return NULL; // if deck is empty, return null
 
@@ -192,53 +473,108 @@ Card* CardDeck_seeTop(CardDeck* deck) {
 }
 
 /**
-* @breif Ceate Ordered decks? funtion
+* Creates a new deck holding numPacks ordered packs,
+* i.e. each pack sorted by suit then rank.
 *
+* @param numPacks Number of packs to place in the deck
+* @return The new deck, or NULL if no memory is available
 */
 CardDeck* CardDeck_createOrdered(int numPacks) {
+	INSTR_FUNC(CardDeck_createOrdered);
 	CardDeck* deck = CardDeck_create();
 	if (!deck) return NULL;
 
-	deck->current = deck->head;
-
-	for (int i = 0; i < 52 * numPacks; i++) {
-		Suit suit = (i % 52) / 13; // each suit has 13 cards 
-		Rank rank = i % 13; // changes after counting from 0 to 12
-		/*
-		if (rank == 12) {
-			rank = 0;
-			if(suit >= 3) {
-				suit = 0;
-			}
-			else {
-				suit += 1;
-			}
-		}
-		*/
-		Card card;
-		Card_create(&card, suit, rank);
-		CardDeck_insertAfter(&card, deck);
-		deck->current = deck->current->successor;
+	if (CardDeck_fillDeck(deck, numPacks) == NULL) { // the packs are stamped from orderedPack
+		CardDeck_delete(deck);
+		return NULL;
 	}
 	return deck;
 }
 
+/**
+* Inserts count cards after the current node of a deck, keeping their order.
+* Unlike CardDeck_insertAfter, current is moved to the last inserted card,
+* so repeated calls append one run after another.
+* All nodes are taken in one run from the node pool.
+*
+* @param deck The card deck to insert the cards into
+* @param cards The cards to insert
+* @param count Number of cards
+* @return ok, illegalCard if the deck has no current node, or noMemory
+*/
+deckError CardDeck_insertCardsAfter(CardDeck* deck, const Card* cards, int count) {
+	if (deck == NULL || deck->current == NULL) return illegalCard;
+	if (count <= 0) return ok;
+
+	CardNode* last;
+	CardNode* node = CardNode_newRun(count, &last);
+	if (node == NULL) return noMemory;
+	CardNode* first = node;
+
+	uint64_t tally = 0;
+	for (int i = 0; i < count; i++) {
+		node->card = cards[i];
+		tally += Card_key(cards[i]);
+		node = node->successor;
+	}
+	deck->tally += tally;
+
+	last->successor = deck->current->successor;
+	deck->current->successor = first;
+	deck->current = last;
+	return ok;
+}
+
+/**
+* Same as CardDeck_insertCardsAfter, but takes the cards packed with Card_pack.
+*
+* @param deck The card deck to insert the cards into
+* @param cards The packed cards to insert, each below PACK_SIZE
+* @param count Number of cards
+* @return ok, illegalCard if the deck has no current node, or noMemory
+*/
+deckError CardDeck_insertPackedAfter(CardDeck* deck, const PackedCard* cards, int count) {
+	if (deck == NULL || deck->current == NULL) return illegalCard;
+	if (count <= 0) return ok;
+
+	CardNode* last;
+	CardNode* node = CardNode_newRun(count, &last);
+	if (node == NULL) return noMemory;
+	CardNode* first = node;
+
+	uint64_t tally = 0;
+	for (int i = 0; i < count; i++) {
+		node->card = Card_unpack(cards[i]);
+		tally += cardKeys[cards[i]];
+		node = node->successor;
+	}
+	deck->tally += tally;
+
+	last->successor = deck->current->successor;
+	deck->current->successor = first;
+	deck->current = last;
+	return ok;
+}
+
 deckError CardDeck_insertToTop(CardDeck* deck, Card card){
+	INSTR_FUNC(CardDeck_insertToTop);
 	
 	CHECK_DECK_VALID2(deck);//if its null
-	CardNode* newNode = (CardNode*)malloc(sizeof(CardNode)); // create and allocate newNode
-
+	CardNode* newNode = CardNode_new(); // create and allocate newNode
 	if (newNode == NULL) return noMemory; // return noMemory if allocation fails
+	INSTR_ALLOC(CardDeck_insertToTop);
 
 	// begin inserting card after current node
 	newNode->card = card; // associate card with newNode
 	newNode->successor = deck->head->successor; // point newNode's successor towards next node
 	deck->head->successor = newNode; // point current node's successor towards newNode
+	deck->tally += Card_key(card);
 
 
 	return ok;
 }
 Card* CardDeck_useTop(CardDeck* deck, deckError* result) {
+	INSTR_FUNC(CardDeck_useTop);
 	if (deck == NULL || deck->head->successor == NULL) {
 		if (result) {
 			*result = illegalCard;
@@ -246,14 +582,17 @@ Card* CardDeck_useTop(CardDeck* deck, deckError* result) {
 		return NULL; // if deck is null, return null, if deck is empty, return null
 	}
 	CardNode* delnode = deck->head->successor;
-	deck->head->successor = delnode->successor;
 	Card* delcard = malloc(sizeof(Card));
 	if (!delcard) {
 		if (result) *result = noMemory;
-		return NULL;
+		return NULL; // the card stays in the deck
 	}
+	INSTR_ALLOC(CardDeck_useTop);
+	deck->head->successor = delnode->successor;
 	*delcard = delnode->card;
-	free(delnode);
+	deck->tally -= Card_key(delnode->card);
+	CardNode_release(delnode);
+	INSTR_FREE(CardDeck_useTop);
 	if (result) *result = ok;
 	return delcard;
 }
@@ -262,6 +601,7 @@ Card* CardDeck_useTop(CardDeck* deck, deckError* result) {
 * Utility Operations
 ************************************************************/
 CardNode* CardDeck_cardNodeAt(CardDeck* deck, int index, deckError* result) {
+	INSTR_FUNC(CardDeck_cardNodeAt);
 	if (deck == NULL || deck->head->successor == NULL) {
 		if (result) {
 			*result = illegalCard;
@@ -272,6 +612,7 @@ CardNode* CardDeck_cardNodeAt(CardDeck* deck, int index, deckError* result) {
 	int i = 0;
 	
 	while (i != index) {
+		INSTR_NODE(CardDeck_cardNodeAt);
 		if (node->successor == NULL) {
 			*result = illegalCard;
 			return NULL;
@@ -283,6 +624,7 @@ CardNode* CardDeck_cardNodeAt(CardDeck* deck, int index, deckError* result) {
 }
 
 Card* CardDeck_removeAt(CardDeck* deck, int index, deckError* result) {
+	INSTR_FUNC(CardDeck_removeAt);
 	// we must first update the predecessor to point past the node to be deleted
 	CardNode* preNode = NULL;
 	CardNode* delNode = NULL;
@@ -316,16 +658,46 @@ Card* CardDeck_removeAt(CardDeck* deck, int index, deckError* result) {
 		if (result) *result = noMemory;
 		return NULL;
 	}
+	INSTR_ALLOC(CardDeck_removeAt);
 	
 	preNode->successor = delNode->successor; // set predecessor's successor pointer to the deleted node's successor
 
 	
 	*delCard = delNode->card; // copy card data from deleted node into newly allocated card
-	free(delNode);
+	deck->tally -= Card_key(delNode->card);
+	CardNode_release(delNode);
+	INSTR_FREE(CardDeck_removeAt);
 	if (result) *result = ok;
 	return delCard;
 }
 
+/**
+* @brief Takes the node at a position out of a deck without freeing it
+* @details Same as CardDeck_removeAt, but hands over the node itself
+* instead of a copy of its card, so nothing is allocated or freed. The
+* caller owns the node and must link it into another deck, which frees
+* it with its other nodes.
+*
+* @param deck The deck
+* @param index Position of the node, 0 is the top card
+* @param result Receives ok, or illegalCard if index is out of range
+* @return The unlinked node, NULL on error
+*/
+CardNode* CardDeck_unlinkAt(CardDeck* deck, int index, deckError* result) {
+	CardNode* preNode = index == 0 ? (deck != NULL ? deck->head : NULL) : CardDeck_cardNodeAt(deck, index - 1, result);
+	if (preNode == NULL || preNode->successor == NULL) {
+		if (result) *result = illegalCard;
+		return NULL;
+	}
+
+	CardNode* node = preNode->successor;
+	preNode->successor = node->successor;
+	node->successor = NULL;
+	deck->tally -= Card_key(node->card);
+	if (result) *result = ok;
+	return node;
+}
+
 /**
 * @brief Removes a card at a specific position in the deck
 * @details This function removes a card at a specific position in the deck and frees its memory.
@@ -356,6 +728,7 @@ Card* CardDeck_removeAt(CardDeck* deck, int index, deckError* result) {
 * 
 **/
 deckError removeCardAt(CardDeck* deck,int pos) {
+	INSTR_FUNC(removeCardAt);
 	//pos=1 =the node after dummy
 	//printf("within removeCardAt function pos=%d\n", pos);
 	
@@ -387,6 +760,7 @@ deckError removeCardAt(CardDeck* deck,int pos) {
 		
 	
 		for (int i = 0; i < pos - 1; i++) {
+			INSTR_NODE(removeCardAt);
 			if (prevTargetNode->successor == NULL) {
 				printf("no successor found\n");
 				return illegalCard;//if theres no successor then return illegal card
@@ -403,7 +777,9 @@ deckError removeCardAt(CardDeck* deck,int pos) {
 		}
 
 		prevTargetNode->successor = targetNode->successor;//previous target node links to the node after target node
-		free(targetNode);//freeing the target node
+		deck->tally -= Card_key(targetNode->card);
+		CardNode_release(targetNode);//freeing the target node
+		INSTR_FREE(removeCardAt);
 		//printf("node at pos %d removed\n", pos);
 		return ok;
 	
@@ -414,6 +790,26 @@ deckError removeCardAt(CardDeck* deck,int pos) {
 
 
 }
+/**
+* @brief Checks the tally of a deck against its cards
+* @details The tally is kept up to date by every function of CardDeck that
+* adds or removes cards, so this walk is only needed to check those
+* functions themselves, e.g. in tests. Code that links nodes into a deck
+* directly has to update the tally itself.
+*
+* @param deck The deck
+* @return 1 if the tally is the sum of the keys of the cards in the deck, otherwise 0
+*/
+int CardDeck_checkTally(const CardDeck* deck) {
+	uint64_t tally = 0;
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		tally += Card_key(*card);
+	}
+	return tally == deck->tally;
+}
+
 /**
 * 
 * @brief Gets the card node at a specific position in the deck
@@ -430,6 +826,7 @@ deckError removeCardAt(CardDeck* deck,int pos) {
 * 
 **/
 CardNode* getCardNodeAt(CardDeck* deck, int pos) {
+	INSTR_FUNC(getCardNodeAt);
 
 	
 	//pos=1 is the succesor of head
@@ -453,6 +850,7 @@ CardNode* getCardNodeAt(CardDeck* deck, int pos) {
 		prevTargetNode = deck->head;//previous target node starts at head	
 		//loops to find node before targetnode
 		for (int i = 0; i < pos - 1; i++) {
+			INSTR_NODE(getCardNodeAt);
 			if (prevTargetNode->successor==NULL) {
 				return NULL;//if theres no successor then return null
 
@@ -474,39 +872,25 @@ CardNode* getCardNodeAt(CardDeck* deck, int pos) {
 
 }
 
-int CardDeck_count(CardDeck* deck) {
+int CardDeck_count(const CardDeck* deck) {
+	INSTR_FUNC(CardDeck_count);
 	if (deck == NULL || deck->head->successor == NULL) { // if card is empty, return 0
 		return 0;
 	}
-	CardNode* node = deck->head->successor; 
+	const CardNode* node = deck->head->successor; 
 	int i = 0;
 	while (node != NULL) { // increase count by 1 for every valid card. stop when node is a tail (end of list)
+		INSTR_NODE(CardDeck_count);
 		node = node->successor;
 		i++;
 	}
 
 	return i;
 }
-void CardDeck_print(CardDeck* deck) {
-	if (deck == NULL || deck->head->successor == NULL) { // if card is empty, end function
-		printf("Empty deck!\n");
-		return;
-	}
-	
-	CardNode* node = deck->head->successor;
-	printf("deck: \n");
-	while (node != NULL) { // print every valid card. stop iterating when node is a tail (end of list)
-		
-		printf("%s-%s", suitNames[node->card.suit], rankNames[node->card.rank]);
-
-		if (node->successor != NULL) { // print comma and space if card isn't last element
-			printf(", ");
-		}
-		node = node->successor; 
-		
-		
-	}
-	printf("\n");
+void CardDeck_print(const CardDeck* deck) {
+	INSTR_FUNC(CardDeck_print);
+	// the whole deck is formatted into one buffer and written at once, see CardFormat.h
+	CardFormat_printDeck(deck, formatLong, stdout);
 }
 
 /************************************************************
@@ -514,383 +898,121 @@ void CardDeck_print(CardDeck* deck) {
 ************************************************************/
 
 
-/****
-*randomizes the deck
-* randomly mix the elements so they are at random order 
-* 
-*ensure pointers are correct
-* no element should bebiased
-* 
-* e.g A->B->C->D 
-* 
-* randomly generate  number
-* trancverse rom head to find that node num
-* insert node at that position
-* 
-* aka i wnt to inset a node at index 5 
-* 
-* i need index 4 to link to the current node]
-* so i decrese pos by 1 to get prev node
-* i store wht prev nod is linking to to a temp variale
-* put whats before  current node in a temp variable
-* then prev links to currnt node
-* 
-* whats links to current node linked to the target node
-* 
-* target node liks to prevous current nodes successor 
-* 
-* 1.Find the length of the linked list
-* 2.Pick a random node 
-* 3.Generate a random index position 
-* 4.Inner loop: find prevTragteNode at a certian positioj
-* 4.Rearrange pointers  to move nodes to teh correct position
-* 5.repeat loop
-* 
-
-**/
 /**
 *@brief Shuffles a deck of cards using randomization
-* @details This function shuffles the deck by repeatedly selecting random cards fromm the original deck
-* and inserting them into a temporry deck.
-* 
+* @details This function shuffles the deck with a Fisher-Yates shuffle:
+* the cards are copied into an array in one walk of the list, the array
+* is shuffled in place, and the cards are written back in a second walk.
+* The nodes themselves stay where they are, only their cards change.
+* This is linear in the deck length, every permutation is equally likely.
 * 
 * @param deck Pointer to the unshuffled CardDeck structure 
 * 
 * @author Diana Ogualiri 24353051
-* @return ok if shuffle succeeds, illegalCard if card retrieval/removal fails,
-*			noMemory if insertion fails
+* @return ok if shuffle succeeds, illegalCard if the deck is invalid or empty,
+*			noMemory if the scratch array cannot be allocated
 * 
 * @note The deck must be valid and not emtpty
-* @note uses rand() for random number generation
-* @note uses a dummy node for the head node
+* @note uses the calling thread's default Rng, see CardDeck_shuffleWith()
+* @note the current node is reset to the head node
 * 
-* @see CardDeck_create()
-* @see getCardNodeAt()
-* @see CardDeck_insertToTop()
+* @see CardDeck_shuffleWith()
+* @see Rng_bounded()
 *
-* 
-* 
-* 
 **/
-
-
-
 deckError CardDeck_shuffle(CardDeck* deck) {
-	CHECK_DECK_VALID(deck);
-	
-	
-	
-	int decklen = CardDeck_count(deck);//getting the deck length
-	CardDeck* deck2 = CardDeck_create();//crating a second emty deck
-
-	
-
-	//initializing deck2
-	
-	int pos = 0;
-	
-	CardNode* targetNode;
-	
-	Card targetCard;//Card is the card itself, Card* is a pointer to the card
-
-
-	while (decklen!=0) {
-	//	printf("\nwithin the loop\n");
-
-		
-
-	pos = rand() % decklen+1;//generating a random position between 1 and decklen
+	return CardDeck_shuffleWith(deck, Rng_default());
+}
 
-	//printf("Loop decklen=%d, pos=%d\n",decklen, pos);
+/**
+* @brief Shuffles a deck of cards with the given random number generator
+* @details Same as CardDeck_shuffle(), but the random positions come from rng,
+* so a seeded generator gives a reproducible shuffle.
+*
+* @param deck Pointer to the unshuffled CardDeck structure
+* @param rng Generator to draw the random positions from
+* @return ok, illegalCard if the deck is invalid or empty, noMemory if allocation fails
+*/
+deckError CardDeck_shuffleWith(CardDeck* deck, Rng* rng) {
+	INSTR_FUNC(CardDeck_shuffle);
+	TRACE_SCOPE(CardDeck_shuffle);
+	CHECK_DECK_VALID3(deck);
 
-	
-	targetNode = getCardNodeAt(deck, pos);//getting the card node at that position
-	if (targetNode==NULL) {
-		//printf("targetNode is null\n");
-		return illegalCard;
+	int decklen = CardDeck_count(deck);//getting the deck length
+	Card small[PACK_SIZE];//a single pack fits on the stack
+	Card* cards = small;
+	if (decklen > PACK_SIZE) {
+		cards = (Card*)malloc((size_t)decklen * sizeof(Card));
+		if (cards == NULL) return noMemory;
+		INSTR_ALLOC(CardDeck_shuffle);
 	}
-	//printf("targetNode found: rank=%d, suit=%d\n", targetNode->card.rank, targetNode->card.suit);
-	targetCard = targetNode->card;//storing cardNodes card into targetCard
-	//*targetCard = &(targetNode->card);
-	deckError removeCardError = removeCardAt(deck, pos);//removing the card at that position
-
-	if (removeCardError!=ok) {
-		printf("failed to remove card at pos %d\n", pos);
-		return illegalCard;
 
+	//copying the cards out in deck order
+	CardNode* node = deck->head->successor;
+	for (int i = 0; i < decklen; i++) {
+		INSTR_NODE(CardDeck_shuffle);
+		cards[i] = node->card;
+		node = node->successor;
 	}
-	else {
-		//printf("card at pos %d removed successfully\n", pos);
-		deckError insertCardError=CardDeck_insertToTop(deck2, targetCard);
-		if (insertCardError!=ok) {
-			printf("failed to insert card into deck2\n");
-			return noMemory;
-		}
-		
 
+	//Fisher-Yates: swap each position with a random position at or before it
+	for (int i = decklen - 1; i > 0; i--) {
+		int pos = (int)Rng_bounded(rng, (uint32_t)i + 1);
+		Card targetCard = cards[i];
+		cards[i] = cards[pos];
+		cards[pos] = targetCard;
 	}
-	
-	
-	decklen--;//reduces length to prevent strange behaviour
-
-	}//end of while loop deck1 is now 1ength 0
 
-	
-
-	printf ("exiting loop\n");
-
-	
-
-	
+	//writing the shuffled cards back into the nodes
+	node = deck->head->successor;
+	for (int i = 0; i < decklen; i++) {
+		INSTR_NODE(CardDeck_shuffle);
+		node->card = cards[i];
+		node = node->successor;
+	}
 
-	
-	deck->head->successor= deck2->head->successor;//used to point heads successor of deck2 to the heads successor of the original deck
-	deck->current = deck2->current;//points to the  current nodes deck
-	
-	
-	free(deck2->head);//frees head since head is a dummy node
-	free(deck2);//then deck2 is freed
+	if (cards != small) {
+		free(cards);
+		INSTR_FREE(CardDeck_shuffle);
+	}
+	deck->current = deck->head;
 	return ok;
-
-
-
-
-
-
-	 
-	
-
-
-
-	
-
-	
-	
-	
-
 }
 
-/*
-*1.neeed to find out access a spcific pat in an enum  and somehow loop through it 
-* 2.sorting --> loop through the list, 
-* 3. if  the element is club then increment by 1 else 
-* 
-*  selection sort
-* 
-* first compare suits lower enum =smaller
-* 
-* if suits are the same then compare ranks
-* if i <i+! then increment else swap ranks
-* 
-* if suits are different then swap the lrger enum with the smaller one
-* 
-* if it cant find smaller then make tthe ext enum value as smller
-* repeat until ordered
-* 
-* this is going to be awkard cuz i need to take i account the last card will point to null , all i need to do is whe the las card is being swapped the last card pointts to where the card im swapping it with is pointing, and the card im swpaping with it points to null correct
-* 
-****/
-
-
-
-/*
-*Bubble Sort
-* how i will be doing this
-* 1. im comapring adjcant cards
-* 2. checking if current->suit >current->link->suit
-*		if true then they are swapped
-* 
-* 3. checking if suits arre equal
-*		if true then check if current->rank>current->link->rank
-*		if true then the cards are swapped
-* 
-* 4. handle pointer updates carefullly and 
-*		dont forget when the current->link is null
-*	
-* 
-* 
-*/
-
 /**
-* @brief Implements Bubble Sort Algoirthm to sort a deck of cards
-* @details This function implements Bubble Sort Algorithm to sort a deck of cards using a Linekd List Structure.
-*			The sorting is based off 2 rules:
-*				Rule 1: Must sort by suit (lower enum is the smaller one)
-*				Rule 2: Mut sort by rank (When suits are equal)
-* 
-* This algorithm uses 2 while loops
-*	Outer loop: Repeatedly passes through the list until the deck is in the right order and no more swaps is needed.
-*	Inner loop: Compares suits and swaps once the currentsuit is greather then the successor suit
-* 
-* Implementation details:
-* - Uses swapped boolean flag to track if swaps occured or not
-* - Uses if statements to handle when current node is the head or not
-* - Rearranges pointers to point to the correct node
-* - After every pass , predecessor becomes null and current node egins at the head node again
-* 
-* 
+* @brief Sorts a deck of cards by suit then rank
+* @details There are only 52 different cards, so this is a counting sort:
+* one pass over the deck with an iterator counts every card, and a second
+* pass writes the cards back in order. The nodes stay where they are, only
+* their cards change, and the deck's current node is not touched.
+*
+*	Rule 1: Must sort by suit (lower enum is the smaller one)
+*	Rule 2: Must sort by rank (When suits are equal)
+*
 * @param deck Pointer to the unsorted CardDeck structure 
 * @author Diana Ogualiri 24353051
 * 
 * @return void: nothing
-* 
-* 
-* 
-* 
 */
 void CardDeck_sort(CardDeck* deck) {
-	//bubble sort
-	//sort the deck by suit then rank
-	
-	//current is the card
-	//like curret i linked list the current is  type node
-	//in type node u can get the data or link
-
-	//so in type cardnode u can get cardata and 
-
-	//ii need a temp variable to store reference;
-
-	//CHECK_DECK_VALID(deck);//checks if deck is valid or not
-
-
-
-	CardNode* prev=NULL;//at teh start
-	CardNode* temp;
-	CardNode* temp2;
-	bool swapped;
-	
-	//use swapped
-	//to track the passes
-	//swapped=true only when adjacnet elements are swapped
-	//once the end is reached swapped=false because theres nothing more toswap
-	
-	
-	//outer loop handles the num of passes
-	// //pass until no more swaps occur
-
-	swapped = true;
-	deck->current = deck->head->successor;
-	while (swapped==true) {
-		//inner loop handles the swapping
-
-		
-		while (deck->current->successor != NULL) {//while successor  isnt null
-			swapped = false;
-			//swapped only stayys false if we reached the end and theres nothing left to swap
-			//i wantt to acces the suit
-
-			//deck->current is the card itself
-			//deck->current->suit is the shuit
-			//deck->current->rank is the rank itself
-
-			//if current suit is greater then successor suit then swap cards
-
-
-			if (deck->current->card.suit > deck->current->successor->card.suit) {
-
-				if (prev==NULL) {//prev is null only when currnet node is heads successor
-				//	temp2 = deck->current;
-					temp = deck->head->successor;
-					temp2 = deck->head->successor->successor;
-
-					deck->head->successor = temp2;
-					temp->successor = temp2->successor;
-					temp2->successor = temp;
-					swapped = true;
-
-
-
-
-				}
-				else {
-					//swappng when prev isnt null
-					temp = deck->current;
-					temp2 = deck->current->successor;
-					prev->successor = deck->current->successor;//current is d now
-					temp->successor = temp2->successor;
-					temp2->successor = temp;
-					swapped = true;
-
-				}
-
-				prev = deck->current;//prev is he current node -> used in next iteration
-				deck->current = deck->current->successor;//amkes successor the current node
-
-
-			}
-			//else if the suits are the same then check rank
-			else if (deck->current->card.suit == deck->current->successor->card.suit) {
-
-				//if the currnet card's rank is > then the next card's rank then swap cards
-				if (deck->current->card.rank > deck->current->successor->card.rank) {
-					temp = deck->current;
-
-					if (prev == NULL) {//prev is null only when currnet node is heads successor
-						//	temp2 = deck->current;
-						temp = deck->head->successor;
-						temp2 = deck->head->successor->successor;
-
-						deck->head->successor = temp2;
-						temp->successor = temp2->successor;
-						temp2->successor = temp;
-						swapped = true;
-
-
-
-
-					}
-					else {
-						//swappng when prev isnt null
-						temp = deck->current;
-						temp2 = deck->current->successor;
-						prev->successor = deck->current->successor;//current is d now
-						temp->successor = temp2->successor;
-						temp2->successor = temp;
-						swapped = true;
-
-					}
-					
-					//now i want the predecessor to point to the current node
-					prev = temp2;
-					deck->current = temp;//amkes successor the current node
-
-
-
-				}
-				else {
-					//when ranks are in the right order then
-					prev = deck->current;
-					deck ->current = deck->current->successor;
-				}
-
-			}
-			else {
-				//now i want the predecessor to point to the current node
-				
-				prev = deck->current;
-				deck->current = deck->current->successor;//amkes successor the current node
-
-			}
-
-
-
-
-
-
-
-
-
-
-
-		}
-		prev = NULL;//After each pass prev needs to reset to null to start where head=current--> prev cant be before current
-					//thefore it has to be null
-		deck->current = deck->head;
+	INSTR_FUNC(CardDeck_sort);
+	if (deck == NULL || deck->head == NULL) return;
+
+	int counts[PACK_SIZE] = { 0 };
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		INSTR_NODE(CardDeck_sort);
+		counts[Card_pack(*card)]++;
 	}
 
-
-
-
+	int packed = 0;
+	for (CardNode* node = deck->head->successor; node != NULL; node = node->successor) {
+		INSTR_NODE(CardDeck_sort);
+		while (counts[packed] == 0) packed++; // skip cards that are used up
+		node->card = orderedPack[packed];
+		counts[packed]--;
+	}
 }
 
 /**
@@ -911,64 +1033,51 @@ void CardDeck_sort(CardDeck* deck) {
 * 
 **/
 deckError CardDeck_recycleHidden(CardDeck* hidden, CardDeck* played) {
+	return CardDeck_recycleHiddenWith(hidden, played, Rng_default());
+}
+
+/**
+* @brief Same as CardDeck_recycleHidden(), but shuffles with the given generator
+*
+* @param hidden Pointer to hidden deck(piace to draw cards from)
+* @param played Pointer to played deck
+* @param rng Generator for the shuffle of the hidden deck
+* @return ok, illegalCard if a deck is invalid or played has no card below the top card
+*/
+deckError CardDeck_recycleHiddenWith(CardDeck* hidden, CardDeck* played, Rng* rng) {
+	INSTR_FUNC(CardDeck_recycleHidden);
+	TRACE_SCOPE(CardDeck_recycleHidden);
 
 	//tarnsfers played cards o teh hidden deck and shuffles it
 
-	CHECK_DECK_VALID(hidden);//checkin the hidden deck
-	CHECK_DECK_VALID(played);//checking the played deck
-	CardNode* topCard=played->head;//gets the top card from the played deck and stores a reference to the head
-	CardNode* currentCard;//the 2nd card onwards in the played deck
+	CHECK_DECK_VALID2(hidden);//checkin the hidden deck, it may be empty
+	CHECK_DECK_VALID3(played);//checking the played deck has a top card
+	CardNode* topCard = played->head->successor;//the top card stays on the played deck
+	CardNode* currentCard = topCard->successor;//the 2nd card onwards in the played deck
 	CardNode* temp;//temporary holds a card
-	
-	if (topCard==NULL) {
-		//if topCard aka the head is null that means the deck is null
+
+	if (currentCard == NULL) {
+		//only the top card is left, nothing to recycle
 		return illegalCard;
 
 	}
 
-	//i want to move every card but the top card to hidden deck
-	
-
-	//so i want to start at the 2nd card so where the head points to
-	currentCard = played->head->successor;//currentCard is the 2nd card
-
 	//getting each card from played deck so I need to loop
+	while (currentCard != NULL) {//while the currnet card isnt null loop
+		INSTR_NODE(CardDeck_recycleHidden);
 
-	while (currentCard!=NULL) {//while the currnet card isnt null loop
-
-		//looping through played deck I want to move each card to the hidden deck
-
-		
-		// the currentcard to link to the head 
-		//then make the current code the headnode
-		//swapping occurs
+		//link the current card in right after the head of the hidden deck
 		temp = currentCard->successor;//storing a reference to where the currentacrd points to
 
-		currentCard->successor = hidden->head;//Currentcard  links to head
-		hidden->head = currentCard;
+		currentCard->successor = hidden->head->successor;
+		hidden->head->successor = currentCard;
 
 		currentCard = temp;//currentCard has the originla current card
-		
-
-
 	}
-	//we only nat played deck to have the top card
-	//we wnat the top card aka head's successor to point to nothing
-	played->head->successor = NULL;
-	CardDeck_shuffle(hidden);//shuffling the hiddn deck after played deck only has the top card
-	return ok;
-
-
-
-
-	
-
-
-
-
-
-
-
-
+	//we only want played deck to have the top card, everything else moved to hidden
+	topCard->successor = NULL;
+	played->current = played->head;
+	hidden->tally += played->tally - Card_key(topCard->card);
+	played->tally = Card_key(topCard->card);
+	return CardDeck_shuffleWith(hidden, rng);//shuffling the hiddn deck after played deck only has the top card
 }
-
@@ -18,12 +18,15 @@
 #define CARDDECK_H
 
 #include "Card.h"
+#include "Rng.h"
 
 // checks if a deck is valid, else returns illegal card. use in functions returning deckError types
 #define CHECK_DECK_VALID(deck) if(deck == NULL || deck->current == NULL || deck->current->successor == NULL) return illegalCard;
 #define CHECK_DECK_VALID2(deck) if(deck == NULL || deck->head== NULL )return illegalCard;
 #define CHECK_DECK_VALID3(deck) if(deck == NULL || deck->head==NULL||deck->head->successor== NULL )return illegalCard;
 
+#define CARDDECK_MAX_THREADS 64 // upper bound for the thread count of the parallel operations
+
 typedef enum {
 	ok, // no error
 	illegalCard, // card is invalid
@@ -38,17 +41,29 @@ typedef struct n {
 typedef struct {
 	CardNode* head; // pointer towards head of carddeck
 	CardNode* current; // pointer towards current node of carddeck
+	uint64_t tally; // sum of Card_key of every card in the deck, see CardDeck_checkTally
 } CardDeck;
 
+// read-only iterator over a deck's cards. unlike gotoTop/gotoNextCard it does not
+// touch deck->current, so any number of them can scan the same deck at once
+typedef struct {
+	const CardNode* node; // node of the next card to hand out, NULL at the end
+	int index; // position of that card, 0 is the top card
+} CardDeckIter;
+
 // Function declarations
 // When you're finished implementing a function, mark it as completed on the spreadsheet
 
 //Linked list operations
 CardDeck* CardDeck_create();
+deckError CardDeck_init(CardDeck* deck);
 CardDeck* CardDeck_fillDeck(CardDeck* deck, int numPacks);
 deckError CardDeck_insertAfter(Card* card, CardDeck* deck);
+deckError CardDeck_insertCardsAfter(CardDeck* deck, const Card* cards, int count);
+deckError CardDeck_insertPackedAfter(CardDeck* deck, const PackedCard* cards, int count);
 deckError CardDeck_deleteNext(CardDeck* deck);
 void CardDeck_delete(CardDeck* deck);
+void CardDeck_destroy(CardDeck* deck);
 deckError CardDeck_gotoTop(CardDeck* deck);
 deckError CardDeck_gotoNextCard(CardDeck* deck);
 
@@ -65,21 +80,54 @@ Card* CardDeck_useTop(CardDeck* deck, deckError* result);
 // Util Operations
 CardNode* CardDeck_cardNodeAt(CardDeck* deck, int index, deckError* result);
 Card* CardDeck_removeAt(CardDeck* deck, int index, deckError* result);
+CardNode* CardDeck_unlinkAt(CardDeck* deck, int index, deckError* result);
 deckError removeCardAt(CardDeck* deck, int pos);
 CardNode* getCardNodeAt(CardDeck* deck, int pos);
-int CardDeck_count(CardDeck* deck);
-void CardDeck_print(CardDeck* deck);
+int CardDeck_count(const CardDeck* deck);
+int CardDeck_checkTally(const CardDeck* deck);
+void CardDeck_print(const CardDeck* deck);
+long long CardDeck_poolNodes(void);
 
 
 // Complex Operations
- deckError CardDeck_shuffle(CardDeck* deck);
+deckError CardDeck_shuffle(CardDeck* deck);
+deckError CardDeck_shuffleWith(CardDeck* deck, Rng* rng);
+deckError CardDeck_shuffleParallel(CardDeck* deck, Rng* rng, int numThreads);
+int CardDeck_hardwareThreads(void);
 void CardDeck_sort(CardDeck* deck);
 deckError CardDeck_recycleHidden(CardDeck* hidden, CardDeck* played);
+deckError CardDeck_recycleHiddenWith(CardDeck* hidden, CardDeck* played, Rng* rng);
 
 
+// Iterators
 
+/**
+* Returns an iterator positioned on the top card of deck.
+*/
+static inline CardDeckIter CardDeck_iter(const CardDeck* deck) {
+	CardDeckIter it;
+	it.node = (deck == NULL || deck->head == NULL) ? NULL : deck->head->successor;
+	it.index = 0;
+	return it;
+}
 
+/**
+* Returns the next card without advancing, NULL at the end of the deck.
+*/
+static inline const Card* CardDeckIter_peek(const CardDeckIter* it) {
+	return it->node == NULL ? NULL : &it->node->card;
+}
 
-
+/**
+* Returns the next card and advances past it, NULL at the end of the deck.
+* The position of the returned card is it->index - 1.
+*/
+static inline const Card* CardDeckIter_next(CardDeckIter* it) {
+	if (it->node == NULL) return NULL;
+	const Card* card = &it->node->card;
+	it->node = it->node->successor;
+	it->index++;
+	return card;
+}
 
 #endif
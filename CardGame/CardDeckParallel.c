@@ -0,0 +1,228 @@
+/**
+* @file CardDeckParallel.c
+* Provides the parallel shuffle for very large shoes.
+*
+* The shuffle is a random scatter followed by local Fisher-Yates:
+* 1. every thread assigns each card of its chunk to a random bucket
+*    (one bucket per thread) and counts the cards per bucket,
+* 2. the counts give every (thread, bucket) pair its place in the output,
+*    and every thread scatters its chunk there,
+* 3. every thread shuffles one bucket with Fisher-Yates.
+* A card lands in a uniformly random bucket and every bucket is then
+* uniformly permuted, so the whole permutation is uniform.
+*
+* Each thread draws from its own stream: copies of the caller's
+* generator that are one Rng_jump apart, so the result only depends on
+* the generator and the thread count, not on scheduling.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <threads.h>
+#include "CardDeck.h"
+#include "Rng.h"
+#include "Trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct {
+	const Card* in; // the whole deck in list order
+	int begin; // first card of this thread's chunk
+	int end; // one past the last card of the chunk
+	uint8_t* bucket; // bucket chosen for every card of the deck
+	int* offsets; // per bucket: cards of the chunk, then next output slot
+	Card* out; // the deck grouped by bucket
+	int bucketBegin; // first slot of this thread's bucket in out
+	int bucketEnd; // one past the last slot of the bucket
+	int numBuckets; // equal to the number of threads
+	Rng rng; // this thread's stream
+	thrd_start_t phase; // phase ShuffleWorker_thread runs
+} ShuffleWorker;
+
+/**
+* Returns the number of processors available to this process, at least 1.
+*/
+int CardDeck_hardwareThreads(void) {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+/**
+* Phase 1: picks a bucket for every card of the chunk and counts them.
+*/
+static int ShuffleWorker_assign(void* arg) {
+	ShuffleWorker* worker = (ShuffleWorker*)arg;
+	for (int b = 0; b < worker->numBuckets; b++) {
+		worker->offsets[b] = 0;
+	}
+	for (int i = worker->begin; i < worker->end; i++) {
+		uint8_t b = (uint8_t)Rng_bounded(&worker->rng, (uint32_t)worker->numBuckets);
+		worker->bucket[i] = b;
+		worker->offsets[b]++;
+	}
+	return 0;
+}
+
+/**
+* Phase 2: copies every card of the chunk to the next free slot of its bucket.
+*/
+static int ShuffleWorker_scatter(void* arg) {
+	ShuffleWorker* worker = (ShuffleWorker*)arg;
+	for (int i = worker->begin; i < worker->end; i++) {
+		worker->out[worker->offsets[worker->bucket[i]]++] = worker->in[i];
+	}
+	return 0;
+}
+
+/**
+* Phase 3: Fisher-Yates over this thread's bucket.
+*/
+static int ShuffleWorker_shuffle(void* arg) {
+	ShuffleWorker* worker = (ShuffleWorker*)arg;
+	Card* cards = worker->out + worker->bucketBegin;
+	int count = worker->bucketEnd - worker->bucketBegin;
+
+	for (int i = count - 1; i > 0; i--) {
+		int pos = (int)Rng_bounded(&worker->rng, (uint32_t)i + 1);
+		Card temp = cards[i];
+		cards[i] = cards[pos];
+		cards[pos] = temp;
+	}
+	return 0;
+}
+
+/**
+* Runs the current phase of a worker on a thread of its own, named in traces.
+*/
+static int ShuffleWorker_thread(void* arg) {
+	TRACE_THREAD_NAME("shuffle worker");
+	TRACE_SCOPE(ShuffleWorker_thread);
+	ShuffleWorker* worker = (ShuffleWorker*)arg;
+	return worker->phase(worker);
+}
+
+/**
+* Runs one phase on every worker: worker 0 on the calling thread, the
+* others on new threads. If a thread cannot be started its worker runs
+* on the calling thread instead, so the result is the same either way.
+*/
+static void CardDeck_runPhase(ShuffleWorker* workers, int numThreads, thrd_start_t phase) {
+	thrd_t threads[CARDDECK_MAX_THREADS];
+	int started[CARDDECK_MAX_THREADS];
+
+	for (int t = 1; t < numThreads; t++) {
+		workers[t].phase = phase;
+		started[t] = thrd_create(&threads[t], ShuffleWorker_thread, &workers[t]) == thrd_success;
+	}
+	phase(&workers[0]);
+	for (int t = 1; t < numThreads; t++) {
+		if (started[t]) {
+			thrd_join(threads[t], NULL);
+		}
+		else {
+			phase(&workers[t]);
+		}
+	}
+}
+
+/**
+* @brief Shuffles a deck using several threads
+* @details Meant for shoes of thousands of packs, where the sequential
+* CardDeck_shuffleWith() becomes the bottleneck. The cards are copied out
+* of the list, shuffled in parallel as described at the top of this file,
+* and written back, so the nodes stay where they are.
+*
+* The result is a uniform permutation that depends only on rng and
+* numThreads. rng is advanced past every stream the threads used.
+*
+* @param deck Pointer to the unshuffled CardDeck structure
+* @param rng Generator the per-thread streams are split from
+* @param numThreads Number of threads, 0 or less uses CardDeck_hardwareThreads()
+* @return ok, illegalCard if the deck is invalid or empty, noMemory if allocation fails
+*/
+deckError CardDeck_shuffleParallel(CardDeck* deck, Rng* rng, int numThreads) {
+	TRACE_SCOPE(CardDeck_shuffleParallel);
+	CHECK_DECK_VALID3(deck);
+
+	if (numThreads <= 0) numThreads = CardDeck_hardwareThreads();
+	if (numThreads > CARDDECK_MAX_THREADS) numThreads = CARDDECK_MAX_THREADS;
+	int decklen = CardDeck_count(deck);
+	if (numThreads > decklen) numThreads = decklen;
+	if (numThreads <= 1) return CardDeck_shuffleWith(deck, rng);
+
+	Card* in = (Card*)malloc((size_t)decklen * sizeof(Card));
+	Card* out = (Card*)malloc((size_t)decklen * sizeof(Card));
+	uint8_t* bucket = (uint8_t*)malloc((size_t)decklen);
+	int* offsets = (int*)malloc((size_t)numThreads * numThreads * sizeof(int));
+	ShuffleWorker* workers = (ShuffleWorker*)malloc((size_t)numThreads * sizeof(ShuffleWorker));
+	if (in == NULL || out == NULL || bucket == NULL || offsets == NULL || workers == NULL) {
+		free(in);
+		free(out);
+		free(bucket);
+		free(offsets);
+		free(workers);
+		return noMemory;
+	}
+
+	CardNode* node = deck->head->successor;
+	for (int i = 0; i < decklen; i++) {
+		in[i] = node->card;
+		node = node->successor;
+	}
+
+	for (int t = 0; t < numThreads; t++) {
+		ShuffleWorker* worker = &workers[t];
+		worker->in = in;
+		worker->begin = (int)((long long)decklen * t / numThreads);
+		worker->end = (int)((long long)decklen * (t + 1) / numThreads);
+		worker->bucket = bucket;
+		worker->offsets = offsets + t * numThreads;
+		worker->out = out;
+		worker->numBuckets = numThreads;
+		worker->rng = *rng; // stream t, then move the caller's generator past it
+		Rng_jump(rng);
+	}
+
+	CardDeck_runPhase(workers, numThreads, ShuffleWorker_assign);
+
+	// bucket b starts after all smaller buckets; within it, thread t writes after threads before t
+	int slot = 0;
+	for (int b = 0; b < numThreads; b++) {
+		workers[b].bucketBegin = slot;
+		for (int t = 0; t < numThreads; t++) {
+			int count = workers[t].offsets[b];
+			workers[t].offsets[b] = slot;
+			slot += count;
+		}
+		workers[b].bucketEnd = slot;
+	}
+
+	CardDeck_runPhase(workers, numThreads, ShuffleWorker_scatter);
+	CardDeck_runPhase(workers, numThreads, ShuffleWorker_shuffle);
+
+	node = deck->head->successor;
+	for (int i = 0; i < decklen; i++) {
+		node->card = out[i];
+		node = node->successor;
+	}
+	deck->current = deck->head;
+
+	free(in);
+	free(out);
+	free(bucket);
+	free(offsets);
+	free(workers);
+	return ok;
+}
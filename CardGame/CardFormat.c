@@ -0,0 +1,241 @@
+/**
+* @file CardFormat.c
+* Implementation of the card and deck formatter.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "CardFormat.h"
+
+#define CARDFORMAT_NAME_MAX 16 // longest name is "Diamond-Queen"
+#define CARDFORMAT_STACK 4096 // the print functions only allocate for longer text
+
+static const char* shortRankNames[13] = { "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A" };
+static const char separator[] = ", ";
+static const char invalidName[] = "?";
+
+// name and length of every card in both styles, indexed by style then packed card
+static char names[2][PACK_SIZE][CARDFORMAT_NAME_MAX];
+static unsigned char lengths[2][PACK_SIZE];
+static once_flag namesOnce = ONCE_FLAG_INIT;
+
+/**
+* Builds the name table from suitNames and rankNames.
+*/
+static void CardFormat_buildNames(void) {
+	for (int c = 0; c < PACK_SIZE; c++) {
+		Card card = Card_unpack((PackedCard)c);
+		int length = snprintf(names[formatLong][c], CARDFORMAT_NAME_MAX, "%s-%s", suitNames[card.suit], rankNames[card.rank]);
+		lengths[formatLong][c] = (unsigned char)length;
+		length = snprintf(names[formatShort][c], CARDFORMAT_NAME_MAX, "%c-%s", suitNames[card.suit][0], shortRankNames[card.rank]);
+		lengths[formatShort][c] = (unsigned char)length;
+	}
+}
+
+/**
+* Copies the part of text that still fits behind used bytes of buffer.
+*
+* @return used + length, the length of the text so far even if it was cut
+*/
+static size_t CardFormat_append(char* buffer, size_t size, size_t used, const char* text, size_t length) {
+	if (used + length < size) {
+		memcpy(buffer + used, text, length);
+	}
+	else if (used + 1 < size) {
+		memcpy(buffer + used, text, size - 1 - used);
+	}
+	return used + length;
+}
+
+/**
+* Appends the name of a packed card, "?" for anything but 0..51.
+*/
+static size_t CardFormat_appendPacked(char* buffer, size_t size, size_t used, int packed, CardFormatStyle style) {
+	if (packed < 0 || packed >= PACK_SIZE) {
+		return CardFormat_append(buffer, size, used, invalidName, sizeof(invalidName) - 1);
+	}
+	if (used + CARDFORMAT_NAME_MAX < size) {
+		// copying the whole padded slot is a fixed-size copy the compiler inlines,
+		// the bytes behind the name are overwritten by the next one
+		memcpy(buffer + used, names[style][packed], CARDFORMAT_NAME_MAX);
+		return used + lengths[style][packed];
+	}
+	return CardFormat_append(buffer, size, used, names[style][packed], lengths[style][packed]);
+}
+
+/**
+* Packs a card for the name table, -1 if it is not a valid card.
+*/
+static int CardFormat_index(const Card* card) {
+	if (card->suit < CLUB || card->suit > DIAMOND || card->rank < TWO || card->rank > ACE) return -1;
+	return Card_pack(*card);
+}
+
+/**
+* Terminates the text, cut to the buffer if it is too long.
+*/
+static size_t CardFormat_finish(char* buffer, size_t size, size_t used) {
+	if (size > 0) buffer[used < size ? used : size - 1] = '\0';
+	return used;
+}
+
+/**
+* @brief Formats one card
+*
+* @param card The card, an invalid card is written as "?"
+* @param style formatLong or formatShort
+* @param buffer Receives the text, may be NULL if size is 0
+* @param size Size of buffer in bytes
+* @return Length of the text without the terminating 0
+*/
+size_t CardFormat_card(Card card, CardFormatStyle style, char* buffer, size_t size) {
+	call_once(&namesOnce, CardFormat_buildNames);
+	size_t used = CardFormat_appendPacked(buffer, size, 0, CardFormat_index(&card), style);
+	return CardFormat_finish(buffer, size, used);
+}
+
+/**
+* @brief Formats an array of cards, separated by ", "
+*
+* @param cards The cards
+* @param count Number of cards
+* @param style formatLong or formatShort
+* @param buffer Receives the text, may be NULL if size is 0
+* @param size Size of buffer in bytes
+* @return Length of the text without the terminating 0
+*/
+size_t CardFormat_cards(const Card* cards, int count, CardFormatStyle style, char* buffer, size_t size) {
+	call_once(&namesOnce, CardFormat_buildNames);
+	size_t used = 0;
+	for (int i = 0; i < count; i++) {
+		if (i > 0) used = CardFormat_append(buffer, size, used, separator, sizeof(separator) - 1);
+		used = CardFormat_appendPacked(buffer, size, used, CardFormat_index(&cards[i]), style);
+	}
+	return CardFormat_finish(buffer, size, used);
+}
+
+/**
+* @brief Formats an array of packed cards, separated by ", "
+*
+* @param cards The packed cards
+* @param count Number of cards
+* @param style formatLong or formatShort
+* @param buffer Receives the text, may be NULL if size is 0
+* @param size Size of buffer in bytes
+* @return Length of the text without the terminating 0
+*/
+size_t CardFormat_packed(const PackedCard* cards, int count, CardFormatStyle style, char* buffer, size_t size) {
+	call_once(&namesOnce, CardFormat_buildNames);
+	size_t used = 0;
+	for (int i = 0; i < count; i++) {
+		if (i > 0) used = CardFormat_append(buffer, size, used, separator, sizeof(separator) - 1);
+		used = CardFormat_appendPacked(buffer, size, used, cards[i], style);
+	}
+	return CardFormat_finish(buffer, size, used);
+}
+
+/**
+* @brief Formats a range of cards of a deck, separated by ", "
+* @details The deck is only read, the current card stays where it is.
+*
+* @param deck The deck
+* @param first Position of the first card, 0 is the top card
+* @param count Number of cards, a negative count formats up to the end of the deck
+* @param style formatLong or formatShort
+* @param buffer Receives the text, may be NULL if size is 0
+* @param size Size of buffer in bytes
+* @return Length of the text without the terminating 0
+*/
+size_t CardFormat_deck(const CardDeck* deck, int first, int count, CardFormatStyle style, char* buffer, size_t size) {
+	call_once(&namesOnce, CardFormat_buildNames);
+	CardDeckIter it = CardDeck_iter(deck);
+	while (it.index < first && CardDeckIter_next(&it) != NULL) {
+		// skip the cards before first
+	}
+
+	size_t used = 0;
+	const Card* card;
+	for (int i = 0; (count < 0 || i < count) && (card = CardDeckIter_next(&it)) != NULL; i++) {
+		if (i > 0) used = CardFormat_append(buffer, size, used, separator, sizeof(separator) - 1);
+		used = CardFormat_appendPacked(buffer, size, used, CardFormat_index(card), style);
+	}
+	return CardFormat_finish(buffer, size, used);
+}
+
+// formats the cards between "deck: " and the newline, see CardFormat_print
+typedef size_t (*CardFormatBody)(const void* cards, CardFormatStyle style, char* buffer, size_t size);
+
+static size_t CardFormat_deckBody(const void* cards, CardFormatStyle style, char* buffer, size_t size) {
+	return CardFormat_deck((const CardDeck*)cards, 0, -1, style, buffer, size);
+}
+
+/**
+* Writes "deck: ", the text of body and a newline with one fwrite. The text
+* goes into a buffer on the stack, only a longer text needs the heap.
+*
+* @return 0, or -1 if allocating or writing fails
+*/
+static int CardFormat_print(const void* cards, int empty, CardFormatBody body, CardFormatStyle style, FILE* out) {
+	static const char emptyText[] = "Empty deck!\n";
+	static const char header[] = "deck: \n";
+	if (empty) {
+		return fwrite(emptyText, 1, sizeof(emptyText) - 1, out) == sizeof(emptyText) - 1 ? 0 : -1;
+	}
+
+	char local[CARDFORMAT_STACK];
+	char* text = local;
+	size_t headerLength = sizeof(header) - 1;
+	memcpy(text, header, headerLength);
+	size_t length = headerLength + body(cards, style, text + headerLength, sizeof(local) - headerLength);
+	if (length + 2 > sizeof(local)) { // no room for the newline and the 0
+		text = (char*)malloc(length + 2);
+		if (text == NULL) return -1;
+		memcpy(text, header, headerLength);
+		body(cards, style, text + headerLength, length + 2 - headerLength);
+	}
+	text[length++] = '\n';
+
+	int failed = fwrite(text, 1, length, out) != length;
+	if (text != local) free(text);
+	return failed ? -1 : 0;
+}
+
+/**
+* @brief Writes a whole deck the way CardDeck_print does, with one fwrite
+*
+* @param deck The deck, NULL or empty prints "Empty deck!"
+* @param style formatLong or formatShort
+* @param out Stream to write to
+* @return 0, or -1 if allocating or writing fails
+*/
+int CardFormat_printDeck(const CardDeck* deck, CardFormatStyle style, FILE* out) {
+	int empty = deck == NULL || deck->head == NULL || deck->head->successor == NULL;
+	return CardFormat_print(deck, empty, CardFormat_deckBody, style, out);
+}
+
+typedef struct {
+	const PackedCard* cards;
+	int count;
+} CardFormatRange;
+
+static size_t CardFormat_packedBody(const void* cards, CardFormatStyle style, char* buffer, size_t size) {
+	const CardFormatRange* range = (const CardFormatRange*)cards;
+	return CardFormat_packed(range->cards, range->count, style, buffer, size);
+}
+
+/**
+* @brief Writes packed cards like CardFormat_printDeck, for the decks that store packed cards
+*
+* @param cards The packed cards, top card first
+* @param count Number of cards, 0 prints "Empty deck!"
+* @param style formatLong or formatShort
+* @param out Stream to write to
+* @return 0, or -1 if allocating or writing fails
+*/
+int CardFormat_printPacked(const PackedCard* cards, int count, CardFormatStyle style, FILE* out) {
+	CardFormatRange range = { cards, count };
+	return CardFormat_print(&range, count <= 0, CardFormat_packedBody, style, out);
+}
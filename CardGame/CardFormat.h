@@ -0,0 +1,41 @@
+/**
+ * @file CardFormat.h
+ * Provides interface for formatting cards and decks into text buffers.
+ *
+ * Instead of one printf per card, the name of every card is looked up in
+ * a table built once from suitNames and rankNames, and copied into a
+ * buffer given by the caller. The finished text can then be written with
+ * a single fwrite, which is what CardDeck_print does.
+ *
+ * Two styles are available: the long form used everywhere so far, e.g.
+ * <i>Heart-Ace</i>, and a short form, e.g. <i>H-A</i> or <i>S-10</i>.
+ * Cards are separated by ", ".
+ *
+ * Like snprintf, every function returns the length of the whole text and
+ * writes as much of it as fits, always followed by a terminating 0 when
+ * size is not 0. Passing NULL and 0 returns the length needed.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef CARDFORMAT_H
+#define CARDFORMAT_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "Card.h"
+#include "CardDeck.h"
+
+typedef enum {
+	formatLong, // Heart-Ace
+	formatShort // H-A
+} CardFormatStyle;
+
+size_t CardFormat_card(Card card, CardFormatStyle style, char* buffer, size_t size);
+size_t CardFormat_cards(const Card* cards, int count, CardFormatStyle style, char* buffer, size_t size);
+size_t CardFormat_packed(const PackedCard* cards, int count, CardFormatStyle style, char* buffer, size_t size);
+size_t CardFormat_deck(const CardDeck* deck, int first, int count, CardFormatStyle style, char* buffer, size_t size);
+int CardFormat_printDeck(const CardDeck* deck, CardFormatStyle style, FILE* out);
+int CardFormat_printPacked(const PackedCard* cards, int count, CardFormatStyle style, FILE* out);
+
+#endif
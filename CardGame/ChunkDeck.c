@@ -0,0 +1,438 @@
+/**
+* @file ChunkDeck.c
+* Provides implementation of the unrolled (chunked) linked list deck.
+*
+* Chunks are split in half when an insert finds them full, and a chunk
+* that drops below half full after a removal is merged with its
+* successor when both fit into one chunk.
+*
+* @date 19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CardFormat.h"
+#include "ChunkDeck.h"
+
+/************************************************************
+* Chunk helpers
+************************************************************/
+
+/**
+* Allocates an empty chunk.
+*/
+static CardChunk* CardChunk_create(void) {
+	CardChunk* chunk = (CardChunk*)malloc(sizeof(CardChunk));
+	if (chunk == NULL) return NULL;
+	chunk->next = NULL;
+	chunk->count = 0;
+	return chunk;
+}
+
+/**
+* Inserts a card at slot of chunk, splitting the chunk first if it is full.
+* A cursor inside the chunk keeps pointing at the same card.
+*
+* @return ok, or noMemory if a split was needed and failed
+*/
+static deckError ChunkDeck_insertIn(ChunkDeck* deck, CardChunk* chunk, int slot, PackedCard card) {
+	if (chunk->count == CHUNK_CAPACITY) {
+		CardChunk* upper = CardChunk_create();
+		if (upper == NULL) return noMemory;
+
+		// move the upper half into a new chunk right after this one
+		int half = CHUNK_CAPACITY / 2;
+		upper->count = (unsigned char)(chunk->count - half);
+		memcpy(upper->cards, chunk->cards + half, upper->count);
+		chunk->count = (unsigned char)half;
+		upper->next = chunk->next;
+		chunk->next = upper;
+
+		if (deck->current == chunk && deck->currentIndex >= half) {
+			deck->current = upper;
+			deck->currentIndex -= half;
+		}
+		if (slot > half) {
+			chunk = upper;
+			slot -= half;
+		}
+	}
+
+	memmove(chunk->cards + slot + 1, chunk->cards + slot, (size_t)(chunk->count - slot));
+	chunk->cards[slot] = card;
+	chunk->count++;
+	deck->count++;
+
+	if (deck->current == chunk && deck->currentIndex >= slot) {
+		deck->currentIndex++; // a card was inserted before the cursor card
+	}
+	return ok;
+}
+
+/**
+* Removes the card at slot of chunk; previous is the chunk before it (NULL for the head).
+* Empty chunks are unlinked, and a chunk below half full is merged with its successor
+* when both fit. The cursor must not be on the removed card.
+*
+* @return The removed card
+*/
+static PackedCard ChunkDeck_removeIn(ChunkDeck* deck, CardChunk* previous, CardChunk* chunk, int slot) {
+	PackedCard card = chunk->cards[slot];
+	memmove(chunk->cards + slot, chunk->cards + slot + 1, (size_t)(chunk->count - slot - 1));
+	chunk->count--;
+	deck->count--;
+
+	if (deck->current == chunk && deck->currentIndex > slot) {
+		deck->currentIndex--; // a card before the cursor card was removed
+	}
+
+	if (chunk->count == 0) {
+		if (previous == NULL) deck->head = chunk->next;
+		else previous->next = chunk->next;
+		free(chunk);
+	}
+	else if (chunk->count < CHUNK_CAPACITY / 2 && chunk->next != NULL
+		&& chunk->count + chunk->next->count <= CHUNK_CAPACITY) {
+		CardChunk* next = chunk->next;
+		if (deck->current == next) {
+			deck->current = chunk;
+			deck->currentIndex += chunk->count;
+		}
+		memcpy(chunk->cards + chunk->count, next->cards, next->count);
+		chunk->count = (unsigned char)(chunk->count + next->count);
+		chunk->next = next->next;
+		free(next);
+	}
+	return card;
+}
+
+/**
+* Finds the chunk and slot of the card at index.
+*
+* @param previous Receives the chunk before the found one, NULL for the head
+* @param slot Receives the slot inside the found chunk
+* @return The chunk, or NULL if index is out of bounds
+*/
+static CardChunk* ChunkDeck_find(ChunkDeck* deck, int index, CardChunk** previous, int* slot) {
+	if (index < 0 || index >= deck->count) return NULL;
+
+	CardChunk* before = NULL;
+	CardChunk* chunk = deck->head;
+	while (index >= chunk->count) { // skip whole chunks
+		index -= chunk->count;
+		before = chunk;
+		chunk = chunk->next;
+	}
+	if (previous) *previous = before;
+	*slot = index;
+	return chunk;
+}
+
+/************************************************************
+* Linked List Operations
+************************************************************/
+
+/**
+* Creates an empty chunked deck.
+*/
+ChunkDeck* ChunkDeck_create(void) {
+	ChunkDeck* deck = (ChunkDeck*)malloc(sizeof(ChunkDeck));
+	if (deck == NULL) return NULL;
+
+	deck->head = NULL;
+	deck->current = NULL;
+	deck->currentIndex = 0;
+	deck->count = 0;
+	return deck;
+}
+
+/**
+* Deletes a chunked deck and all of its chunks.
+*/
+void ChunkDeck_delete(ChunkDeck* deck) {
+	if (deck == NULL) return;
+
+	CardChunk* chunk = deck->head;
+	while (chunk != NULL) {
+		CardChunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	free(deck);
+}
+
+/**
+* Inserts numPacks ordered packs after the cursor, filling whole chunks.
+* Like CardDeck_fillDeck the cursor ends on the last inserted card.
+*
+* @return ok, illegalCard for a NULL deck, or noMemory
+*/
+deckError ChunkDeck_fillDeck(ChunkDeck* deck, int numPacks) {
+	if (deck == NULL) return illegalCard;
+	int remaining = numPacks * PACK_SIZE;
+	if (remaining <= 0) return ok;
+
+	// split the cursor chunk so the new chunks go between the two halves
+	CardChunk* before = deck->current;
+	CardChunk* after = before == NULL ? deck->head : before->next;
+	if (before != NULL && deck->currentIndex + 1 < before->count) {
+		CardChunk* tail = CardChunk_create();
+		if (tail == NULL) return noMemory;
+		tail->count = (unsigned char)(before->count - deck->currentIndex - 1);
+		memcpy(tail->cards, before->cards + deck->currentIndex + 1, tail->count);
+		before->count = (unsigned char)(deck->currentIndex + 1);
+		tail->next = after;
+		after = tail;
+	}
+
+	CardChunk* last = before;
+	int packed = 0; // next card of the ordered pack
+	while (remaining > 0) {
+		CardChunk* chunk = CardChunk_create();
+		if (chunk == NULL) {
+			if (last == NULL) deck->head = after;
+			else last->next = after;
+			return noMemory;
+		}
+
+		int n = remaining < CHUNK_CAPACITY ? remaining : CHUNK_CAPACITY;
+		for (int i = 0; i < n; i++) {
+			chunk->cards[i] = (PackedCard)packed;
+			packed = packed + 1 == PACK_SIZE ? 0 : packed + 1;
+		}
+		chunk->count = (unsigned char)n;
+
+		if (last == NULL) deck->head = chunk;
+		else last->next = chunk;
+		last = chunk;
+		deck->count += n;
+		remaining -= n;
+	}
+	last->next = after;
+	deck->current = last;
+	deck->currentIndex = last->count - 1;
+	return ok;
+}
+
+/**
+* Inserts a card after the cursor. The cursor stays on the same card.
+*
+* @return ok, illegalCard for a NULL deck, or noMemory
+*/
+deckError ChunkDeck_insertAfter(Card* card, ChunkDeck* deck) {
+	if (deck == NULL || card == NULL) return illegalCard;
+
+	if (deck->current == NULL) { // cursor at the head: insert before the first card
+		if (deck->head == NULL) {
+			deck->head = CardChunk_create();
+			if (deck->head == NULL) return noMemory;
+		}
+		return ChunkDeck_insertIn(deck, deck->head, 0, Card_pack(*card));
+	}
+	return ChunkDeck_insertIn(deck, deck->current, deck->currentIndex + 1, Card_pack(*card));
+}
+
+/**
+* Deletes the card after the cursor.
+*
+* @return ok, or illegalCard if there is no card after the cursor
+*/
+deckError ChunkDeck_deleteNext(ChunkDeck* deck) {
+	if (deck == NULL) return illegalCard;
+
+	if (deck->current == NULL) {
+		if (deck->head == NULL) return illegalCard;
+		ChunkDeck_removeIn(deck, NULL, deck->head, 0);
+	}
+	else if (deck->currentIndex + 1 < deck->current->count) {
+		ChunkDeck_removeIn(deck, NULL, deck->current, deck->currentIndex + 1); // previous is unused, chunk stays non-empty
+	}
+	else {
+		if (deck->current->next == NULL) return illegalCard;
+		ChunkDeck_removeIn(deck, deck->current, deck->current->next, 0);
+	}
+	return ok;
+}
+
+/**
+* Moves the cursor to the top card.
+*
+* @return ok, or illegalCard if the deck is empty
+*/
+deckError ChunkDeck_gotoTop(ChunkDeck* deck) {
+	if (deck == NULL || deck->head == NULL) return illegalCard;
+	deck->current = deck->head;
+	deck->currentIndex = 0;
+	return ok;
+}
+
+/**
+* Moves the cursor to the next card.
+*
+* @return ok, or illegalCard if there is no next card
+*/
+deckError ChunkDeck_gotoNextCard(ChunkDeck* deck) {
+	if (deck == NULL) return illegalCard;
+	if (deck->current == NULL) return ChunkDeck_gotoTop(deck);
+
+	if (deck->currentIndex + 1 < deck->current->count) {
+		deck->currentIndex++;
+		return ok;
+	}
+	if (deck->current->next == NULL) return illegalCard;
+	deck->current = deck->current->next;
+	deck->currentIndex = 0;
+	return ok;
+}
+
+/**
+* Returns the card under the cursor.
+*
+* @return The card, or INVALID_CARD with illegalCard if the cursor is at the head
+*/
+Card ChunkDeck_currentCard(ChunkDeck* deck, deckError* result) {
+	if (deck == NULL || deck->current == NULL) {
+		if (result) *result = illegalCard;
+		return INVALID_CARD;
+	}
+	if (result) *result = ok;
+	return Card_unpack(deck->current->cards[deck->currentIndex]);
+}
+
+/************************************************************
+* Essential Operations
+************************************************************/
+
+Card ChunkDeck_seeTop(ChunkDeck* deck, deckError* result) {
+	return ChunkDeck_cardAt(deck, 0, result);
+}
+
+deckError ChunkDeck_insertToTop(ChunkDeck* deck, Card card) {
+	if (deck == NULL) return illegalCard;
+	deck->current = NULL;
+	return ChunkDeck_insertAfter(&card, deck);
+}
+
+Card ChunkDeck_useTop(ChunkDeck* deck, deckError* result) {
+	return ChunkDeck_removeAt(deck, 0, result);
+}
+
+/************************************************************
+* Utility Operations
+************************************************************/
+
+/**
+* Returns the card at index (0 is the top card), skipping whole chunks.
+*/
+Card ChunkDeck_cardAt(ChunkDeck* deck, int index, deckError* result) {
+	int slot;
+	CardChunk* chunk = deck == NULL ? NULL : ChunkDeck_find(deck, index, NULL, &slot);
+	if (chunk == NULL) {
+		if (result) *result = illegalCard;
+		return INVALID_CARD;
+	}
+	if (result) *result = ok;
+	return Card_unpack(chunk->cards[slot]);
+}
+
+/**
+* Removes and returns the card at index (0 is the top card).
+* The cursor is reset to the head.
+*/
+Card ChunkDeck_removeAt(ChunkDeck* deck, int index, deckError* result) {
+	int slot;
+	CardChunk* previous;
+	CardChunk* chunk = deck == NULL ? NULL : ChunkDeck_find(deck, index, &previous, &slot);
+	if (chunk == NULL) {
+		if (result) *result = illegalCard;
+		return INVALID_CARD;
+	}
+
+	deck->current = NULL;
+	PackedCard card = ChunkDeck_removeIn(deck, previous, chunk, slot);
+	if (result) *result = ok;
+	return Card_unpack(card);
+}
+
+int ChunkDeck_count(ChunkDeck* deck) {
+	return deck == NULL ? 0 : deck->count;
+}
+
+void ChunkDeck_print(ChunkDeck* deck) {
+	if (deck == NULL || deck->count == 0) {
+		CardFormat_printPacked(NULL, 0, formatLong, stdout);
+		return;
+	}
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)deck->count);
+	if (cards == NULL) return;
+	int n = 0;
+	for (CardChunk* chunk = deck->head; chunk != NULL; chunk = chunk->next) {
+		memcpy(cards + n, chunk->cards, chunk->count);
+		n += chunk->count;
+	}
+	CardFormat_printPacked(cards, n, formatLong, stdout);
+	free(cards);
+}
+
+/************************************************************
+* Complex Operations
+************************************************************/
+
+/**
+* Fisher-Yates shuffle over all cards, chunk layout and cursor stay as they are.
+*
+* @return ok, illegalCard if the deck is invalid or empty, noMemory if allocation fails
+*/
+deckError ChunkDeck_shuffleWith(ChunkDeck* deck, Rng* rng) {
+	if (deck == NULL || deck->count == 0) return illegalCard;
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)deck->count);
+	if (cards == NULL) return noMemory;
+
+	int n = 0;
+	for (CardChunk* chunk = deck->head; chunk != NULL; chunk = chunk->next) {
+		memcpy(cards + n, chunk->cards, chunk->count);
+		n += chunk->count;
+	}
+
+	for (int i = n - 1; i > 0; i--) {
+		int pos = (int)Rng_bounded(rng, (uint32_t)i + 1);
+		PackedCard temp = cards[i];
+		cards[i] = cards[pos];
+		cards[pos] = temp;
+	}
+
+	n = 0;
+	for (CardChunk* chunk = deck->head; chunk != NULL; chunk = chunk->next) {
+		memcpy(chunk->cards, cards + n, chunk->count);
+		n += chunk->count;
+	}
+	free(cards);
+	return ok;
+}
+
+/**
+* Sorts by suit then rank. Packed cards are already in that order,
+* so this is a counting sort over the 52 possible values.
+*/
+void ChunkDeck_sort(ChunkDeck* deck) {
+	if (deck == NULL) return;
+
+	int counts[PACK_SIZE] = { 0 };
+	for (CardChunk* chunk = deck->head; chunk != NULL; chunk = chunk->next) {
+		for (int i = 0; i < chunk->count; i++) {
+			counts[chunk->cards[i]]++;
+		}
+	}
+
+	int value = 0;
+	for (CardChunk* chunk = deck->head; chunk != NULL; chunk = chunk->next) {
+		for (int i = 0; i < chunk->count; i++) {
+			while (counts[value] == 0) value++;
+			chunk->cards[i] = (PackedCard)value;
+			counts[value]--;
+		}
+	}
+}
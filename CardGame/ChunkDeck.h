@@ -0,0 +1,70 @@
+/**
+ * @file ChunkDeck.h
+ * Provides interface for the unrolled (chunked) linked list deck.
+ *
+ * A ChunkDeck stores the same sequence of cards as a CardDeck, but every
+ * list node (chunk) holds up to CHUNK_CAPACITY cards packed into one byte
+ * each, so a chunk is exactly one 64-byte cache line. Walking by index
+ * skips whole chunks, the card count is kept up to date, and a deck needs
+ * one malloc per chunk instead of one per card.
+ *
+ * The cursor works like CardDeck's current node: it starts before the
+ * first card (the "head"), CardDeck_insertAfter/deleteNext act right after
+ * it, and gotoTop/gotoNextCard move it. The operations by index
+ * (insertToTop, useTop, removeAt) reset the cursor to the head.
+ *
+ * Cards are returned by value, so unlike CardDeck_useTop and
+ * CardDeck_removeAt nothing has to be freed by the caller. INVALID_CARD
+ * is returned together with illegalCard on errors.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef CHUNKDECK_H
+#define CHUNKDECK_H
+
+#include "Card.h"
+#include "CardDeck.h"
+#include "Rng.h"
+
+#define CHUNK_CAPACITY 55 // cards per chunk: 8-byte link + 1-byte count + 55 cards = 64 bytes
+
+typedef struct CardChunk {
+	struct CardChunk* next; // next chunk, NULL for the last one
+	unsigned char count; // cards used in this chunk, 1..CHUNK_CAPACITY
+	PackedCard cards[CHUNK_CAPACITY]; // the cards in deck order
+} CardChunk;
+
+typedef struct {
+	CardChunk* head; // first chunk, NULL when the deck is empty
+	CardChunk* current; // chunk of the cursor card, NULL when the cursor is at the head
+	int currentIndex; // index of the cursor card inside current
+	int count; // total number of cards
+} ChunkDeck;
+
+// Linked list operations
+ChunkDeck* ChunkDeck_create(void);
+void ChunkDeck_delete(ChunkDeck* deck);
+deckError ChunkDeck_fillDeck(ChunkDeck* deck, int numPacks);
+deckError ChunkDeck_insertAfter(Card* card, ChunkDeck* deck);
+deckError ChunkDeck_deleteNext(ChunkDeck* deck);
+deckError ChunkDeck_gotoTop(ChunkDeck* deck);
+deckError ChunkDeck_gotoNextCard(ChunkDeck* deck);
+Card ChunkDeck_currentCard(ChunkDeck* deck, deckError* result);
+
+// Essential operations
+Card ChunkDeck_seeTop(ChunkDeck* deck, deckError* result);
+deckError ChunkDeck_insertToTop(ChunkDeck* deck, Card card);
+Card ChunkDeck_useTop(ChunkDeck* deck, deckError* result);
+
+// Util operations
+Card ChunkDeck_cardAt(ChunkDeck* deck, int index, deckError* result);
+Card ChunkDeck_removeAt(ChunkDeck* deck, int index, deckError* result);
+int ChunkDeck_count(ChunkDeck* deck);
+void ChunkDeck_print(ChunkDeck* deck);
+
+// Complex operations
+deckError ChunkDeck_shuffleWith(ChunkDeck* deck, Rng* rng);
+void ChunkDeck_sort(ChunkDeck* deck);
+
+#endif
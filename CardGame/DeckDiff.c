@@ -0,0 +1,543 @@
+/**
+* @file DeckDiff.c
+* Implementation of the differential check of the deck backends.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "DeckDiff.h"
+#include "bench.h"
+#include "CardDeck.h"
+#include "ChunkDeck.h"
+#include "IndexedDeck.h"
+#include "PlayedPile.h"
+#include "Rules.h"
+#include "game.h"
+
+#define DECKDIFF_FAILED -1 // logged for an operation the backend refused
+#define DECKDIFF_SKIPPED -2 // logged for an insert into a full deck
+
+typedef struct {
+	CardDeck list; // deck of list
+	CardDeck listPlayed; // played deck of list, top card first
+	ChunkDeck* chunk; // deck of chunk
+	IndexedDeck* indexed; // deck of indexed
+	PackedCard* played; // played pile of chunk and indexed, oldest first
+	int pileCount; // cards in played
+	int playedCapacity; // cards played holds
+	Game game; // fast: p1 is the deck, played the pile
+	int count; // cards in the deck, kept by DeckDiff_play for every backend
+	int playedCount; // cards on the played pile, kept by DeckDiff_play for every backend
+	Rng rng; // generator of every shuffle
+} DiffDeck;
+
+typedef struct {
+	const char* name;
+	deckError (*init)(DiffDeck* deck, int numPacks);
+	void (*destroy)(DiffDeck* deck);
+	deckError (*insertToTop)(DiffDeck* deck, Card card);
+	int (*take)(DiffDeck* deck, int index); // useTop for index 0, the card goes onto the played pile
+	void (*sort)(DiffDeck* deck);
+	deckError (*shuffle)(DiffDeck* deck);
+	deckError (*recycle)(DiffDeck* deck);
+	int (*findMatch)(DiffDeck* deck, RuleVariant rules);
+	void (*snapshot)(DiffDeck* deck, PackedCard* cards); // the deck top first, then the played pile top first
+} DiffBackendOps;
+
+typedef struct {
+	uint8_t op; // DiffOp
+	uint32_t arg; // card, position or rule variant, taken modulo what the operation needs
+} DiffStep;
+
+/************************************************************
+* list: the reference
+************************************************************/
+
+static deckError DeckDiff_listInit(DiffDeck* deck, int numPacks) {
+	if (CardDeck_init(&deck->list) != ok) return noMemory;
+	if (CardDeck_init(&deck->listPlayed) != ok) {
+		CardDeck_destroy(&deck->list);
+		return noMemory;
+	}
+	if (CardDeck_fillDeck(&deck->list, numPacks) == NULL) {
+		CardDeck_destroy(&deck->list);
+		CardDeck_destroy(&deck->listPlayed);
+		return noMemory;
+	}
+	return ok;
+}
+
+static void DeckDiff_listDestroy(DiffDeck* deck) {
+	CardDeck_destroy(&deck->list);
+	CardDeck_destroy(&deck->listPlayed);
+}
+
+static deckError DeckDiff_listInsert(DiffDeck* deck, Card card) {
+	return CardDeck_insertToTop(&deck->list, card);
+}
+
+static int DeckDiff_listTake(DiffDeck* deck, int index) {
+	deckError err = ok;
+	Card* card = index == 0 ? CardDeck_useTop(&deck->list, &err) : CardDeck_removeAt(&deck->list, index, &err);
+	if (card == NULL || err != ok) return DECKDIFF_FAILED;
+	int packed = Card_pack(*card);
+	err = CardDeck_insertToTop(&deck->listPlayed, *card);
+	free(card);
+	return err == ok ? packed : DECKDIFF_FAILED;
+}
+
+static void DeckDiff_listSort(DiffDeck* deck) {
+	CardDeck_sort(&deck->list);
+}
+
+static deckError DeckDiff_listShuffle(DiffDeck* deck) {
+	return CardDeck_shuffleWith(&deck->list, &deck->rng);
+}
+
+static deckError DeckDiff_listRecycle(DiffDeck* deck) {
+	return CardDeck_recycleHiddenWith(&deck->list, &deck->listPlayed, &deck->rng);
+}
+
+static int DeckDiff_listFindMatch(DiffDeck* deck, RuleVariant rules) {
+	const CardNode* top = deck->listPlayed.head->successor;
+	if (top == NULL) return -1;
+	int index = 0;
+	for (const CardNode* node = deck->list.head->successor; node != NULL; node = node->successor, index++) {
+		if (Rules_matches(rules, &node->card, &top->card)) return index;
+	}
+	return -1;
+}
+
+static void DeckDiff_listSnapshot(DiffDeck* deck, PackedCard* cards) {
+	const CardDeck* decks[2] = { &deck->list, &deck->listPlayed };
+	for (int d = 0; d < 2; d++) {
+		CardDeckIter it = CardDeck_iter(decks[d]);
+		const Card* card;
+		while ((card = CardDeckIter_next(&it)) != NULL) *cards++ = Card_pack(*card);
+	}
+}
+
+/************************************************************
+* chunk and indexed: played pile as an array
+************************************************************/
+
+/**
+* Puts a card on the played pile of chunk or indexed.
+*/
+static deckError DeckDiff_push(DiffDeck* deck, PackedCard card) {
+	if (deck->pileCount == deck->playedCapacity) {
+		int capacity = deck->playedCapacity > 0 ? deck->playedCapacity * 2 : PLAYEDPILE_INITIAL;
+		PackedCard* played = (PackedCard*)realloc(deck->played, (size_t)capacity);
+		if (played == NULL) return noMemory;
+		deck->played = played;
+		deck->playedCapacity = capacity;
+	}
+	deck->played[deck->pileCount++] = card;
+	return ok;
+}
+
+/**
+* Writes the played pile of chunk or indexed top first.
+*/
+static void DeckDiff_snapshotPlayed(const DiffDeck* deck, PackedCard* cards) {
+	for (int i = deck->pileCount - 1; i >= 0; i--) *cards++ = deck->played[i];
+}
+
+static deckError DeckDiff_chunkInit(DiffDeck* deck, int numPacks) {
+	deck->chunk = ChunkDeck_create();
+	if (deck->chunk == NULL) return noMemory;
+	deckError err = ChunkDeck_fillDeck(deck->chunk, numPacks);
+	if (err != ok) ChunkDeck_delete(deck->chunk);
+	return err;
+}
+
+static void DeckDiff_chunkDestroy(DiffDeck* deck) {
+	ChunkDeck_delete(deck->chunk);
+	free(deck->played);
+}
+
+static deckError DeckDiff_chunkInsert(DiffDeck* deck, Card card) {
+	return ChunkDeck_insertToTop(deck->chunk, card);
+}
+
+static int DeckDiff_chunkTake(DiffDeck* deck, int index) {
+	deckError err = ok;
+	Card card = index == 0 ? ChunkDeck_useTop(deck->chunk, &err) : ChunkDeck_removeAt(deck->chunk, index, &err);
+	if (err != ok || DeckDiff_push(deck, Card_pack(card)) != ok) return DECKDIFF_FAILED;
+	return Card_pack(card);
+}
+
+static void DeckDiff_chunkSort(DiffDeck* deck) {
+	ChunkDeck_sort(deck->chunk);
+}
+
+static deckError DeckDiff_chunkShuffle(DiffDeck* deck) {
+	return ChunkDeck_shuffleWith(deck->chunk, &deck->rng);
+}
+
+static deckError DeckDiff_chunkRecycle(DiffDeck* deck) {
+	if (deck->pileCount < 2) return illegalCard;
+	// oldest card ends up on top, like CardDeck_recycleHiddenWith leaves it
+	for (int i = deck->pileCount - 2; i >= 0; i--) {
+		if (ChunkDeck_insertToTop(deck->chunk, Card_unpack(deck->played[i])) != ok) return noMemory;
+	}
+	deck->played[0] = deck->played[deck->pileCount - 1];
+	deck->pileCount = 1;
+	return ChunkDeck_shuffleWith(deck->chunk, &deck->rng);
+}
+
+static int DeckDiff_chunkFindMatch(DiffDeck* deck, RuleVariant rules) {
+	if (deck->pileCount == 0) return -1;
+	Card top = Card_unpack(deck->played[deck->pileCount - 1]);
+	int index = 0;
+	for (const CardChunk* chunk = deck->chunk->head; chunk != NULL; chunk = chunk->next) {
+		for (int i = 0; i < chunk->count; i++, index++) {
+			Card card = Card_unpack(chunk->cards[i]);
+			if (Rules_matches(rules, &card, &top)) return index;
+		}
+	}
+	return -1;
+}
+
+static void DeckDiff_chunkSnapshot(DiffDeck* deck, PackedCard* cards) {
+	for (const CardChunk* chunk = deck->chunk->head; chunk != NULL; chunk = chunk->next) {
+		memcpy(cards, chunk->cards, chunk->count);
+		cards += chunk->count;
+	}
+	DeckDiff_snapshotPlayed(deck, cards);
+}
+
+static deckError DeckDiff_indexedInit(DiffDeck* deck, int numPacks) {
+	deck->indexed = IndexedDeck_create();
+	if (deck->indexed == NULL) return noMemory;
+	deckError err = IndexedDeck_fillDeck(deck->indexed, numPacks);
+	if (err != ok) IndexedDeck_delete(deck->indexed);
+	return err;
+}
+
+static void DeckDiff_indexedDestroy(DiffDeck* deck) {
+	IndexedDeck_delete(deck->indexed);
+	free(deck->played);
+}
+
+static deckError DeckDiff_indexedInsert(DiffDeck* deck, Card card) {
+	return IndexedDeck_insertToTop(deck->indexed, card);
+}
+
+static int DeckDiff_indexedTake(DiffDeck* deck, int index) {
+	deckError err = ok;
+	Card card = index == 0 ? IndexedDeck_useTop(deck->indexed, &err) : IndexedDeck_removeAt(deck->indexed, index, &err);
+	if (err != ok || DeckDiff_push(deck, Card_pack(card)) != ok) return DECKDIFF_FAILED;
+	return Card_pack(card);
+}
+
+static void DeckDiff_indexedSort(DiffDeck* deck) {
+	IndexedDeck_sort(deck->indexed);
+}
+
+static deckError DeckDiff_indexedShuffle(DiffDeck* deck) {
+	return IndexedDeck_shuffleWith(deck->indexed, &deck->rng);
+}
+
+static deckError DeckDiff_indexedRecycle(DiffDeck* deck) {
+	if (deck->pileCount < 2) return illegalCard;
+	for (int i = deck->pileCount - 2; i >= 0; i--) {
+		if (IndexedDeck_insertToTop(deck->indexed, Card_unpack(deck->played[i])) != ok) return noMemory;
+	}
+	deck->played[0] = deck->played[deck->pileCount - 1];
+	deck->pileCount = 1;
+	return IndexedDeck_shuffleWith(deck->indexed, &deck->rng);
+}
+
+static int DeckDiff_indexedFindMatch(DiffDeck* deck, RuleVariant rules) {
+	if (deck->pileCount == 0) return -1;
+	Card top = Card_unpack(deck->played[deck->pileCount - 1]);
+	int count = IndexedDeck_count(deck->indexed);
+	for (int i = 0; i < count; i++) {
+		Card card = IndexedDeck_cardAt(deck->indexed, i, NULL);
+		if (Rules_matches(rules, &card, &top)) return i;
+	}
+	return -1;
+}
+
+static void DeckDiff_indexedSnapshot(DiffDeck* deck, PackedCard* cards) {
+	int count = IndexedDeck_count(deck->indexed);
+	for (int i = 0; i < count; i++) *cards++ = Card_pack(IndexedDeck_cardAt(deck->indexed, i, NULL));
+	DeckDiff_snapshotPlayed(deck, cards);
+}
+
+/************************************************************
+* fast: the paths games take
+************************************************************/
+
+static deckError DeckDiff_fastInit(DiffDeck* deck, int numPacks) {
+	if (Game_initDecks(&deck->game, &deck->rng) != ok) return noMemory;
+	if (CardDeck_fillDeck(&deck->game.p1, numPacks) == NULL) {
+		Game_free(&deck->game);
+		return noMemory;
+	}
+	return ok;
+}
+
+static void DeckDiff_fastDestroy(DiffDeck* deck) {
+	Game_free(&deck->game);
+}
+
+static deckError DeckDiff_fastInsert(DiffDeck* deck, Card card) {
+	return CardDeck_insertToTop(&deck->game.p1, card);
+}
+
+static int DeckDiff_fastTake(DiffDeck* deck, int index) {
+	deckError err = ok;
+	CardNode* node = CardDeck_unlinkAt(&deck->game.p1, index, &err);
+	if (node == NULL || err != ok) return DECKDIFF_FAILED;
+	int packed = Card_pack(node->card);
+	return PlayedPile_pushNode(&deck->game.played, node) == ok ? packed : DECKDIFF_FAILED;
+}
+
+static void DeckDiff_fastSort(DiffDeck* deck) {
+	CardDeck_sort(&deck->game.p1);
+}
+
+static deckError DeckDiff_fastShuffle(DiffDeck* deck) {
+	return CardDeck_shuffleWith(&deck->game.p1, &deck->rng);
+}
+
+static deckError DeckDiff_fastRecycle(DiffDeck* deck) {
+	return PlayedPile_recycleInto(&deck->game.played, &deck->game.p1, &deck->rng);
+}
+
+static int DeckDiff_fastFindMatch(DiffDeck* deck, RuleVariant rules) {
+	deck->game.rules = rules;
+	return CardDeck_findMatch(&deck->game); // scans p1, player 1 is always to move
+}
+
+static void DeckDiff_fastSnapshot(DiffDeck* deck, PackedCard* cards) {
+	CardDeckIter it = CardDeck_iter(&deck->game.p1);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) *cards++ = Card_pack(*card);
+	const PlayedPile* pile = &deck->game.played;
+	if (pile->count > 0) *cards++ = pile->top;
+	for (int i = pile->count - 2; i >= 0; i--) *cards++ = pile->cards[i];
+}
+
+static const DiffBackendOps backendOps[diffBackends] = {
+	{ "list", DeckDiff_listInit, DeckDiff_listDestroy, DeckDiff_listInsert, DeckDiff_listTake, DeckDiff_listSort,
+		DeckDiff_listShuffle, DeckDiff_listRecycle, DeckDiff_listFindMatch, DeckDiff_listSnapshot },
+	{ "chunk", DeckDiff_chunkInit, DeckDiff_chunkDestroy, DeckDiff_chunkInsert, DeckDiff_chunkTake, DeckDiff_chunkSort,
+		DeckDiff_chunkShuffle, DeckDiff_chunkRecycle, DeckDiff_chunkFindMatch, DeckDiff_chunkSnapshot },
+	{ "indexed", DeckDiff_indexedInit, DeckDiff_indexedDestroy, DeckDiff_indexedInsert, DeckDiff_indexedTake,
+		DeckDiff_indexedSort, DeckDiff_indexedShuffle, DeckDiff_indexedRecycle, DeckDiff_indexedFindMatch,
+		DeckDiff_indexedSnapshot },
+	{ "fast", DeckDiff_fastInit, DeckDiff_fastDestroy, DeckDiff_fastInsert, DeckDiff_fastTake, DeckDiff_fastSort,
+		DeckDiff_fastShuffle, DeckDiff_fastRecycle, DeckDiff_fastFindMatch, DeckDiff_fastSnapshot },
+};
+
+/**
+* Sets up the deck of a backend with numPacks ordered packs and an empty played pile.
+*/
+static deckError DeckDiff_init(DiffDeck* deck, DiffBackend backend, int numPacks, uint64_t seed) {
+	memset(deck, 0, sizeof(*deck));
+	Rng_seedStream(&deck->rng, seed, 0);
+	deck->count = numPacks * PACK_SIZE;
+	return backendOps[backend].init(deck, numPacks);
+}
+
+/**
+* Picks the operations of a segment.
+*/
+static void DeckDiff_plan(DiffStep* steps, int count, Rng* rng) {
+	for (int i = 0; i < count; i++) {
+		uint32_t kind = Rng_bounded(rng, 100);
+		steps[i].op = (uint8_t)(kind < 30 ? diffInsertToTop : kind < 45 ? diffUseTop : kind < 65 ? diffRemoveAt :
+			kind < 90 ? diffFindMatch : kind < 93 ? diffSort : kind < 96 ? diffShuffle : diffRecycleHidden);
+		steps[i].arg = Rng_next32(rng);
+	}
+}
+
+/**
+* Plays a segment on one backend and logs what every operation returned.
+*/
+static void DeckDiff_play(const DiffBackendOps* ops, DiffDeck* deck, const DiffStep* steps, int count, int maxCards,
+	int* log) {
+	for (int i = 0; i < count; i++) {
+		uint32_t arg = steps[i].arg;
+		int result;
+		switch (steps[i].op) {
+		case diffInsertToTop:
+			result = DECKDIFF_SKIPPED;
+			if (deck->count < maxCards) {
+				result = ops->insertToTop(deck, Card_unpack((PackedCard)(arg % PACK_SIZE))) == ok ? 0 : DECKDIFF_FAILED;
+				deck->count += result == 0;
+			}
+			break;
+		case diffUseTop:
+		case diffRemoveAt:
+			// one position in 16 is past the end, or the top card of an empty deck, and must fail
+			result = ops->take(deck, steps[i].op == diffUseTop ? 0 : (int)(arg % (uint32_t)(deck->count + deck->count / 16 + 1)));
+			if (result >= 0) {
+				deck->count--;
+				deck->playedCount++;
+			}
+			break;
+		case diffSort:
+			ops->sort(deck);
+			result = 0;
+			break;
+		case diffShuffle:
+			result = ops->shuffle(deck) == ok ? 0 : DECKDIFF_FAILED;
+			break;
+		case diffRecycleHidden:
+			result = DECKDIFF_FAILED;
+			if (deck->playedCount >= 2) {
+				int moved = deck->playedCount - 1;
+				result = ops->recycle(deck) == ok ? 0 : DECKDIFF_FAILED;
+				deck->count += moved;
+				deck->playedCount = 1;
+			}
+			break;
+		default:
+			result = ops->findMatch(deck, (RuleVariant)(arg % rulesCount));
+			break;
+		}
+		log[i] = result;
+	}
+}
+
+/**
+* @brief Plays the same random operations on every backend and compares them
+* @details A backend that differs from the reference is not played any
+* further; its mismatch is the first operation whose result differed, or
+* the last operation of the segment after which its cards differed.
+*
+* @param seed Seed of the operations and of the generators of the shuffles
+* @param numOps Operations to play
+* @param numPacks Packs the decks start with, 1 to DECKDIFF_MAX_PACKS
+* @param report Receives the operations, time and mismatch of every backend
+* @return Number of backends that differ from the reference, -1 if numPacks
+* is out of range or allocation fails
+*/
+int DeckDiff_run(uint64_t seed, long long numOps, int numPacks, DiffReport* report) {
+	memset(report, 0, sizeof(*report));
+	if (numPacks < 1 || numPacks > DECKDIFF_MAX_PACKS) return -1;
+	int maxCards = 2 * numPacks * PACK_SIZE;
+
+	DiffDeck* decks = (DiffDeck*)calloc(diffBackends, sizeof(DiffDeck));
+	DiffStep* steps = (DiffStep*)malloc(DECKDIFF_SEGMENT * sizeof(DiffStep));
+	int* logs = (int*)malloc((size_t)diffBackends * DECKDIFF_SEGMENT * sizeof(int));
+	PackedCard* expected = NULL;
+	PackedCard* actual = NULL;
+	int room = 0;
+	int started = 0;
+	int failed = decks == NULL || steps == NULL || logs == NULL;
+	for (; !failed && started < diffBackends; started++) {
+		failed = DeckDiff_init(&decks[started], (DiffBackend)started, numPacks, seed) != ok;
+		if (failed) break;
+	}
+
+	Rng rng;
+	Rng_seedStream(&rng, seed, 1); // stream 0 of the seed shuffles, stream 1 picks the operations
+	int differing = 0;
+	for (int b = 0; b < diffBackends; b++) {
+		report->backends[b].name = backendOps[b].name;
+		report->backends[b].mismatch = -1;
+	}
+	for (long long first = 0; !failed && first < numOps; first += DECKDIFF_SEGMENT) {
+		int count = numOps - first < DECKDIFF_SEGMENT ? (int)(numOps - first) : DECKDIFF_SEGMENT;
+		DeckDiff_plan(steps, count, &rng);
+		for (int i = 0; i < count; i++) report->opCounts[steps[i].op]++;
+
+		for (int b = 0; b < diffBackends; b++) {
+			if (report->backends[b].mismatch >= 0) continue;
+			double start = Bench_seconds();
+			DeckDiff_play(&backendOps[b], &decks[b], steps, count, maxCards, logs + (size_t)b * DECKDIFF_SEGMENT);
+			report->backends[b].seconds += Bench_seconds() - start;
+			report->backends[b].ops += count;
+		}
+
+		// every deck holds at most maxCards cards, and the played pile what is not in it
+		int need = decks[diffList].count + decks[diffList].playedCount;
+		for (int b = 1; b < diffBackends; b++) {
+			if (decks[b].count + decks[b].playedCount > need) need = decks[b].count + decks[b].playedCount;
+		}
+		if (need > room) {
+			free(expected);
+			free(actual);
+			room = need * 2;
+			expected = (PackedCard*)malloc((size_t)room);
+			actual = (PackedCard*)malloc((size_t)room);
+			if (expected == NULL || actual == NULL) {
+				failed = 1;
+				break;
+			}
+		}
+		backendOps[diffList].snapshot(&decks[diffList], expected);
+		for (int b = 1; b < diffBackends; b++) {
+			if (report->backends[b].mismatch >= 0) continue;
+			const int* log = logs + (size_t)b * DECKDIFF_SEGMENT;
+			for (int i = 0; i < count && report->backends[b].mismatch < 0; i++) {
+				if (log[i] != logs[i]) report->backends[b].mismatch = first + i;
+			}
+			if (report->backends[b].mismatch < 0) {
+				int same = decks[b].count == decks[diffList].count && decks[b].playedCount == decks[diffList].playedCount;
+				if (same) {
+					backendOps[b].snapshot(&decks[b], actual);
+					same = memcmp(expected, actual, (size_t)(decks[b].count + decks[b].playedCount)) == 0;
+				}
+				if (!same) report->backends[b].mismatch = first + count - 1;
+			}
+			differing += report->backends[b].mismatch >= 0;
+		}
+	}
+
+	for (int b = 0; b < started; b++) backendOps[b].destroy(&decks[b]);
+	free(decks);
+	free(steps);
+	free(logs);
+	free(expected);
+	free(actual);
+	return failed ? -1 : differing;
+}
+
+/**
+* @brief Runs a chi-square test on the shuffle of a backend
+* @details A 4-card deck is shuffled trials times, each time from where the
+* last shuffle left it, and how often each of the 24 orders comes up is
+* compared with a uniform distribution.
+*
+* @param backend The backend
+* @param trials Number of shuffles, at least 24 * 5 for a meaningful test
+* @param seed Seed of the generator of the shuffles
+* @return The chi-square statistic with 23 degrees of freedom, -1 if allocation fails
+*/
+double DeckDiff_shuffleChiSquare(DiffBackend backend, int trials, uint64_t seed) {
+	const DiffBackendOps* ops = &backendOps[backend];
+	DiffDeck deck;
+	if (DeckDiff_init(&deck, backend, 0, seed) != ok) return -1;
+	int failed = 0;
+	for (int c = 0; c < 4; c++) failed |= ops->insertToTop(&deck, orderedPack[c]) != ok;
+
+	int seen[24] = { 0 };
+	for (int t = 0; t < trials && !failed; t++) {
+		PackedCard cards[4];
+		failed = ops->shuffle(&deck) != ok;
+		ops->snapshot(&deck, cards);
+		// index of the permutation: Lehmer code of the four cards
+		int index = 0;
+		for (int i = 0; i < 4; i++) {
+			int smaller = 0;
+			for (int j = i + 1; j < 4; j++) smaller += cards[j] < cards[i];
+			index = index * (4 - i) + smaller;
+		}
+		seen[index]++;
+	}
+	ops->destroy(&deck);
+	if (failed) return -1;
+
+	double expected = trials / 24.0;
+	double chi = 0;
+	for (int i = 0; i < 24; i++) chi += (seen[i] - expected) * (seen[i] - expected) / expected;
+	return chi;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file DeckDiff.h
+ * Provides interface for the differential check of the deck backends:
+ * the same random operations run on the linked-list CardDeck and on every
+ * other backend, and their results must be the same.
+ *
+ * Each backend holds a deck and a played pile. The operations are
+ * insertToTop, useTop and removeAt (the card taken goes onto the played
+ * pile), sort, shuffle, recycleHidden (every played card but the top one
+ * goes back into the deck, which is then shuffled) and findMatch (the
+ * first card of the deck that may be played on the top played card under
+ * a rule variant). The backends are
+ *
+ * - list: CardDeck with the plain functions of CardDeck.c and a linked
+ *   played deck, the reference
+ * - chunk: ChunkDeck
+ * - indexed: IndexedDeck
+ * - fast: CardDeck with the paths games take, a PlayedPile that keeps the
+ *   played nodes, CardDeck_unlinkAt and the per-variant CardDeck_findMatch
+ *
+ * Every shuffle is a Fisher-Yates shuffle drawing from the same generator
+ * in the same order, so the backends have to agree on every card. Each
+ * backend gets a generator of its own, seeded alike.
+ *
+ * Operations are played in segments of DECKDIFF_SEGMENT. Each backend
+ * plays a whole segment while it is timed, logging what every operation
+ * returned; between segments, and untimed, the logs and the full decks and
+ * played piles are compared with the reference. Operations on an empty
+ * deck or at a position past the end are part of the mix, and the backends
+ * have to fail them alike.
+ *
+ * DeckDiff_shuffleChiSquare checks that a backend's shuffle is uniform,
+ * the same way TestDeck checks CardDeck_shuffle.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef DECKDIFF_H
+#define DECKDIFF_H
+
+#include <stdint.h>
+
+#define DECKDIFF_SEGMENT 4096 // operations each backend plays between two comparisons
+#define DECKDIFF_MAX_PACKS 8 // most packs a run may start with; inserts stop once the deck holds twice its packs
+
+typedef enum {
+	diffList, // CardDeck, the reference
+	diffChunk, // ChunkDeck
+	diffIndexed, // IndexedDeck
+	diffFast, // CardDeck with PlayedPile and the game's fast paths
+	diffBackends // number of backends
+} DiffBackend;
+
+typedef enum {
+	diffInsertToTop,
+	diffUseTop,
+	diffRemoveAt,
+	diffSort,
+	diffShuffle,
+	diffRecycleHidden,
+	diffFindMatch,
+	diffOps // number of kinds of operations
+} DiffOp;
+
+typedef struct {
+	const char* name; // name of the backend
+	long long ops; // operations played
+	double seconds; // time spent playing them, comparisons not included
+	long long mismatch; // first operation after which the backend differs from the reference, -1 if none
+} DiffBackendReport;
+
+typedef struct {
+	DiffBackendReport backends[diffBackends];
+	long long opCounts[diffOps]; // operations played of each kind
+} DiffReport;
+
+int DeckDiff_run(uint64_t seed, long long numOps, int numPacks, DiffReport* report);
+double DeckDiff_shuffleChiSquare(DiffBackend backend, int trials, uint64_t seed);
+
+#endif
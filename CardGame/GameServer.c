@@ -0,0 +1,540 @@
+/**
+* @file GameServer.c
+* Implementation of the local multi-table game server.
+*
+* Every connection has an input and an output buffer. When epoll reports
+* input, the server reads what fits, handles every complete request and
+* queues the responses, then writes them all at once. While a connection
+* still has output queued it is only watched for EPOLLOUT, so a client
+* that does not read its responses cannot make the server buffer more.
+*
+* Tables live in one array and are handed out from a free list. A table
+* belongs to the connection that opened it and is freed when that
+* connection closes.
+*
+* @date 19.10.2026
+*/
+
+#ifdef __linux__
+#define _GNU_SOURCE // accept4
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "GameServer.h"
+
+#ifdef __linux__
+
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "game.h"
+#include "Rng.h"
+#include "Rules.h"
+
+#define SERVER_IN_BUFFER 8192 // request bytes buffered per connection
+#define SERVER_OUT_BUFFER 65536 // response bytes buffered per connection
+#define SERVER_MAX_RESPONSE (sizeof(ServerResponse) + SERVER_MAX_HAND)
+#define SERVER_EVENTS 64 // epoll events handled per wait
+
+typedef struct {
+	int fd; // socket, -1 when the slot is free
+	int inLength; // bytes in in
+	int outStart; // first byte of out not written yet
+	int outLength; // bytes in out
+	int waitingOut; // watched for EPOLLOUT instead of EPOLLIN until out is written
+	unsigned char in[SERVER_IN_BUFFER];
+	unsigned char out[SERVER_OUT_BUFFER];
+} ServerConnection;
+
+typedef struct {
+	Game game;
+	int owner; // connection slot that opened the table, -1 when the table is free
+	int nextFree; // next free table, -1 for none
+} ServerTable;
+
+typedef struct {
+	int listener; // listening socket
+	int epoll; // epoll instance
+	int running; // cleared by serverShutdown
+	int freeTables; // first free table, -1 for none
+	ServerTable* tables; // the table arena
+	ServerConnection* connections; // the connection arena
+	Rng rng; // shuffles of every table, the server has one thread
+} GameServer;
+
+static volatile sig_atomic_t serverInterrupted = 0;
+
+static void GameServer_onSignal(int sig) {
+	serverInterrupted = 1;
+}
+
+/**
+* Fills addr from an address string, see GameServer.h.
+*
+* @return length of the address, 0 if the address is invalid
+*/
+static socklen_t GameServer_address(const char* address, struct sockaddr_storage* addr) {
+	memset(addr, 0, sizeof(*addr));
+	if (address[0] == '/') {
+		struct sockaddr_un* un = (struct sockaddr_un*)addr;
+		if (strlen(address) >= sizeof(un->sun_path)) return 0;
+		un->sun_family = AF_UNIX;
+		strcpy(un->sun_path, address);
+		return sizeof(struct sockaddr_un);
+	}
+
+	char* end;
+	long port = strtol(address, &end, 10);
+	if (*address == '\0' || *end != '\0' || port <= 0 || port > 65535) return 0;
+	struct sockaddr_in* in = (struct sockaddr_in*)addr;
+	in->sin_family = AF_INET;
+	in->sin_port = htons((uint16_t)port);
+	in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	return sizeof(struct sockaddr_in);
+}
+
+/**
+* Turns off Nagle's algorithm on TCP sockets, every batch is sent at once anyway.
+*/
+static void GameServer_noDelay(int fd, const struct sockaddr_storage* addr) {
+	if (addr->ss_family == AF_INET) {
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+}
+
+/**
+* @brief Connects a blocking socket to a game server
+*
+* @param address Unix socket path or TCP port, see GameServer.h
+* @return the socket, -1 if the address is invalid or nobody listens there
+*/
+int GameServer_connect(const char* address) {
+	struct sockaddr_storage addr;
+	socklen_t length = GameServer_address(address, &addr);
+	if (length == 0) return -1;
+	int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) return -1;
+	if (connect(fd, (struct sockaddr*)&addr, length) != 0) {
+		close(fd);
+		return -1;
+	}
+	GameServer_noDelay(fd, &addr);
+	return fd;
+}
+
+/**
+* Fills the response for a table and appends the hand of the player to move.
+*/
+static void GameServer_describe(const ServerTable* table, ServerResponse* response, unsigned char* hand) {
+	const Game* game = &table->game;
+	const Card* topCard = PlayedPile_top(&game->played);
+	int hidden = CardDeck_count(&game->hidden);
+	int played = PlayedPile_count(&game->played);
+	int other = CardDeck_count(game->turn == 0 ? &game->p2 : &game->p1);
+
+	response->status = (uint8_t)game->status;
+	response->turn = (uint8_t)game->turn;
+	response->top = topCard != NULL ? Card_pack(*topCard) : 0;
+	response->otherCount = (uint8_t)(other > 255 ? 255 : other);
+	response->hiddenCount = (uint16_t)(hidden > 0xFFFF ? 0xFFFF : hidden);
+	response->playedCount = (uint16_t)(played > 0xFFFF ? 0xFFFF : played);
+
+	CardDeckIter it = CardDeck_iter(game->turn == 0 ? &game->p1 : &game->p2);
+	const Card* card;
+	int count = 0;
+	while (count < SERVER_MAX_HAND && (card = CardDeckIter_next(&it)) != NULL) {
+		hand[count++] = Card_pack(*card);
+	}
+	response->handCount = (uint8_t)count;
+}
+
+/**
+* Opens a new table for a connection.
+*
+* @return the table id, -1 if every table is in use
+*/
+static int GameServer_openTable(GameServer* server, int connection) {
+	int id = server->freeTables;
+	if (id < 0) return -1;
+	server->freeTables = server->tables[id].nextFree;
+	server->tables[id].owner = connection;
+	return id;
+}
+
+/**
+* Puts a table without a game back on the free list.
+*/
+static void GameServer_releaseTable(GameServer* server, int id) {
+	server->tables[id].owner = -1;
+	server->tables[id].nextFree = server->freeTables;
+	server->freeTables = id;
+}
+
+/**
+* Frees the game of a table and puts the table back on the free list.
+*/
+static void GameServer_closeTable(GameServer* server, int id) {
+	Game_free(&server->tables[id].game);
+	GameServer_releaseTable(server, id);
+}
+
+/**
+* Deals a new game at a table that has no game.
+*
+* @return replyOk, or replyFull if there is not enough memory
+*/
+static ServerReply GameServer_deal(GameServer* server, ServerTable* table, int numPacks) {
+	if (Game_init(&table->game, numPacks > 0 ? numPacks : 1, &server->rng) != ok) {
+		return replyFull;
+	}
+	return replyOk;
+}
+
+/**
+* Handles one request and appends its response to out.
+*
+* @return number of bytes appended
+*/
+static int GameServer_handle(GameServer* server, int connection, const ServerRequest* request, unsigned char* out) {
+	ServerResponse response;
+	memset(&response, 0, sizeof(response));
+	response.seq = request->seq;
+	response.table = request->table;
+	response.reply = replyOk;
+
+	ServerTable* table = NULL;
+	if (request->op == serverDeal && request->table == SERVER_NEW_TABLE) {
+		int id = GameServer_openTable(server, connection);
+		if (id < 0) {
+			response.reply = replyFull;
+		}
+		else {
+			table = &server->tables[id];
+			response.table = (uint16_t)id;
+			response.reply = GameServer_deal(server, table, request->index);
+			if (response.reply != replyOk) {
+				// Game_init freed what it made, only the slot is left
+				GameServer_releaseTable(server, id);
+				table = NULL;
+			}
+		}
+	}
+	else if (request->op == serverShutdown) {
+		server->running = 0;
+	}
+	else if (request->table >= SERVER_MAX_TABLES || server->tables[request->table].owner != connection) {
+		response.reply = replyBadRequest;
+	}
+	else {
+		table = &server->tables[request->table];
+		Game* game = &table->game;
+		switch (request->op) {
+		case serverDeal:
+			Game_free(game);
+			response.reply = GameServer_deal(server, table, request->index);
+			if (response.reply != replyOk) {
+				// the table has no game any more, give it back
+				GameServer_releaseTable(server, request->table);
+				table = NULL;
+			}
+			break;
+		case serverPlay: {
+			const Card* target = PlayedPile_top(&game->played);
+			CardDeckIter hand = CardDeck_iter(game->turn == 0 ? &game->p1 : &game->p2);
+			const Card* card = CardDeckIter_next(&hand);
+			for (int i = 0; i < request->index && card != NULL; i++) {
+				card = CardDeckIter_next(&hand);
+			}
+			if (game->status != ongoing || card == NULL || target == NULL || !Rules_matches(game->rules, card, target)) {
+				response.reply = replyIllegalMove;
+			}
+			else {
+				Game_finishTurn(game, request->index);
+			}
+			break;
+		}
+		case serverDraw:
+			if (game->status != ongoing) {
+				response.reply = replyIllegalMove;
+			}
+			else {
+				Game_finishTurn(game, -1);
+			}
+			break;
+		case serverState:
+			break;
+		case serverClose:
+			GameServer_closeTable(server, request->table);
+			table = NULL;
+			break;
+		default:
+			response.reply = replyBadRequest;
+			break;
+		}
+	}
+
+	if (table != NULL) {
+		GameServer_describe(table, &response, out + sizeof(response));
+	}
+	memcpy(out, &response, sizeof(response));
+	return (int)sizeof(response) + response.handCount;
+}
+
+/**
+* Closes a connection and every table it opened.
+*/
+static void GameServer_drop(GameServer* server, int slot) {
+	ServerConnection* connection = &server->connections[slot];
+	for (int id = 0; id < SERVER_MAX_TABLES; id++) {
+		if (server->tables[id].owner == slot) GameServer_closeTable(server, id);
+	}
+	epoll_ctl(server->epoll, EPOLL_CTL_DEL, connection->fd, NULL);
+	close(connection->fd);
+	connection->fd = -1;
+}
+
+/**
+* Writes queued output and chooses what to wait for next.
+*
+* @return 0, or -1 if the connection failed
+*/
+static int GameServer_flush(GameServer* server, int slot) {
+	ServerConnection* connection = &server->connections[slot];
+	while (connection->outStart < connection->outLength) {
+		ssize_t written = write(connection->fd, connection->out + connection->outStart,
+			(size_t)(connection->outLength - connection->outStart));
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return -1;
+		}
+		connection->outStart += (int)written;
+	}
+
+	int blocked = connection->outStart < connection->outLength;
+	if (!blocked) {
+		connection->outStart = connection->outLength = 0;
+	}
+	if (blocked != connection->waitingOut) {
+		struct epoll_event event;
+		event.events = blocked ? EPOLLOUT : EPOLLIN;
+		event.data.u32 = (uint32_t)slot;
+		epoll_ctl(server->epoll, EPOLL_CTL_MOD, connection->fd, &event);
+		connection->waitingOut = blocked;
+	}
+	return 0;
+}
+
+/**
+* Handles every complete request in the input buffer while the responses fit.
+*/
+static void GameServer_process(GameServer* server, int slot) {
+	ServerConnection* connection = &server->connections[slot];
+	int used = 0;
+	while (connection->inLength - used >= (int)sizeof(ServerRequest) &&
+		connection->outLength + (int)SERVER_MAX_RESPONSE <= SERVER_OUT_BUFFER) {
+		ServerRequest request;
+		memcpy(&request, connection->in + used, sizeof(request));
+		used += (int)sizeof(request);
+		connection->outLength += GameServer_handle(server, slot, &request, connection->out + connection->outLength);
+	}
+	memmove(connection->in, connection->in + used, (size_t)(connection->inLength - used));
+	connection->inLength -= used;
+}
+
+/**
+* Reads, handles and answers what a connection sent.
+*
+* @return 0, or -1 if the connection is closed or failed
+*/
+static int GameServer_serve(GameServer* server, int slot) {
+	ServerConnection* connection = &server->connections[slot];
+	for (;;) {
+		GameServer_process(server, slot);
+		if (connection->inLength >= (int)sizeof(ServerRequest)) {
+			// the responses filled the output buffer, send them before handling more
+			if (GameServer_flush(server, slot) != 0) return -1;
+			if (connection->waitingOut) return 0;
+			continue;
+		}
+
+		ssize_t got = read(connection->fd, connection->in + connection->inLength,
+			(size_t)(SERVER_IN_BUFFER - connection->inLength));
+		if (got == 0) return -1;
+		if (got < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return -1;
+		}
+		connection->inLength += (int)got;
+	}
+	return GameServer_flush(server, slot);
+}
+
+/**
+* Accepts every waiting client into a free connection slot.
+*/
+static void GameServer_accept(GameServer* server) {
+	for (;;) {
+		int fd = accept4(server->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR) continue;
+			return;
+		}
+
+		int slot = 0;
+		while (slot < SERVER_MAX_CONNECTIONS && server->connections[slot].fd >= 0) slot++;
+		if (slot == SERVER_MAX_CONNECTIONS) {
+			close(fd);
+			continue;
+		}
+
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly on Unix sockets
+		ServerConnection* connection = &server->connections[slot];
+		connection->fd = fd;
+		connection->inLength = connection->outStart = connection->outLength = 0;
+		connection->waitingOut = 0;
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.u32 = (uint32_t)slot;
+		if (epoll_ctl(server->epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+			close(fd);
+			connection->fd = -1;
+		}
+	}
+}
+
+/**
+* Creates the listening socket.
+*
+* @return the socket, -1 on failure
+*/
+static int GameServer_listen(const char* address) {
+	struct sockaddr_storage addr;
+	socklen_t length = GameServer_address(address, &addr);
+	if (length == 0) return -1;
+	int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) return -1;
+
+	if (addr.ss_family == AF_UNIX) {
+		unlink(address); // left over from an earlier run
+	}
+	else {
+		int one = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	}
+	if (bind(fd, (struct sockaddr*)&addr, length) != 0 || listen(fd, SOMAXCONN) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+* @brief Runs the game server until a client sends serverShutdown or the
+* process gets SIGINT or SIGTERM
+*
+* @param address Unix socket path or TCP port to listen on, see GameServer.h
+* @return EXIT_SUCCESS, or EXIT_FAILURE if the server could not start
+*/
+int GameServer_run(const char* address) {
+	GameServer* server = (GameServer*)malloc(sizeof(GameServer));
+	if (server == NULL) return EXIT_FAILURE;
+	server->tables = (ServerTable*)malloc(SERVER_MAX_TABLES * sizeof(ServerTable));
+	server->connections = (ServerConnection*)malloc(SERVER_MAX_CONNECTIONS * sizeof(ServerConnection));
+	server->listener = GameServer_listen(address);
+	server->epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (server->tables == NULL || server->connections == NULL || server->listener < 0 || server->epoll < 0) {
+		fprintf(stderr, "server: cannot listen on %s\n", address);
+		if (server->listener >= 0) close(server->listener);
+		if (server->epoll >= 0) close(server->epoll);
+		free(server->tables);
+		free(server->connections);
+		free(server);
+		return EXIT_FAILURE;
+	}
+
+	for (int id = 0; id < SERVER_MAX_TABLES; id++) {
+		server->tables[id].owner = -1;
+		server->tables[id].nextFree = id + 1 < SERVER_MAX_TABLES ? id + 1 : -1;
+	}
+	server->freeTables = 0;
+	for (int slot = 0; slot < SERVER_MAX_CONNECTIONS; slot++) {
+		server->connections[slot].fd = -1;
+	}
+	Rng_seed(&server->rng, (uint64_t)time(NULL));
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = SERVER_MAX_CONNECTIONS; // marks the listener
+	epoll_ctl(server->epoll, EPOLL_CTL_ADD, server->listener, &event);
+
+	serverInterrupted = 0;
+	signal(SIGINT, GameServer_onSignal);
+	signal(SIGTERM, GameServer_onSignal);
+	signal(SIGPIPE, SIG_IGN);
+
+	server->running = 1;
+	while (server->running && !serverInterrupted) {
+		struct epoll_event events[SERVER_EVENTS];
+		int count = epoll_wait(server->epoll, events, SERVER_EVENTS, -1);
+		for (int e = 0; e < count; e++) {
+			uint32_t slot = events[e].data.u32;
+			if (slot == SERVER_MAX_CONNECTIONS) {
+				GameServer_accept(server);
+				continue;
+			}
+			ServerConnection* connection = &server->connections[slot];
+			if (connection->fd < 0) continue; // dropped earlier in this batch
+
+			int failed;
+			if (connection->waitingOut) {
+				// once the output is written, handle what waited in the input buffer
+				failed = GameServer_flush(server, (int)slot);
+				if (!failed && !connection->waitingOut) {
+					failed = GameServer_serve(server, (int)slot);
+				}
+			}
+			else {
+				failed = GameServer_serve(server, (int)slot);
+			}
+			if (failed) GameServer_drop(server, (int)slot);
+		}
+	}
+
+	for (int slot = 0; slot < SERVER_MAX_CONNECTIONS; slot++) {
+		if (server->connections[slot].fd >= 0) GameServer_drop(server, slot);
+	}
+	close(server->listener);
+	close(server->epoll);
+	if (address[0] == '/') unlink(address);
+	free(server->tables);
+	free(server->connections);
+	free(server);
+	return EXIT_SUCCESS;
+}
+
+#else
+
+int GameServer_run(const char* address) {
+	fprintf(stderr, "server: only available on Linux\n");
+	return EXIT_FAILURE;
+}
+
+int GameServer_connect(const char* address) {
+	return -1;
+}
+
+#endif
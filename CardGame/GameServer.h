@@ -0,0 +1,75 @@
+/**
+ * @file GameServer.h
+ * Provides interface for the local multi-table game server and its protocol.
+ *
+ * One process hosts up to SERVER_MAX_TABLES live tables, each a Game, in
+ * a fixed arena. Clients connect over a Unix socket (an address starting
+ * with '/') or TCP on localhost (an address of only digits, the port).
+ * The server is one thread with a non-blocking epoll loop. All responses
+ * to the requests found in one read are written back with one write.
+ *
+ * The protocol is binary, in the byte order of the machine, since client
+ * and server run on the same host. A client sends fixed-size
+ * ServerRequests. Every request gets a ServerResponse, followed by the
+ * handCount PackedCards of the hand of the player to move, so a client
+ * can pick its move from any response without an extra state request.
+ *
+ * The server is only available on Linux; elsewhere GameServer_run fails.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <stdint.h>
+
+#define SERVER_DEFAULT_ADDRESS "/tmp/cardgame.sock" // address used when none is given
+#define SERVER_MAX_TABLES 4096 // tables hosted at once
+#define SERVER_MAX_CONNECTIONS 256 // clients connected at once
+#define SERVER_NEW_TABLE 0xFFFF // table id of a deal request that opens a new table
+#define SERVER_MAX_HAND 255 // hand cards sent at most, handCount is one byte
+
+typedef enum { // what a request asks for
+	serverDeal, // deal a new game, at a new table if table is SERVER_NEW_TABLE. index is the number of packs, 0 for 1
+	serverPlay, // the player to move plays the card at index in their hand
+	serverDraw, // the player to move draws a card
+	serverState, // just report the state of the table
+	serverClose, // free the table
+	serverShutdown // stop the server after this batch
+} ServerOp;
+
+typedef enum { // result of a request
+	replyOk, // done, the response holds the new state
+	replyBadRequest, // unknown op, or a table that does not exist or belongs to another client
+	replyIllegalMove, // the card does not match under the game's rules, the index is out of range or the game is over
+	replyFull // no free table left, or a deal failed for lack of memory
+} ServerReply;
+
+typedef struct {
+	uint8_t op; // a ServerOp
+	uint8_t index; // hand index for serverPlay, packs for serverDeal
+	uint16_t table; // table id
+	uint32_t seq; // returned unchanged in the response
+} ServerRequest;
+
+typedef struct {
+	uint32_t seq; // seq of the request
+	uint16_t table; // table id, SERVER_NEW_TABLE if the request failed before a table was found
+	uint8_t reply; // a ServerReply
+	uint8_t status; // GameStatus of the table
+	uint8_t turn; // player to move, 0 or 1, or the winner once status is win
+	uint8_t top; // PackedCard on top of the played deck
+	uint8_t handCount; // cards of the player to move, sent after this struct
+	uint8_t otherCount; // cards of the other player, capped at 255
+	uint16_t hiddenCount; // cards left to draw
+	uint16_t playedCount; // cards on the played deck
+} ServerResponse;
+
+_Static_assert(sizeof(ServerRequest) == 8, "ServerRequest must have no padding");
+_Static_assert(sizeof(ServerResponse) == 16, "ServerResponse must have no padding");
+
+int GameServer_run(const char* address);
+int GameServer_connect(const char* address);
+
+#endif
@@ -0,0 +1,438 @@
+/**
+* @file IndexedDeck.c
+* Provides implementation of the order-statistic indexed deck
+* (implicit treap over an array of nodes).
+*
+* @date 19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "CardFormat.h"
+#include "IndexedDeck.h"
+
+#define INDEXEDDECK_INITIAL_CAPACITY 64 // nodes allocated by IndexedDeck_create
+
+/************************************************************
+* Treap helpers
+************************************************************/
+
+static int IndexedDeck_size(IndexedDeck* deck, int node) {
+	return node < 0 ? 0 : deck->nodes[node].size;
+}
+
+static void IndexedDeck_update(IndexedDeck* deck, int node) {
+	IndexedNode* n = &deck->nodes[node];
+	n->size = 1 + IndexedDeck_size(deck, n->left) + IndexedDeck_size(deck, n->right);
+}
+
+/**
+* Next priority from a xorshift32 generator. Priorities only need to be
+* independent of the card order, so a tiny generator is enough.
+*/
+static uint32_t IndexedDeck_priority(IndexedDeck* deck) {
+	uint32_t x = deck->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	deck->seed = x;
+	return x;
+}
+
+/**
+* Takes a free node and stores card in it, growing the node array if needed.
+*
+* @return The node index, or -1 if no memory is available
+*/
+static int IndexedDeck_newNode(IndexedDeck* deck, PackedCard card) {
+	int node;
+	if (deck->freeNodes >= 0) {
+		node = deck->freeNodes;
+		deck->freeNodes = deck->nodes[node].left;
+	}
+	else {
+		if (deck->used == deck->capacity) {
+			IndexedNode* grown = (IndexedNode*)realloc(deck->nodes, (size_t)deck->capacity * 2 * sizeof(IndexedNode));
+			if (grown == NULL) return -1;
+			deck->nodes = grown;
+			deck->capacity *= 2;
+		}
+		node = deck->used++;
+	}
+
+	IndexedNode* n = &deck->nodes[node];
+	n->left = -1;
+	n->right = -1;
+	n->size = 1;
+	n->priority = IndexedDeck_priority(deck);
+	n->card = card;
+	return node;
+}
+
+static void IndexedDeck_releaseNode(IndexedDeck* deck, int node) {
+	deck->nodes[node].left = deck->freeNodes;
+	deck->freeNodes = node;
+}
+
+/**
+* Splits the subtree at node into its first count cards (left) and the rest (right).
+*/
+static void IndexedDeck_split(IndexedDeck* deck, int node, int count, int* left, int* right) {
+	if (node < 0) {
+		*left = -1;
+		*right = -1;
+		return;
+	}
+
+	IndexedNode* n = &deck->nodes[node];
+	int leftSize = IndexedDeck_size(deck, n->left);
+	if (count <= leftSize) {
+		IndexedDeck_split(deck, n->left, count, left, &deck->nodes[node].left);
+		*right = node;
+	}
+	else {
+		IndexedDeck_split(deck, n->right, count - leftSize - 1, &deck->nodes[node].right, right);
+		*left = node;
+	}
+	IndexedDeck_update(deck, node);
+}
+
+/**
+* Joins two subtrees, every card of left coming before every card of right.
+*/
+static int IndexedDeck_merge(IndexedDeck* deck, int left, int right) {
+	if (left < 0) return right;
+	if (right < 0) return left;
+
+	if (deck->nodes[left].priority >= deck->nodes[right].priority) {
+		deck->nodes[left].right = IndexedDeck_merge(deck, deck->nodes[left].right, right);
+		IndexedDeck_update(deck, left);
+		return left;
+	}
+	deck->nodes[right].left = IndexedDeck_merge(deck, left, deck->nodes[right].left);
+	IndexedDeck_update(deck, right);
+	return right;
+}
+
+/**
+* Copies the cards in deck order into out, which must hold IndexedDeck_count cards.
+*/
+static void IndexedDeck_toArray(IndexedDeck* deck, PackedCard* out, int* stack) {
+	int top = 0;
+	int written = 0;
+	int node = deck->root;
+
+	while (node >= 0 || top > 0) {
+		while (node >= 0) {
+			stack[top++] = node;
+			node = deck->nodes[node].left;
+		}
+		node = stack[--top];
+		out[written++] = deck->nodes[node].card;
+		node = deck->nodes[node].right;
+	}
+}
+
+/**
+* Builds a treap holding cards in order in O(n), using the right spine as a stack.
+*
+* @return The root of the new subtree, -1 for no cards, or -2 if no memory is available
+*/
+static int IndexedDeck_build(IndexedDeck* deck, const PackedCard* cards, int count, int* stack) {
+	int top = 0;
+
+	for (int i = 0; i < count; i++) {
+		int node = IndexedDeck_newNode(deck, cards[i]);
+		if (node < 0) return -2;
+
+		// pop every spine node with a lower priority, they become the new node's left subtree
+		int last = -1;
+		while (top > 0 && deck->nodes[stack[top - 1]].priority < deck->nodes[node].priority) {
+			last = stack[--top];
+			IndexedDeck_update(deck, last);
+		}
+		deck->nodes[node].left = last;
+		if (top > 0) deck->nodes[stack[top - 1]].right = node;
+		stack[top++] = node;
+	}
+
+	// the nodes still on the spine get their sizes bottom-up
+	while (top > 1) {
+		IndexedDeck_update(deck, stack[--top]);
+	}
+	if (top == 0) return -1;
+	IndexedDeck_update(deck, stack[0]);
+	return stack[0];
+}
+
+/**
+* Replaces the whole deck by cards, reusing the node array.
+*/
+static deckError IndexedDeck_rebuild(IndexedDeck* deck, const PackedCard* cards, int count, int* stack) {
+	deck->used = 0;
+	deck->freeNodes = -1;
+	deck->root = IndexedDeck_build(deck, cards, count, stack);
+	if (deck->root == -2) { // cannot happen: count nodes already fit
+		deck->root = -1;
+		return noMemory;
+	}
+	return ok;
+}
+
+/************************************************************
+* Deck operations
+************************************************************/
+
+/**
+* Creates an empty indexed deck.
+*/
+IndexedDeck* IndexedDeck_create(void) {
+	IndexedDeck* deck = (IndexedDeck*)malloc(sizeof(IndexedDeck));
+	if (deck == NULL) return NULL;
+
+	deck->nodes = (IndexedNode*)malloc(INDEXEDDECK_INITIAL_CAPACITY * sizeof(IndexedNode));
+	if (deck->nodes == NULL) {
+		free(deck);
+		return NULL;
+	}
+	deck->capacity = INDEXEDDECK_INITIAL_CAPACITY;
+	deck->used = 0;
+	deck->freeNodes = -1;
+	deck->root = -1;
+	deck->seed = 0x9e3779b9u;
+	return deck;
+}
+
+void IndexedDeck_delete(IndexedDeck* deck) {
+	if (deck == NULL) return;
+	free(deck->nodes);
+	free(deck);
+}
+
+/**
+* Appends numPacks ordered packs below the current bottom card.
+*
+* @return ok, illegalCard for a NULL deck, or noMemory
+*/
+deckError IndexedDeck_fillDeck(IndexedDeck* deck, int numPacks) {
+	if (deck == NULL) return illegalCard;
+	int count = numPacks * PACK_SIZE;
+	if (count <= 0) return ok;
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)count);
+	int* stack = (int*)malloc((size_t)count * sizeof(int));
+	if (cards == NULL || stack == NULL) {
+		free(cards);
+		free(stack);
+		return noMemory;
+	}
+	for (int i = 0; i < count; i++) {
+		cards[i] = (PackedCard)(i % PACK_SIZE);
+	}
+
+	int built = IndexedDeck_build(deck, cards, count, stack);
+	free(cards);
+	free(stack);
+	if (built == -2) return noMemory;
+
+	deck->root = IndexedDeck_merge(deck, deck->root, built);
+	return ok;
+}
+
+Card IndexedDeck_seeTop(IndexedDeck* deck, deckError* result) {
+	return IndexedDeck_cardAt(deck, 0, result);
+}
+
+deckError IndexedDeck_insertToTop(IndexedDeck* deck, Card card) {
+	return IndexedDeck_insertAt(deck, 0, card);
+}
+
+Card IndexedDeck_useTop(IndexedDeck* deck, deckError* result) {
+	return IndexedDeck_removeAt(deck, 0, result);
+}
+
+/**
+* Returns the card at index (0 is the top card) in O(log n).
+*/
+Card IndexedDeck_cardAt(IndexedDeck* deck, int index, deckError* result) {
+	if (deck == NULL || index < 0 || index >= IndexedDeck_size(deck, deck->root)) {
+		if (result) *result = illegalCard;
+		return INVALID_CARD;
+	}
+
+	int node = deck->root;
+	for (;;) {
+		int leftSize = IndexedDeck_size(deck, deck->nodes[node].left);
+		if (index < leftSize) {
+			node = deck->nodes[node].left;
+		}
+		else if (index == leftSize) {
+			break;
+		}
+		else {
+			index -= leftSize + 1;
+			node = deck->nodes[node].right;
+		}
+	}
+	if (result) *result = ok;
+	return Card_unpack(deck->nodes[node].card);
+}
+
+/**
+* Inserts a card so that it ends up at index, 0 puts it on top and
+* IndexedDeck_count puts it at the bottom. O(log n) expected.
+*
+* @return ok, illegalCard if index is out of bounds, or noMemory
+*/
+deckError IndexedDeck_insertAt(IndexedDeck* deck, int index, Card card) {
+	if (deck == NULL || index < 0 || index > IndexedDeck_size(deck, deck->root)) return illegalCard;
+
+	int node = IndexedDeck_newNode(deck, Card_pack(card));
+	if (node < 0) return noMemory;
+	uint32_t priority = deck->nodes[node].priority;
+
+	// walk down while the tree nodes outrank the new one, then split below there
+	int* link = &deck->root;
+	while (*link >= 0 && deck->nodes[*link].priority >= priority) {
+		IndexedNode* n = &deck->nodes[*link];
+		n->size++;
+		int leftSize = IndexedDeck_size(deck, n->left);
+		if (index <= leftSize) {
+			link = &n->left;
+		}
+		else {
+			index -= leftSize + 1;
+			link = &n->right;
+		}
+	}
+
+	int left, right;
+	IndexedDeck_split(deck, *link, index, &left, &right);
+	deck->nodes[node].left = left;
+	deck->nodes[node].right = right;
+	IndexedDeck_update(deck, node);
+	*link = node;
+	return ok;
+}
+
+/**
+* Removes and returns the card at index (0 is the top card) in O(log n).
+*/
+Card IndexedDeck_removeAt(IndexedDeck* deck, int index, deckError* result) {
+	if (deck == NULL || index < 0 || index >= IndexedDeck_size(deck, deck->root)) {
+		if (result) *result = illegalCard;
+		return INVALID_CARD;
+	}
+
+	int* link = &deck->root;
+	for (;;) {
+		IndexedNode* n = &deck->nodes[*link];
+		int leftSize = IndexedDeck_size(deck, n->left);
+		if (index == leftSize) break;
+
+		n->size--; // the removed card is somewhere below
+		if (index < leftSize) {
+			link = &n->left;
+		}
+		else {
+			index -= leftSize + 1;
+			link = &n->right;
+		}
+	}
+
+	int node = *link;
+	PackedCard card = deck->nodes[node].card;
+	*link = IndexedDeck_merge(deck, deck->nodes[node].left, deck->nodes[node].right);
+	IndexedDeck_releaseNode(deck, node);
+
+	if (result) *result = ok;
+	return Card_unpack(card);
+}
+
+int IndexedDeck_count(IndexedDeck* deck) {
+	return deck == NULL ? 0 : IndexedDeck_size(deck, deck->root);
+}
+
+void IndexedDeck_print(IndexedDeck* deck) {
+	int count = IndexedDeck_count(deck);
+	if (count == 0) {
+		CardFormat_printPacked(NULL, 0, formatLong, stdout);
+		return;
+	}
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)count);
+	int* stack = (int*)malloc((size_t)count * sizeof(int));
+	if (cards != NULL && stack != NULL) {
+		IndexedDeck_toArray(deck, cards, stack);
+		CardFormat_printPacked(cards, count, formatLong, stdout);
+	}
+	free(cards);
+	free(stack);
+}
+
+/**
+* Fisher-Yates shuffle: the cards are read out in order, shuffled as an
+* array and the treap is rebuilt in linear time.
+*
+* @return ok, illegalCard if the deck is invalid or empty, noMemory if allocation fails
+*/
+deckError IndexedDeck_shuffleWith(IndexedDeck* deck, Rng* rng) {
+	int count = IndexedDeck_count(deck);
+	if (count == 0) return illegalCard;
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)count);
+	int* stack = (int*)malloc((size_t)count * sizeof(int));
+	if (cards == NULL || stack == NULL) {
+		free(cards);
+		free(stack);
+		return noMemory;
+	}
+
+	IndexedDeck_toArray(deck, cards, stack);
+	for (int i = count - 1; i > 0; i--) {
+		int pos = (int)Rng_bounded(rng, (uint32_t)i + 1);
+		PackedCard temp = cards[i];
+		cards[i] = cards[pos];
+		cards[pos] = temp;
+	}
+	deckError err = IndexedDeck_rebuild(deck, cards, count, stack);
+
+	free(cards);
+	free(stack);
+	return err;
+}
+
+/**
+* Sorts by suit then rank with a counting sort over the 52 packed values.
+*
+* @return ok, or noMemory if allocation fails
+*/
+deckError IndexedDeck_sort(IndexedDeck* deck) {
+	int count = IndexedDeck_count(deck);
+	if (count == 0) return ok;
+
+	PackedCard* cards = (PackedCard*)malloc((size_t)count);
+	int* stack = (int*)malloc((size_t)count * sizeof(int));
+	if (cards == NULL || stack == NULL) {
+		free(cards);
+		free(stack);
+		return noMemory;
+	}
+
+	IndexedDeck_toArray(deck, cards, stack);
+	int counts[PACK_SIZE] = { 0 };
+	for (int i = 0; i < count; i++) {
+		counts[cards[i]]++;
+	}
+	int written = 0;
+	for (int value = 0; value < PACK_SIZE; value++) {
+		for (int c = 0; c < counts[value]; c++) {
+			cards[written++] = (PackedCard)value;
+		}
+	}
+	deckError err = IndexedDeck_rebuild(deck, cards, count, stack);
+
+	free(cards);
+	free(stack);
+	return err;
+}
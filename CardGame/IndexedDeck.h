@@ -0,0 +1,61 @@
+/**
+ * @file IndexedDeck.h
+ * Provides interface for the order-statistic indexed deck.
+ *
+ * An IndexedDeck holds a sequence of cards as an implicit treap: a
+ * randomized balanced binary tree ordered by position, where every node
+ * knows the size of its subtree. Looking at, removing and inserting a card
+ * by position are all O(log n) expected, instead of the O(index) walks of
+ * CardDeck_cardNodeAt/CardDeck_removeAt. The top card is position 0.
+ *
+ * Nodes live in one growable array and are addressed by index, so a deck
+ * needs O(log n) reallocations in total rather than one malloc per card.
+ * Like ChunkDeck, cards are returned by value and errors return
+ * INVALID_CARD together with illegalCard.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef INDEXEDDECK_H
+#define INDEXEDDECK_H
+
+#include <stdint.h>
+#include "Card.h"
+#include "CardDeck.h"
+#include "Rng.h"
+
+typedef struct {
+	int left; // left child (earlier cards), -1 for none
+	int right; // right child (later cards), -1 for none
+	int size; // number of cards in this subtree
+	uint32_t priority; // heap priority, a parent's is never lower than its children's
+	PackedCard card; // the card at this node
+} IndexedNode;
+
+typedef struct {
+	IndexedNode* nodes; // node storage, children refer to it by index
+	int capacity; // allocated length of nodes
+	int used; // nodes ever handed out from the end of the array
+	int freeNodes; // released nodes chained through left, -1 for none
+	int root; // root node, -1 when the deck is empty
+	uint32_t seed; // xorshift state for node priorities
+} IndexedDeck;
+
+IndexedDeck* IndexedDeck_create(void);
+void IndexedDeck_delete(IndexedDeck* deck);
+deckError IndexedDeck_fillDeck(IndexedDeck* deck, int numPacks);
+
+Card IndexedDeck_seeTop(IndexedDeck* deck, deckError* result);
+deckError IndexedDeck_insertToTop(IndexedDeck* deck, Card card);
+Card IndexedDeck_useTop(IndexedDeck* deck, deckError* result);
+
+Card IndexedDeck_cardAt(IndexedDeck* deck, int index, deckError* result);
+deckError IndexedDeck_insertAt(IndexedDeck* deck, int index, Card card);
+Card IndexedDeck_removeAt(IndexedDeck* deck, int index, deckError* result);
+int IndexedDeck_count(IndexedDeck* deck);
+void IndexedDeck_print(IndexedDeck* deck);
+
+deckError IndexedDeck_shuffleWith(IndexedDeck* deck, Rng* rng);
+deckError IndexedDeck_sort(IndexedDeck* deck);
+
+#endif
@@ -0,0 +1,147 @@
+/**
+* @file Instrument.c
+* Provides implementation of the optional instrumentation layer:
+* per-thread counter blocks, tick source and the exit report.
+*
+* Each thread gets its own block of counters so that the hot-path
+* increments never contend. Blocks are pushed onto a global list on
+* first use and are never freed, so the report still sees threads
+* that have already exited.
+*
+* @date 19.10.2026
+*/
+
+#include "Instrument.h"
+
+#ifdef CARDGAME_INSTRUMENT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define INSTRUMENT_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define INSTRUMENT_RDTSC 1
+#endif
+
+#ifdef _MSC_VER
+#define INSTRUMENT_THREAD_LOCAL __declspec(thread)
+#else
+#define INSTRUMENT_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct InstrumentBlock {
+	InstrumentCounter counters[INSTR_COUNT];
+	struct InstrumentBlock* next; // next registered block (another thread)
+} InstrumentBlock;
+
+static const char* instrumentNames[INSTR_COUNT] = {
+#define INSTRUMENT_NAME(fn) #fn,
+	INSTRUMENT_FUNCTIONS(INSTRUMENT_NAME)
+#undef INSTRUMENT_NAME
+};
+
+static _Atomic(InstrumentBlock*) instrumentBlocks = NULL; // every thread's block
+static atomic_flag instrumentReportRegistered = ATOMIC_FLAG_INIT;
+static INSTRUMENT_THREAD_LOCAL InstrumentBlock* instrumentLocal = NULL;
+
+// used when a thread's block cannot be allocated, so callers never see NULL
+static InstrumentCounter instrumentFallback[INSTR_COUNT];
+
+/**
+* Returns the calling thread's counters, registering a new block
+* (and the exit report) the first time a thread is instrumented.
+*/
+InstrumentCounter* Instrument_local(void) {
+	if (instrumentLocal != NULL) return instrumentLocal->counters;
+
+	InstrumentBlock* block = (InstrumentBlock*)calloc(1, sizeof(InstrumentBlock));
+	if (block == NULL) return instrumentFallback;
+
+	// push onto the global list; blocks are only ever added
+	block->next = atomic_load(&instrumentBlocks);
+	while (!atomic_compare_exchange_weak(&instrumentBlocks, &block->next, block)) {
+	}
+	instrumentLocal = block;
+
+	if (!atomic_flag_test_and_set(&instrumentReportRegistered)) {
+		atexit(Instrument_report);
+	}
+	return block->counters;
+}
+
+/**
+* Reads the tick source: the time stamp counter on x86,
+* otherwise a nanosecond clock.
+*/
+uint64_t Instrument_now(void) {
+#ifdef INSTRUMENT_RDTSC
+	return (uint64_t)__rdtsc();
+#else
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+* Cleanup handler of INSTR_FUNC: adds the ticks of the scope
+* that is being left to its function's counter.
+*
+* @param scope The scope that is being left
+*/
+void Instrument_endScope(InstrumentScope* scope) {
+	Instrument_local()[scope->func].ticks += Instrument_now() - scope->start;
+}
+
+/**
+* Sums the counters of every thread and prints one line per function
+* that was called at least once. Registered with atexit automatically.
+*/
+void Instrument_report(void) {
+	InstrumentCounter total[INSTR_COUNT] = { 0 };
+	uint64_t allTicks = 0;
+
+	for (InstrumentBlock* block = atomic_load(&instrumentBlocks); block != NULL; block = block->next) {
+		for (int f = 0; f < INSTR_COUNT; f++) {
+			total[f].calls += block->counters[f].calls;
+			total[f].nodes += block->counters[f].nodes;
+			total[f].allocs += block->counters[f].allocs;
+			total[f].frees += block->counters[f].frees;
+			total[f].ticks += block->counters[f].ticks;
+		}
+	}
+	for (int f = 0; f < INSTR_COUNT; f++) {
+		if (total[f].ticks > allTicks) allTicks = total[f].ticks; // outermost function = 100%
+	}
+
+#ifdef INSTRUMENT_RDTSC
+	const char* unit = "cycles";
+#else
+	const char* unit = "ns";
+#endif
+	fprintf(stderr, "\n--- CardGame instrumentation (ticks in %s, inclusive) ---\n", unit);
+	fprintf(stderr, "%-24s %12s %14s %10s %10s %10s %16s %12s %7s\n",
+		"function", "calls", "nodes", "nodes/call", "allocs", "frees", "ticks", "ticks/call", "%max");
+	for (int f = 0; f < INSTR_COUNT; f++) {
+		InstrumentCounter* c = &total[f];
+		if (c->calls == 0) continue; // skip functions that never ran
+
+		fprintf(stderr, "%-24s %12llu %14llu %10.1f %10llu %10llu %16llu %12.1f %6.1f%%\n",
+			instrumentNames[f],
+			(unsigned long long)c->calls,
+			(unsigned long long)c->nodes,
+			(double)c->nodes / (double)c->calls,
+			(unsigned long long)c->allocs,
+			(unsigned long long)c->frees,
+			(unsigned long long)c->ticks,
+			(double)c->ticks / (double)c->calls,
+			allTicks ? 100.0 * (double)c->ticks / (double)allTicks : 0.0);
+	}
+}
+
+#endif
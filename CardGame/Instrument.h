@@ -0,0 +1,99 @@
+/**
+ * @file Instrument.h
+ * Provides optional hot-path instrumentation for the deck and game
+ * operations: per-function call counts, nodes traversed, node
+ * allocations/frees and elapsed ticks.
+ *
+ * Instrumentation is only compiled in when CARDGAME_INSTRUMENT is
+ * defined. Otherwise every macro below expands to nothing, so the
+ * instrumented functions are identical to an uninstrumented build.
+ *
+ * When enabled, a per-function report is written to stderr at exit.
+ * Ticks are read with rdtsc on x86 and timespec_get (nanoseconds)
+ * everywhere else. Ticks are inclusive: CardDeck_shuffle also counts
+ * the time spent in the CardDeck_count and getCardNodeAt calls it makes.
+ * Scope timing needs the cleanup attribute (GCC/Clang); other compilers
+ * still get calls, nodes and allocations.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// every instrumented function, in report order
+#define INSTRUMENT_FUNCTIONS(X) \
+	X(CardDeck_create) \
+	X(CardDeck_fillDeck) \
+	X(CardDeck_insertAfter) \
+	X(CardDeck_deleteNext) \
+	X(CardDeck_delete) \
+	X(CardDeck_gotoTop) \
+	X(CardDeck_gotoNextCard) \
+	X(CardDeck_seeTop) \
+	X(CardDeck_createOrdered) \
+	X(CardDeck_insertToTop) \
+	X(CardDeck_useTop) \
+	X(CardDeck_cardNodeAt) \
+	X(CardDeck_removeAt) \
+	X(removeCardAt) \
+	X(getCardNodeAt) \
+	X(CardDeck_count) \
+	X(CardDeck_print) \
+	X(CardDeck_shuffle) \
+	X(CardDeck_sort) \
+	X(CardDeck_recycleHidden) \
+	X(CardDeck_findMatch) \
+	X(Game_playTurn)
+
+#ifdef CARDGAME_INSTRUMENT
+
+#include <stdint.h>
+
+typedef enum {
+#define INSTRUMENT_ENUM(fn) INSTR_##fn,
+	INSTRUMENT_FUNCTIONS(INSTRUMENT_ENUM)
+#undef INSTRUMENT_ENUM
+	INSTR_COUNT
+} InstrumentFunc;
+
+typedef struct {
+	uint64_t calls; // number of times the function was entered
+	uint64_t nodes; // nodes walked over by the function's loops
+	uint64_t allocs; // nodes/cards allocated by the function
+	uint64_t frees; // nodes/cards freed by the function
+	uint64_t ticks; // inclusive ticks spent inside the function
+} InstrumentCounter;
+
+typedef struct {
+	InstrumentFunc func; // function whose ticks are accumulated
+	uint64_t start; // tick value on entry
+} InstrumentScope;
+
+InstrumentCounter* Instrument_local(void);
+uint64_t Instrument_now(void);
+void Instrument_endScope(InstrumentScope* scope);
+void Instrument_report(void);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define INSTR_FUNC(fn) \
+	Instrument_local()[INSTR_##fn].calls++; \
+	InstrumentScope instrScope_ __attribute__((cleanup(Instrument_endScope))) = { INSTR_##fn, Instrument_now() }
+#else
+#define INSTR_FUNC(fn) Instrument_local()[INSTR_##fn].calls++
+#endif
+
+#define INSTR_NODE(fn) (Instrument_local()[INSTR_##fn].nodes++)
+#define INSTR_ALLOC(fn) (Instrument_local()[INSTR_##fn].allocs++)
+#define INSTR_FREE(fn) (Instrument_local()[INSTR_##fn].frees++)
+
+#else
+
+#define INSTR_FUNC(fn)
+#define INSTR_NODE(fn) ((void)0)
+#define INSTR_ALLOC(fn) ((void)0)
+#define INSTR_FREE(fn) ((void)0)
+
+#endif
+
+#endif
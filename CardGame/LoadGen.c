@@ -0,0 +1,363 @@
+/**
+* @file LoadGen.c
+* Implementation of the load generator of the game server.
+*
+* @date 19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "LoadGen.h"
+#include "bench.h"
+#include "GameServer.h"
+#include "Trace.h"
+
+#ifdef __linux__
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <threads.h>
+#include <unistd.h>
+#include "Card.h"
+#include "game.h"
+
+#define LOADGEN_MAX_GAME_TURNS 1000 // a game that has not been won after this many turns is dealt again
+#define LOADGEN_CONNECT_TRIES 200 // connection attempts 10 ms apart, the server may still be starting
+#define LOADGEN_READ_BUFFER 65536 // response bytes read at once
+#define LOADGEN_WINDOW 64 // requests a connection has in flight at most, their answers fit into the socket buffers
+
+typedef struct {
+	uint16_t id; // table id on the server, SERVER_NEW_TABLE until the deal is answered
+	uint8_t op; // ServerOp of the request in flight
+	int gameTurns; // turns of the current game
+	double sent; // when the request in flight was written
+	ServerResponse state; // last answer
+	PackedCard hand[SERVER_MAX_HAND]; // hand of the player to move from the last answer
+} LoadGenTable;
+
+typedef struct {
+	int fd; // the connection
+	int start; // first unread byte in buffer
+	int length; // bytes in buffer
+	unsigned char buffer[LOADGEN_READ_BUFFER];
+} LoadGenReader;
+
+typedef struct {
+	const char* address; // server address
+	int numTables; // tables of this connection
+	long long numTurns; // turns this connection plays
+	LoadGenTable* tables;
+	ServerRequest* requests; // one batch
+	float* latencies; // turn latencies in microseconds
+	long long turns; // turns answered, also the number of latencies
+	long long games; // games won
+	long long errors; // replies other than replyOk
+	int failed; // the connection broke
+	int started; // runs on its own thread
+	LoadGenReader reader;
+} LoadGenWorker;
+
+/**
+* Writes all of buffer.
+*
+* @return 0, or -1 if the connection failed
+*/
+static int LoadGen_write(int fd, const void* buffer, size_t length) {
+	const unsigned char* bytes = (const unsigned char*)buffer;
+	while (length > 0) {
+		ssize_t written = write(fd, bytes, length);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		bytes += written;
+		length -= (size_t)written;
+	}
+	return 0;
+}
+
+/**
+* Reads exactly length bytes through the reader's buffer.
+*
+* @return 0, or -1 if the connection failed or closed
+*/
+static int LoadGen_read(LoadGenReader* reader, void* buffer, int length) {
+	unsigned char* bytes = (unsigned char*)buffer;
+	while (length > 0) {
+		if (reader->start == reader->length) {
+			ssize_t got = read(reader->fd, reader->buffer, LOADGEN_READ_BUFFER);
+			if (got < 0 && errno == EINTR) continue;
+			if (got <= 0) return -1;
+			reader->start = 0;
+			reader->length = (int)got;
+		}
+		int chunk = reader->length - reader->start < length ? reader->length - reader->start : length;
+		memcpy(bytes, reader->buffer + reader->start, (size_t)chunk);
+		reader->start += chunk;
+		bytes += chunk;
+		length -= chunk;
+	}
+	return 0;
+}
+
+/**
+* Connects to the server, retrying while it starts up.
+*
+* @return the socket, -1 if the server never answered
+*/
+static int LoadGen_connect(const char* address) {
+	for (int attempt = 0; attempt < LOADGEN_CONNECT_TRIES; attempt++) {
+		int fd = GameServer_connect(address);
+		if (fd >= 0) return fd;
+		thrd_sleep(&(struct timespec){ .tv_sec = 0, .tv_nsec = 10000000 }, NULL);
+	}
+	return -1;
+}
+
+/**
+* Picks the next request of a table from the last answer it got.
+*/
+static void LoadGen_nextRequest(LoadGenTable* table, ServerRequest* request, int tableIndex) {
+	request->seq = (uint32_t)tableIndex;
+	request->table = table->id;
+	request->index = 0;
+
+	if (table->id == SERVER_NEW_TABLE || table->state.status == win || table->gameTurns >= LOADGEN_MAX_GAME_TURNS) {
+		request->op = serverDeal;
+		table->gameTurns = 0;
+	}
+	else {
+		// the first card matching the suit or the rank of the top card, like CardDeck_findMatch
+		Card top = Card_unpack(table->state.top);
+		request->op = serverDraw;
+		for (int i = 0; i < table->state.handCount; i++) {
+			Card card = Card_unpack(table->hand[i]);
+			if (card.suit == top.suit || card.rank == top.rank) {
+				request->op = serverPlay;
+				request->index = (uint8_t)i;
+				break;
+			}
+		}
+	}
+	table->op = request->op;
+}
+
+/**
+* Sends one request for every table of a worker and reads every answer.
+*
+* @return 0, or -1 if the connection failed or the server refused every request
+*/
+static int LoadGen_batch(LoadGenWorker* worker, int closing) {
+	int count = 0;
+	for (int t = 0; t < worker->numTables; t++) {
+		ServerRequest* request = &worker->requests[count];
+		if (!closing) {
+			LoadGen_nextRequest(&worker->tables[t], request, t);
+			count++;
+		}
+		else if (worker->tables[t].id != SERVER_NEW_TABLE) {
+			*request = (ServerRequest){ serverClose, 0, worker->tables[t].id, (uint32_t)t };
+			worker->tables[t].op = serverClose;
+			count++;
+		}
+	}
+
+	// Writing the whole batch before reading could fill both socket buffers, the
+	// server then blocks writing answers and this connection writing requests.
+	// So at most LOADGEN_WINDOW requests are in flight, topped up when half are answered.
+	int written = 0;
+	int answered = 0;
+	for (int r = 0; r < count; r++) {
+		if (written < count && written - r <= LOADGEN_WINDOW / 2) {
+			int chunk = count - written < LOADGEN_WINDOW - (written - r) ? count - written : LOADGEN_WINDOW - (written - r);
+			double sent = Bench_seconds();
+			for (int i = written; i < written + chunk; i++) {
+				worker->tables[worker->requests[i].seq].sent = sent;
+			}
+			if (LoadGen_write(worker->reader.fd, worker->requests + written, (size_t)chunk * sizeof(ServerRequest)) != 0) {
+				return -1;
+			}
+			written += chunk;
+		}
+
+		ServerResponse response;
+		if (LoadGen_read(&worker->reader, &response, (int)sizeof(response)) != 0 || response.seq >= (uint32_t)worker->numTables) {
+			return -1;
+		}
+		LoadGenTable* table = &worker->tables[response.seq];
+		if (LoadGen_read(&worker->reader, table->hand, response.handCount) != 0) return -1;
+		double latency = Bench_seconds() - table->sent;
+
+		if (response.reply != replyOk) {
+			worker->errors++;
+			if (table->op == serverDeal) table->id = SERVER_NEW_TABLE; // try again with a new table
+			continue;
+		}
+		answered++;
+		table->state = response;
+		if (table->op == serverDeal) {
+			table->id = response.table;
+		}
+		else if (table->op == serverPlay || table->op == serverDraw) {
+			worker->latencies[worker->turns++] = (float)(latency * 1e6);
+			table->gameTurns++;
+			if (response.status == win) worker->games++;
+		}
+	}
+	return answered > 0 || count == 0 ? 0 : -1;
+}
+
+/**
+* Plays the tables of one connection until it has played its turns.
+*/
+static int LoadGen_worker(void* arg) {
+	LoadGenWorker* worker = (LoadGenWorker*)arg;
+	worker->reader.fd = LoadGen_connect(worker->address);
+	worker->reader.start = worker->reader.length = 0;
+	if (worker->reader.fd < 0) {
+		worker->failed = 1;
+		return 0;
+	}
+
+	for (int t = 0; t < worker->numTables; t++) {
+		worker->tables[t].id = SERVER_NEW_TABLE;
+		worker->tables[t].gameTurns = 0;
+	}
+	// every batch answers at most one turn per table, so the last one may not fill up numTurns exactly
+	while (!worker->failed && worker->turns + worker->numTables <= worker->numTurns) {
+		worker->failed = LoadGen_batch(worker, 0) != 0;
+	}
+	if (!worker->failed) {
+		worker->failed = LoadGen_batch(worker, 1) != 0;
+	}
+	close(worker->reader.fd);
+	return 0;
+}
+
+static int LoadGen_compareFloat(const void* a, const void* b) {
+	float x = *(const float*)a;
+	float y = *(const float*)b;
+	return (x > y) - (x < y);
+}
+
+/**
+* Runs a worker on a thread of its own, named in traces.
+*/
+static int LoadGen_workerThread(void* arg) {
+	TRACE_THREAD_NAME("loadgen connection");
+	TRACE_SCOPE(LoadGen_workerThread);
+	return LoadGen_worker(arg);
+}
+
+/**
+* @brief Plays tables on a game server and measures throughput and latency
+*
+* @param address Unix socket path or TCP port of the server, see GameServer.h
+* @param numTables Tables played at once, spread over the connections
+* @param numConnections Connections, each on its own thread, clamped to 1..numTables
+* @param numTurns Turns to play in total
+* @param result Receives the measurements
+* @return EXIT_SUCCESS, or EXIT_FAILURE if a connection failed or memory ran out
+*/
+int LoadGen_run(const char* address, int numTables, int numConnections, long long numTurns, LoadGenResult* result) {
+	memset(result, 0, sizeof(*result));
+	if (numTables <= 0 || numTurns <= 0) return EXIT_FAILURE;
+	if (numConnections > numTables) numConnections = numTables;
+	if (numConnections < 1) numConnections = 1;
+
+	LoadGenWorker* workers = (LoadGenWorker*)calloc((size_t)numConnections, sizeof(LoadGenWorker));
+	thrd_t* threads = (thrd_t*)malloc((size_t)numConnections * sizeof(thrd_t));
+	int succeeded = workers != NULL && threads != NULL;
+	for (int c = 0; succeeded && c < numConnections; c++) {
+		LoadGenWorker* worker = &workers[c];
+		worker->address = address;
+		worker->numTables = (int)((long long)numTables * (c + 1) / numConnections - (long long)numTables * c / numConnections);
+		worker->numTurns = numTurns * (c + 1) / numConnections - numTurns * c / numConnections;
+		if (worker->numTurns < worker->numTables) worker->numTurns = worker->numTables; // at least one turn per table
+		worker->tables = (LoadGenTable*)malloc((size_t)worker->numTables * sizeof(LoadGenTable));
+		worker->requests = (ServerRequest*)malloc((size_t)worker->numTables * sizeof(ServerRequest));
+		worker->latencies = (float*)malloc((size_t)worker->numTurns * sizeof(float));
+		succeeded = worker->tables != NULL && worker->requests != NULL && worker->latencies != NULL;
+	}
+
+	float* latencies = NULL;
+	if (succeeded) {
+		double start = Bench_seconds();
+		for (int c = 0; c < numConnections; c++) {
+			workers[c].started = thrd_create(&threads[c], LoadGen_workerThread, &workers[c]) == thrd_success;
+			if (!workers[c].started) LoadGen_worker(&workers[c]);
+		}
+		for (int c = 0; c < numConnections; c++) {
+			if (workers[c].started) thrd_join(threads[c], NULL);
+		}
+		result->seconds = Bench_seconds() - start;
+
+		for (int c = 0; c < numConnections; c++) {
+			result->turns += workers[c].turns;
+			result->games += workers[c].games;
+			result->errors += workers[c].errors;
+			succeeded &= !workers[c].failed;
+		}
+		latencies = (float*)malloc((size_t)(result->turns > 0 ? result->turns : 1) * sizeof(float));
+	}
+
+	if (latencies != NULL) {
+		long long count = 0;
+		for (int c = 0; c < numConnections; c++) {
+			memcpy(latencies + count, workers[c].latencies, (size_t)workers[c].turns * sizeof(float));
+			count += workers[c].turns;
+		}
+		if (count > 0) {
+			qsort(latencies, (size_t)count, sizeof(float), LoadGen_compareFloat);
+			result->p50 = latencies[count / 2];
+			result->p99 = latencies[count * 99 / 100];
+		}
+		free(latencies);
+	}
+	else {
+		succeeded = 0;
+	}
+
+	for (int c = 0; workers != NULL && c < numConnections; c++) {
+		free(workers[c].tables);
+		free(workers[c].requests);
+		free(workers[c].latencies);
+	}
+	free(workers);
+	free(threads);
+	return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+* @brief Asks a game server to stop
+*
+* @param address Unix socket path or TCP port of the server, see GameServer.h
+* @return EXIT_SUCCESS, or EXIT_FAILURE if the server could not be reached
+*/
+int LoadGen_shutdown(const char* address) {
+	int fd = LoadGen_connect(address);
+	if (fd < 0) return EXIT_FAILURE;
+	ServerRequest request = { serverShutdown, 0, 0, 0 };
+	ServerResponse response;
+	LoadGenReader reader;
+	reader.fd = fd;
+	reader.start = reader.length = 0;
+	int failed = LoadGen_write(fd, &request, sizeof(request)) != 0 ||
+		LoadGen_read(&reader, &response, (int)sizeof(response)) != 0;
+	close(fd);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#else
+
+int LoadGen_run(const char* address, int numTables, int numConnections, long long numTurns, LoadGenResult* result) {
+	fprintf(stderr, "loadgen: only available on Linux\n");
+	return EXIT_FAILURE;
+}
+
+int LoadGen_shutdown(const char* address) {
+	return EXIT_FAILURE;
+}
+
+#endif
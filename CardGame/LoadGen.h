@@ -0,0 +1,36 @@
+/**
+ * @file LoadGen.h
+ * Provides interface for the load generator of the game server.
+ *
+ * The load generator opens numConnections connections, each on its own
+ * thread, and plays numTables tables spread over them. Each connection
+ * sends one request for every one of its tables per round and reads the
+ * answers while it sends. It keeps up to 64 requests in flight, written a
+ * few at a time, so the server has work queued but neither side can block
+ * on a full socket buffer while the other waits for it. A table plays the
+ * first matching card of the hand the server sent, or draws, and deals
+ * again when its game is won or runs too long.
+ *
+ * The turn latency is the time from writing a request to reading its
+ * answer, so it includes the time spent queued behind the other requests
+ * in flight.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+typedef struct {
+	long long turns; // play and draw requests answered
+	long long games; // games played until somebody won
+	long long errors; // requests answered with anything but replyOk
+	double seconds; // wall time of the run
+	double p50; // median turn latency in microseconds
+	double p99; // 99th percentile turn latency in microseconds
+} LoadGenResult;
+
+int LoadGen_run(const char* address, int numTables, int numConnections, long long numTurns, LoadGenResult* result);
+int LoadGen_shutdown(const char* address);
+
+#endif
@@ -0,0 +1,116 @@
+/**
+* @file PlayedPile.c
+* Implementation of the played pile.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include "PlayedPile.h"
+
+/**
+* @brief Sets up an empty played pile
+* @details Even if this fails, the pile can be given to PlayedPile_destroy.
+*
+* @param pile The pile to set up
+* @return ok, or noMemory if allocation fails
+*/
+deckError PlayedPile_init(PlayedPile* pile) {
+	pile->cards = (PackedCard*)malloc(PLAYEDPILE_INITIAL);
+	pile->top = 0;
+	pile->count = 0;
+	pile->capacity = pile->cards != NULL ? PLAYEDPILE_INITIAL : 0;
+	pile->spareCount = 0;
+	pile->tally = 0;
+	pile->spare.head = NULL;
+	deckError err = CardDeck_init(&pile->spare);
+	return pile->cards == NULL ? noMemory : err;
+}
+
+/**
+* @brief Frees the buffer of a played pile, the PlayedPile itself belongs to the caller
+*
+* @param pile The pile, may have failed PlayedPile_init
+*/
+void PlayedPile_destroy(PlayedPile* pile) {
+	free(pile->cards);
+	pile->cards = NULL;
+	pile->count = pile->capacity = 0;
+	CardDeck_destroy(&pile->spare);
+	pile->spareCount = 0;
+	pile->tally = 0;
+}
+
+/**
+* @brief Doubles the buffer of a played pile, used by PlayedPile_push
+*
+* @param pile The pile
+* @return ok, or noMemory if allocation fails, the pile is unchanged then
+*/
+deckError PlayedPile_grow(PlayedPile* pile) {
+	int capacity = pile->capacity > 0 ? 2 * pile->capacity : PLAYEDPILE_INITIAL;
+	PackedCard* cards = (PackedCard*)realloc(pile->cards, (size_t)capacity);
+	if (cards == NULL) return noMemory;
+	pile->cards = cards;
+	pile->capacity = capacity;
+	return ok;
+}
+
+/**
+* @brief Puts the card of a node on top of the pile and keeps the node as a spare
+* @details For cards taken out of a hand with CardDeck_unlinkAt, so
+* playing a card neither frees nor allocates anything.
+*
+* @param pile The pile
+* @param node An unlinked node, the pile owns it afterwards
+* @return ok, or noMemory if the buffer cannot grow, the node is kept anyway
+*/
+deckError PlayedPile_pushNode(PlayedPile* pile, CardNode* node) {
+	node->successor = pile->spare.head->successor;
+	pile->spare.head->successor = node;
+	pile->spareCount++;
+	return PlayedPile_push(pile, node->card);
+}
+
+/**
+* @brief Moves every card but the top card to the hidden deck and shuffles it
+* @details The cards go on top of the hidden deck oldest first, which is
+* the order CardDeck_recycleHiddenWith leaves them in. They are written
+* into the spare nodes first, only the rest needs new nodes.
+*
+* @param pile The played pile, only its top card is left
+* @param hidden The hidden deck, it may be empty
+* @param rng Generator for the shuffle of the hidden deck
+* @return ok, illegalCard if hidden is invalid or the pile has no card below the top card, noMemory if allocation fails
+*/
+deckError PlayedPile_recycleInto(PlayedPile* pile, CardDeck* hidden, Rng* rng) {
+	CHECK_DECK_VALID2(hidden);
+	if (pile->count < 2) return illegalCard; // only the top card is left, nothing to recycle
+
+	int recycled = pile->count - 1;
+	int reused = recycled < pile->spareCount ? recycled : pile->spareCount;
+	CardNode* current = hidden->current;
+	hidden->current = hidden->head;
+	deckError err = CardDeck_insertPackedAfter(hidden, pile->cards + reused, recycled - reused);
+	hidden->current = current;
+	if (err != ok) return err;
+
+	// the spare nodes go on top of the cards inserted above, holding the oldest cards
+	CardNode* node = pile->spare.head;
+	for (int i = 0; i < reused; i++) {
+		node = node->successor;
+		node->card = Card_unpack(pile->cards[i]);
+		hidden->tally += cardKeys[pile->cards[i]];
+	}
+	if (reused > 0) {
+		CardNode* first = pile->spare.head->successor;
+		pile->spare.head->successor = node->successor;
+		node->successor = hidden->head->successor;
+		hidden->head->successor = first;
+		pile->spareCount -= reused;
+	}
+
+	pile->count = 1;
+	pile->tally = cardKeys[pile->top];
+	return CardDeck_shuffleWith(hidden, rng);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file PlayedPile.h
+ * Provides interface for the played pile of a game.
+ *
+ * Of the played pile only the top card is ever looked at; the cards below
+ * it are only kept to be shuffled back into the hidden deck once that
+ * runs out. A PlayedPile therefore keeps the top card in the struct
+ * itself, so finding a match reads nothing outside the Game, and the cards
+ * below it as one byte each in an append-only buffer, oldest first.
+ * Playing a card is a byte append, and recycling hands the buffer to the
+ * hidden deck in one bulk insert.
+ *
+ * The node a card was played from is kept on a spare list of the pile
+ * and reused when the cards are recycled. A game thus keeps using its
+ * own nodes, as it did when the played deck was a linked list, instead
+ * of taking nodes other games gave back to the shared node pool.
+ *
+ * Recycling puts the cards into the hidden deck in the same order the old
+ * linked played deck did, so games shuffle exactly as before.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef PLAYEDPILE_H
+#define PLAYEDPILE_H
+
+#include "Card.h"
+#include "CardDeck.h"
+#include "Rng.h"
+
+#define PLAYEDPILE_INITIAL 64 // cards the buffer holds before it first grows
+
+typedef struct {
+	PackedCard top; // top card, only valid if count is not 0
+	PackedCard* cards; // the count - 1 cards below the top card, oldest first
+	int count; // cards on the pile, including the top card
+	int capacity; // cards the buffer holds
+	CardDeck spare; // nodes of played cards, reused by PlayedPile_recycleInto; its tally is not kept
+	int spareCount; // nodes on the spare list
+	uint64_t tally; // sum of Card_key of every card on the pile, like CardDeck's tally
+} PlayedPile;
+
+deckError PlayedPile_init(PlayedPile* pile);
+void PlayedPile_destroy(PlayedPile* pile);
+deckError PlayedPile_grow(PlayedPile* pile);
+deckError PlayedPile_pushNode(PlayedPile* pile, CardNode* node);
+deckError PlayedPile_recycleInto(PlayedPile* pile, CardDeck* hidden, Rng* rng);
+
+/**
+* Puts a card on top of the pile.
+*
+* @return ok, or noMemory if the buffer cannot grow
+*/
+static inline deckError PlayedPile_push(PlayedPile* pile, Card card) {
+	if (pile->count > 0) {
+		if (pile->count - 1 == pile->capacity && PlayedPile_grow(pile) != ok) return noMemory;
+		pile->cards[pile->count - 1] = pile->top;
+	}
+	pile->top = Card_pack(card);
+	pile->count++;
+	pile->tally += cardKeys[pile->top];
+	return ok;
+}
+
+/**
+* Returns the top card, NULL if the pile is empty. The card lives in
+* orderedPack, so the pointer stays valid when the pile changes.
+*/
+static inline const Card* PlayedPile_top(const PlayedPile* pile) {
+	return pile->count == 0 ? NULL : &orderedPack[pile->top];
+}
+
+/**
+* Returns the number of cards on the pile.
+*/
+static inline int PlayedPile_count(const PlayedPile* pile) {
+	return pile->count;
+}
+
+#endif
@@ -0,0 +1,498 @@
+/**
+* @file Regress.c
+* Implementation of the regression tracker.
+*
+* @date 19.10.2026
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Regress.h"
+#include "bench.h"
+#include "CardDeck.h"
+#include "PlayedPile.h"
+#include "Rng.h"
+#include "game.h"
+
+#define REGRESS_SHUFFLE_CARDS 1000000 // cards shuffled per sample of a shuffle kernel
+#define REGRESS_SORT_CARDS 200000 // cards shuffled and sorted per sample
+#define REGRESS_HAND_OPS 200000 // inserts and removals per sample of the hand kernel
+#define REGRESS_PILE_CARDS 500000 // cards played and recycled per sample
+#define REGRESS_GAME_TURNS 500000 // turns per sample of a games kernel, counting every game to its end
+#define REGRESS_MAX_TURNS 1000 // turn limit of every game
+
+volatile uint64_t regressSink; // every checksum ends up here, so no kernel is optimized away
+
+/**
+* Shuffles a deck of numPacks packs until REGRESS_SHUFFLE_CARDS cards are shuffled.
+*/
+static uint64_t Regress_shuffle(int numPacks) {
+	Rng rng;
+	Rng_seed(&rng, 49);
+	CardDeck deck;
+	if (CardDeck_init(&deck) != ok) return 0;
+	CardDeck_fillDeck(&deck, numPacks);
+	for (int r = 0; r < REGRESS_SHUFFLE_CARDS / (numPacks * PACK_SIZE); r++) {
+		CardDeck_shuffleWith(&deck, &rng);
+	}
+	uint64_t sum = deck.head->successor != NULL ? (uint64_t)Card_pack(deck.head->successor->card) : 0;
+	CardDeck_destroy(&deck);
+	return sum;
+}
+
+static uint64_t Regress_shuffle1(void) {
+	return Regress_shuffle(1);
+}
+
+static uint64_t Regress_shuffle8(void) {
+	return Regress_shuffle(8);
+}
+
+/**
+* Shuffles and sorts a deck of 4 packs, REGRESS_SORT_CARDS cards in all.
+*/
+static uint64_t Regress_sort(void) {
+	Rng rng;
+	Rng_seed(&rng, 49);
+	CardDeck deck;
+	if (CardDeck_init(&deck) != ok) return 0;
+	CardDeck_fillDeck(&deck, 4);
+	for (int r = 0; r < REGRESS_SORT_CARDS / (4 * PACK_SIZE); r++) {
+		CardDeck_shuffleWith(&deck, &rng);
+		CardDeck_sort(&deck);
+	}
+	uint64_t sum = deck.head->successor != NULL ? (uint64_t)Card_pack(deck.head->successor->card) : 0;
+	CardDeck_destroy(&deck);
+	return sum;
+}
+
+/**
+* Draws cards into a hand of about 8 cards and plays them from random
+* positions, the way a player's hand changes during a game.
+*/
+static uint64_t Regress_hand(void) {
+	Rng rng;
+	Rng_seed(&rng, 49);
+	CardDeck hand;
+	if (CardDeck_init(&hand) != ok) return 0;
+	uint64_t sum = 0;
+	int count = 0;
+	for (int i = 0; i < REGRESS_HAND_OPS; i++) {
+		if (count < 4 || (count < 12 && Rng_bounded(&rng, 2) == 0)) {
+			count += CardDeck_insertToTop(&hand, orderedPack[i % PACK_SIZE]) == ok;
+		}
+		else {
+			Card* card = CardDeck_removeAt(&hand, (int)Rng_bounded(&rng, (uint32_t)count), NULL);
+			if (card != NULL) {
+				sum += Card_pack(*card);
+				count--;
+			}
+			free(card);
+		}
+	}
+	CardDeck_destroy(&hand);
+	return sum;
+}
+
+/**
+* Plays the cards of 2 packs onto the played pile one at a time, taking
+* each from the top of the hidden deck, then recycles the pile into the
+* hidden deck, until REGRESS_PILE_CARDS cards are played.
+*/
+static uint64_t Regress_pile(void) {
+	Rng rng;
+	Rng_seed(&rng, 49);
+	CardDeck hidden;
+	PlayedPile pile;
+	if (PlayedPile_init(&pile) != ok) return 0;
+	if (CardDeck_init(&hidden) != ok) {
+		PlayedPile_destroy(&pile);
+		return 0;
+	}
+	CardDeck_fillDeck(&hidden, 2);
+	uint64_t sum = 0;
+	for (int played = 0; played < REGRESS_PILE_CARDS;) {
+		CardNode* node;
+		while ((node = CardDeck_unlinkAt(&hidden, 0, NULL)) != NULL) {
+			PlayedPile_pushNode(&pile, node);
+			played++;
+		}
+		PlayedPile_recycleInto(&pile, &hidden, &rng);
+		sum += pile.top;
+	}
+	CardDeck_destroy(&hidden);
+	PlayedPile_destroy(&pile);
+	return sum;
+}
+
+/**
+* Plays games of numPacks packs, each to its end or the turn limit, until
+* REGRESS_GAME_TURNS turns are played.
+*/
+static uint64_t Regress_games(int numPacks) {
+	Rng rng;
+	Rng_seed(&rng, 49);
+	uint64_t sum = 0;
+	for (int turns = 0; turns < REGRESS_GAME_TURNS;) {
+		Game game;
+		if (Game_init(&game, numPacks, &rng) != ok) return sum;
+		for (int t = 0; t < REGRESS_MAX_TURNS && game.status == ongoing; t++) {
+			Game_playTurn(&game);
+			turns++;
+		}
+		sum += (uint64_t)game.turn + (uint64_t)game.recycles;
+		Game_free(&game);
+	}
+	return sum;
+}
+
+static uint64_t Regress_games1(void) {
+	return Regress_games(1);
+}
+
+static uint64_t Regress_games4(void) {
+	return Regress_games(4);
+}
+
+const RegressKernel regressKernels[] = {
+	{ "shuffle-1", Regress_shuffle1 },
+	{ "shuffle-8", Regress_shuffle8 },
+	{ "sort-4", Regress_sort },
+	{ "hand", Regress_hand },
+	{ "pile", Regress_pile },
+	{ "games-1", Regress_games1 },
+	{ "games-4", Regress_games4 },
+};
+
+const int regressKernelCount = (int)(sizeof(regressKernels) / sizeof(regressKernels[0]));
+
+/**
+* @brief Times kernels in rounds, every kernel once per round
+*
+* @param kernels The kernels
+* @param count Number of kernels
+* @param warmup Untimed rounds before the samples
+* @param samples Timed rounds, 1 to REGRESS_MAX_SAMPLES
+* @param results Receives the samples of every kernel and their summary
+* @return 0, or -1 if samples is out of range
+*/
+int Regress_measure(const RegressKernel* kernels, int count, int warmup, int samples, RegressResult* results) {
+	if (samples < 1 || samples > REGRESS_MAX_SAMPLES) return -1;
+	for (int round = 0; round < warmup; round++) {
+		for (int k = 0; k < count; k++) {
+			regressSink += kernels[k].run();
+		}
+	}
+	for (int round = 0; round < samples; round++) {
+		for (int k = 0; k < count; k++) {
+			double start = Bench_seconds();
+			regressSink += kernels[k].run();
+			results[k].samples[round] = Bench_seconds() - start;
+		}
+	}
+	for (int k = 0; k < count; k++) {
+		snprintf(results[k].name, sizeof(results[k].name), "%s", kernels[k].name);
+		results[k].count = samples;
+		Regress_summarize(&results[k]);
+	}
+	return 0;
+}
+
+static int Regress_compareDoubles(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+/**
+* @brief Sorts the samples of a result and computes their median and its confidence interval
+* @details The interval runs from the r-th to the s-th smallest sample
+* with r = n/2 - 0.98 sqrt(n) rounded down and s = 1 + n/2 + 0.98 sqrt(n)
+* rounded up, which holds the median with about 95% probability whatever
+* the distribution of the samples. With fewer than 6 samples it is the
+* whole range.
+*
+* @param result The result, count and samples set
+*/
+void Regress_summarize(RegressResult* result) {
+	int n = result->count;
+	if (n < 1) {
+		result->median = result->low = result->high = 0.0;
+		return;
+	}
+	qsort(result->samples, (size_t)n, sizeof(double), Regress_compareDoubles);
+	result->median = n % 2 == 1 ? result->samples[n / 2] : (result->samples[n / 2 - 1] + result->samples[n / 2]) / 2.0;
+	double spread = 0.98 * sqrt((double)n);
+	int r = (int)floor(n / 2.0 - spread);
+	int s = (int)ceil(1.0 + n / 2.0 + spread);
+	result->low = result->samples[r < 1 ? 0 : r - 1];
+	result->high = result->samples[s > n ? n - 1 : s - 1];
+}
+
+/**
+* @brief Pools runs of a kernel into one result
+* @details Whole runs are taken in order while their samples fit into
+* REGRESS_MAX_SAMPLES. The median of the pooled samples stands for the
+* runs, and comparing the pooled samples with a baseline tests all runs
+* at once.
+*
+* @param runs The runs, all of one kernel
+* @param numRuns Number of runs, at least 1
+* @param pooled Receives the samples of the runs, summarized
+*/
+void Regress_pool(const RegressResult* runs, int numRuns, RegressResult* pooled) {
+	snprintf(pooled->name, sizeof(pooled->name), "%s", runs[0].name);
+	pooled->count = 0;
+	for (int r = 0; r < numRuns && pooled->count + runs[r].count <= REGRESS_MAX_SAMPLES; r++) {
+		memcpy(pooled->samples + pooled->count, runs[r].samples, (size_t)runs[r].count * sizeof(double));
+		pooled->count += runs[r].count;
+	}
+	Regress_summarize(pooled);
+}
+
+/**
+* @brief Compares a result with the baseline runs of its kernel
+* @details The Mann-Whitney U statistic counts the pairs of a current and
+* a baseline sample in which the current one is slower, ties counting
+* half. Without a change it is about half the pairs; p comes from its
+* normal approximation with continuity correction, which is close enough
+* from about 8 samples on each side. The spread of the runs is the
+* standard deviation of the logarithms of their medians, widened by
+* sqrt(1 + 1/runs) because their mean is only estimated too.
+*
+* @param runs The baseline runs of the kernel
+* @param numRuns Number of runs, 0 if the baseline has none
+* @param current The result of this run
+* @param comparison Receives the verdict
+*/
+void Regress_compare(const RegressResult* runs, int numRuns, const RegressResult* current, RegressComparison* comparison) {
+	comparison->verdict = regressNew;
+	comparison->change = 0.0;
+	comparison->p = 1.0;
+	comparison->noise = REGRESS_MIN_CHANGE;
+	if (numRuns < 1 || current->count < 1) return;
+
+	double n1 = current->count;
+	double n2 = 0.0;
+	double slower = 0.0; // U of the current samples
+	double logs[REGRESS_MAX_SAMPLES];
+	double mean = 0.0;
+	int used = numRuns < REGRESS_MAX_SAMPLES ? numRuns : REGRESS_MAX_SAMPLES;
+	for (int r = 0; r < used; r++) {
+		for (int i = 0; i < current->count; i++) {
+			for (int j = 0; j < runs[r].count; j++) {
+				if (current->samples[i] > runs[r].samples[j]) slower += 1.0;
+				else if (current->samples[i] == runs[r].samples[j]) slower += 0.5;
+			}
+		}
+		n2 += runs[r].count;
+		logs[r] = log(runs[r].median > 0.0 ? runs[r].median : 1e-12);
+		mean += logs[r] / used;
+	}
+	double expected = n1 * n2 / 2.0;
+	double z = (fabs(slower - expected) - 0.5) / sqrt(n1 * n2 * (n1 + n2 + 1.0) / 12.0);
+	comparison->p = z > 0.0 ? 0.5 * erfc(z / sqrt(2.0)) : 0.5;
+
+	double variance = 0.0;
+	for (int r = 0; r < used; r++) {
+		variance += (logs[r] - mean) * (logs[r] - mean);
+	}
+	qsort(logs, (size_t)used, sizeof(double), Regress_compareDoubles);
+	double center = used % 2 == 1 ? logs[used / 2] : (logs[used / 2 - 1] + logs[used / 2]) / 2.0;
+	double change = log(current->median > 0.0 ? current->median : 1e-12) - center;
+	double noise = log(1.0 + REGRESS_MIN_CHANGE);
+	if (used > 1) {
+		double spread = REGRESS_RUN_SIGMAS * sqrt(variance / (used - 1) * (1.0 + 1.0 / used));
+		if (spread > noise) noise = spread;
+	}
+	comparison->change = exp(change) - 1.0;
+	comparison->noise = exp(noise) - 1.0;
+
+	comparison->verdict = regressSame;
+	if (comparison->p < REGRESS_ALPHA) {
+		if (slower > expected && change >= noise) comparison->verdict = regressSlower;
+		if (slower < expected && change <= -noise) comparison->verdict = regressFaster;
+	}
+}
+
+/**
+* @brief Adds a run to a baseline file
+*
+* @param path The file, created if it does not exist
+* @param results The results of the run
+* @param count Number of results
+* @return 0, or -1 if the file cannot be written
+*/
+int Regress_append(const char* path, const RegressResult* results, int count) {
+	FILE* in = fopen(path, "r");
+	int exists = in != NULL;
+	if (in != NULL) fclose(in);
+	FILE* out = fopen(path, "a");
+	if (out == NULL) return -1;
+	if (!exists) fprintf(out, "%s\n", REGRESS_HEADER);
+	for (int k = 0; k < count; k++) {
+		fprintf(out, "%s %d", results[k].name, results[k].count);
+		for (int i = 0; i < results[k].count; i++) {
+			fprintf(out, " %.9e", results[k].samples[i]);
+		}
+		fprintf(out, "\n");
+	}
+	int failed = ferror(out);
+	failed |= fclose(out) != 0;
+	return failed ? -1 : 0;
+}
+
+/**
+* @brief Reads a baseline file
+*
+* @param path The file
+* @param count Receives the number of results
+* @return The results of all runs in the order they were added, summarized,
+* free them with free(); NULL if the file cannot be read or is not a
+* baseline file
+*/
+RegressResult* Regress_load(const char* path, int* count) {
+	*count = 0;
+	FILE* in = fopen(path, "r");
+	if (in == NULL) return NULL;
+
+	char line[64];
+	RegressResult* results = NULL;
+	int capacity = 0;
+	int failed = fgets(line, sizeof(line), in) == NULL || strncmp(line, REGRESS_HEADER, strlen(REGRESS_HEADER)) != 0;
+	RegressResult result;
+	while (!failed && fscanf(in, "%31s %d", result.name, &result.count) == 2) {
+		failed = result.count < 1 || result.count > REGRESS_MAX_SAMPLES;
+		for (int i = 0; i < result.count && !failed; i++) {
+			failed = fscanf(in, "%lf", &result.samples[i]) != 1;
+		}
+		if (!failed && *count == capacity) {
+			capacity = capacity == 0 ? 16 : capacity * 2;
+			RegressResult* grown = (RegressResult*)realloc(results, (size_t)capacity * sizeof(RegressResult));
+			failed = grown == NULL;
+			if (grown != NULL) results = grown;
+		}
+		if (!failed) {
+			Regress_summarize(&result);
+			results[(*count)++] = result;
+		}
+	}
+	failed |= !feof(in);
+	fclose(in);
+	if (failed || *count == 0) {
+		free(results);
+		*count = 0;
+		return NULL;
+	}
+	return results;
+}
+
+/**
+* Collects the runs of a kernel from the results of a baseline file.
+*
+* @return Number of runs copied to runs
+*/
+static int Regress_runsOf(const char* name, const RegressResult* results, int count, RegressResult* runs) {
+	int numRuns = 0;
+	for (int i = 0; i < count; i++) {
+		if (strcmp(results[i].name, name) == 0) runs[numRuns++] = results[i];
+	}
+	return numRuns;
+}
+
+/**
+* @brief Measures every kernel and compares the run with a baseline file
+* @details If the file does not exist yet, or save is set, the run is
+* added to the baseline afterwards. Given runsPath, nothing is timed:
+* the runs in that file stand for the run, pooled per kernel, and
+* nothing is saved. Each kernel gets one line with its median, the
+* confidence interval and, if there is a baseline, the change of the
+* median, p, the smallest change that would be flagged and the verdict.
+*
+* @param path The baseline file
+* @param save Add the run to the baseline even if there already is one
+* @param runsPath A baseline file whose runs are compared with the baseline, NULL times a new run
+* @return EXIT_SUCCESS, or EXIT_FAILURE if a kernel is slower than its
+* baseline or a file cannot be read or written
+*/
+int Regress_run(const char* path, int save, const char* runsPath) {
+	static const char* const verdicts[] = { "same", "FASTER", "SLOWER", "new" };
+	int baselineCount = 0;
+	int loadedCount = 0;
+	RegressResult* baseline = Regress_load(path, &baselineCount);
+	RegressResult* loaded = runsPath != NULL ? Regress_load(runsPath, &loadedCount) : NULL;
+	FILE* exists = baseline == NULL ? fopen(path, "r") : NULL;
+	if (exists != NULL || (runsPath != NULL && (baseline == NULL || loaded == NULL))) {
+		if (exists != NULL) fclose(exists);
+		printf("regress: %s is not a baseline file\n", baseline == NULL ? path : runsPath);
+		free(baseline);
+		free(loaded);
+		return EXIT_FAILURE;
+	}
+	int most = baselineCount > loadedCount ? baselineCount : loadedCount;
+	RegressResult* runs = (RegressResult*)malloc((size_t)(most > 0 ? most : 1) * sizeof(RegressResult));
+	RegressResult* results = (RegressResult*)malloc((size_t)regressKernelCount * sizeof(RegressResult));
+	if (runs == NULL || results == NULL) {
+		free(baseline);
+		free(loaded);
+		free(runs);
+		free(results);
+		printf("regress: no memory\n");
+		return EXIT_FAILURE;
+	}
+
+	if (runsPath == NULL) {
+		printf("regress: %d kernels, %d rounds after %d warmup rounds\n", regressKernelCount, REGRESS_SAMPLES, REGRESS_WARMUP);
+		Regress_measure(regressKernels, regressKernelCount, REGRESS_WARMUP, REGRESS_SAMPLES, results);
+	}
+	else {
+		printf("regress: runs of %s against the baseline %s\n", runsPath, path);
+		for (int k = 0; k < regressKernelCount; k++) {
+			int numRuns = Regress_runsOf(regressKernels[k].name, loaded, loadedCount, runs);
+			snprintf(results[k].name, sizeof(results[k].name), "%s", regressKernels[k].name);
+			results[k].count = 0;
+			if (numRuns > 0) Regress_pool(runs, numRuns, &results[k]);
+		}
+	}
+	printf("regress: %-10s %10s  %-23s", "kernel", "median", "95% interval");
+	if (baseline != NULL) printf(" %10s %4s %8s %9s %7s", "baseline", "runs", "change", "p", "noise");
+	printf("\n");
+	int slower = 0;
+	for (int k = 0; k < regressKernelCount; k++) {
+		const RegressResult* result = &results[k];
+		if (result->count == 0) {
+			printf("regress: %-10s no runs\n", result->name);
+			continue;
+		}
+		printf("regress: %-10s %7.3f ms  [%7.3f, %7.3f] ms", result->name,
+			result->median * 1e3, result->low * 1e3, result->high * 1e3);
+		if (baseline != NULL) {
+			int numRuns = Regress_runsOf(result->name, baseline, baselineCount, runs);
+			RegressComparison comparison;
+			Regress_compare(runs, numRuns, result, &comparison);
+			if (comparison.verdict != regressNew) {
+				printf(" %7.3f ms %4d %+7.1f%% %9.2g %6.1f%%  %s", result->median / (1.0 + comparison.change) * 1e3,
+					numRuns, comparison.change * 100.0, comparison.p, comparison.noise * 100.0, verdicts[comparison.verdict]);
+			}
+			else {
+				printf(" %10s %4d %8s %9s %7s  %s", "-", 0, "-", "-", "-", verdicts[comparison.verdict]);
+			}
+			slower += comparison.verdict == regressSlower;
+		}
+		printf("\n");
+	}
+
+	int failed = 0;
+	if (runsPath == NULL && (baseline == NULL || save)) {
+		failed = Regress_append(path, results, regressKernelCount) != 0;
+		printf(failed ? "regress: cannot write %s\n" : "regress: run added to the baseline %s\n", path);
+	}
+	if (slower > 0) printf("regress: %d kernel(s) slower than the baseline\n", slower);
+	free(baseline);
+	free(loaded);
+	free(runs);
+	free(results);
+	return failed || slower > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
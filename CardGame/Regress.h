@@ -0,0 +1,105 @@
+/**
+ * @file Regress.h
+ * Provides interface for the regression tracker: a fixed set of timed
+ * kernels over the hot operations (shuffle, sort, hand operations, the
+ * played pile and whole games), measured the same way on every run so a
+ * run can be compared with a stored baseline.
+ *
+ * Every kernel does a fixed amount of work from a fixed seed, so all its
+ * samples time exactly the same operations. The kernels are run in
+ * rounds, every kernel once per round, so a slow spell of the machine
+ * hits all of them alike instead of one kernel's samples. REGRESS_WARMUP
+ * rounds run untimed, to fill the caches and the node pool, then
+ * REGRESS_SAMPLES rounds are timed. A kernel's result is the median of
+ * its samples with a 95% confidence interval from the order statistics,
+ * which needs no assumption about how the times are distributed and is
+ * not thrown off by the few samples an interruption makes much slower.
+ *
+ * Samples of one run are not enough to tell a change of the code from
+ * the noise between runs: heap layout, the state of the machine and its
+ * clock speed move all samples of a run together, often by more than
+ * REGRESS_MIN_CHANGE. A baseline therefore holds several runs. Each saved
+ * run is appended to the baseline file, one line per kernel as text: the
+ * name, the number of samples and the samples in seconds.
+ *
+ * A kernel is flagged as slower only if all of these hold:
+ * - a Mann-Whitney U test finds its samples slower than those of the
+ *   baseline runs at level REGRESS_ALPHA; the level is strict because
+ *   several kernels are tested at once
+ * - its median is at least REGRESS_MIN_CHANGE slower than the median of
+ *   the baseline runs' medians
+ * - with two or more baseline runs, that change is also more than
+ *   REGRESS_RUN_SIGMAS standard deviations of the runs' medians (taken on
+ *   a log scale, and widened for the number of runs), i.e. more than the
+ *   baseline runs differ from each other
+ * Faster kernels are reported the same way. A baseline of five or more
+ * runs gives a useful estimate of the noise between runs.
+ *
+ * Run it with "<program> regress <baseline>": the first run starts the
+ * baseline, later runs compare with it. "<program> regress <baseline>
+ * save" compares and then adds the run to the baseline. To start a new
+ * baseline after an intended change, delete the file.
+ *
+ * Two builds are compared best by alternating runs of both, each saved to
+ * a baseline of its own, so a drift of the machine's speed affects both
+ * alike. "<program> regress <baseline> <runs>" then compares the runs of
+ * the second file, pooled per kernel by Regress_pool, with the baseline
+ * instead of timing a new run; the Makefile's pgo-report does that.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef REGRESS_H
+#define REGRESS_H
+
+#include <stdint.h>
+
+#define REGRESS_WARMUP 3 // untimed rounds before the samples
+#define REGRESS_SAMPLES 21 // timed rounds, each gives one sample of every kernel
+#define REGRESS_MAX_SAMPLES 256 // most samples a result holds, also per line of a baseline file
+#define REGRESS_NAME 32 // longest kernel name, with the terminating 0
+#define REGRESS_ALPHA 0.001 // significance level of the comparison, one-sided
+#define REGRESS_MIN_CHANGE 0.05 // smallest relative change of the median that is flagged
+#define REGRESS_RUN_SIGMAS 3.0 // a flagged change exceeds this many standard deviations of the baseline runs
+#define REGRESS_HEADER "# cardgame regression baseline 1" // first line of a baseline file
+
+typedef struct {
+	const char* name; // name of the kernel, without spaces
+	uint64_t (*run)(void); // does the kernel's work once and returns a checksum of it
+} RegressKernel;
+
+typedef struct {
+	char name[REGRESS_NAME];
+	int count; // number of samples
+	double samples[REGRESS_MAX_SAMPLES]; // seconds per run, sorted by Regress_summarize
+	double median; // median of the samples
+	double low; // lower end of the 95% confidence interval of the median
+	double high; // upper end of the 95% confidence interval of the median
+} RegressResult;
+
+typedef enum {
+	regressSame, // no significant change
+	regressFaster, // significantly faster than the baseline
+	regressSlower, // significantly slower than the baseline
+	regressNew // not in the baseline
+} RegressVerdict;
+
+typedef struct {
+	RegressVerdict verdict;
+	double change; // median / median of the baseline runs' medians - 1
+	double p; // probability of samples differing at least this much in this direction by chance
+	double noise; // smallest slowdown that is flagged, from REGRESS_MIN_CHANGE and the spread of the baseline runs
+} RegressComparison;
+
+extern const RegressKernel regressKernels[];
+extern const int regressKernelCount;
+
+int Regress_measure(const RegressKernel* kernels, int count, int warmup, int samples, RegressResult* results);
+void Regress_summarize(RegressResult* result);
+void Regress_pool(const RegressResult* runs, int numRuns, RegressResult* pooled);
+void Regress_compare(const RegressResult* runs, int numRuns, const RegressResult* current, RegressComparison* comparison);
+int Regress_append(const char* path, const RegressResult* results, int count);
+RegressResult* Regress_load(const char* path, int* count);
+int Regress_run(const char* path, int save, const char* runsPath);
+
+#endif
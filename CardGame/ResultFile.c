@@ -0,0 +1,521 @@
+/**
+* @file ResultFile.c
+* Implementation of result files.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ResultFile.h"
+#include "Trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// largest encoded block: a varint column is only kept if it is smaller than the fixed one
+#define RESULT_BLOCK_BYTES (sizeof(ResultBlockHeader) + resultColumns * ((size_t)RESULT_BLOCK_ROWS * 8 + 8))
+
+/**
+* Maps a signed difference to an unsigned number that is small if the difference is.
+*/
+static inline uint64_t ResultFile_zigzag(uint64_t delta) {
+	return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+/**
+* Inverse of ResultFile_zigzag.
+*/
+static inline uint64_t ResultFile_unzigzag(uint64_t value) {
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+/**
+* Returns the bytes of a varint, 7 bits per byte.
+*/
+static inline size_t ResultFile_varintSize(uint64_t value) {
+	size_t size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+/**
+* @brief Fills in the result of a finished or stopped game
+*
+* @param game The game, it is only read
+* @param number Number of the game, its stream of the run's seed
+* @param turns Turns the game was played for
+* @param result Receives the result, with cell 0 and the number as the stream
+*/
+void GameResult_capture(const Game* game, uint64_t number, int turns, GameResult* result) {
+	result->game = number;
+	result->winner = game->status == win ? game->turn : RESULT_UNFINISHED; // the winner keeps the turn
+	result->turns = turns;
+	result->recycles = game->recycles;
+	result->handSizes[0] = CardDeck_count(&game->p1);
+	result->handSizes[1] = CardDeck_count(&game->p2);
+	result->cell = 0;
+	result->stream = number;
+}
+
+/**
+* Encodes one column of a block into data and fills in its header.
+*
+* @return bytes of the data, not counting the padding to 8 bytes
+*/
+static size_t ResultWriter_encodeColumn(const uint64_t* values, int rows, int flags, unsigned char* data,
+	ResultColumnHeader* column) {
+	uint64_t min = values[0];
+	uint64_t max = values[0];
+	for (int i = 1; i < rows; i++) {
+		if (values[i] < min) min = values[i];
+		if (values[i] > max) max = values[i];
+	}
+	uint64_t range = max - min;
+	int width = range <= 0xFF ? 1 : range <= 0xFFFF ? 2 : range <= 0xFFFFFFFFu ? 4 : 8;
+	size_t size = (size_t)rows * (size_t)width;
+	memset(column, 0, sizeof(*column));
+	column->min = min;
+	column->max = max;
+	column->encoding = resultFixed;
+	column->width = (uint8_t)width;
+
+	if (flags & RESULT_VARINT) {
+		size_t varints = 0;
+		uint64_t previous = min;
+		for (int i = 0; i < rows; i++) {
+			varints += ResultFile_varintSize(ResultFile_zigzag(values[i] - previous));
+			previous = values[i];
+		}
+		if (varints < size) {
+			previous = min;
+			unsigned char* out = data;
+			for (int i = 0; i < rows; i++) {
+				uint64_t value = ResultFile_zigzag(values[i] - previous);
+				previous = values[i];
+				while (value >= 0x80) {
+					*out++ = (unsigned char)(value | 0x80);
+					value >>= 7;
+				}
+				*out++ = (unsigned char)value;
+			}
+			column->encoding = resultVarint;
+			column->width = 0;
+			return varints;
+		}
+	}
+
+	// data is 8-byte aligned, so every width can be stored through a pointer of its own type
+	switch (width) {
+	case 1:
+		for (int i = 0; i < rows; i++) data[i] = (uint8_t)(values[i] - min);
+		break;
+	case 2:
+		for (int i = 0; i < rows; i++) ((uint16_t*)data)[i] = (uint16_t)(values[i] - min);
+		break;
+	case 4:
+		for (int i = 0; i < rows; i++) ((uint32_t*)data)[i] = (uint32_t)(values[i] - min);
+		break;
+	default:
+		for (int i = 0; i < rows; i++) ((uint64_t*)data)[i] = values[i] - min;
+		break;
+	}
+	return size;
+}
+
+/**
+* Encodes a block buffer into block.
+*
+* @return bytes of the block
+*/
+static size_t ResultWriter_encode(uint64_t* const* columns, int rows, int flags, unsigned char* block) {
+	ResultBlockHeader* header = (ResultBlockHeader*)block;
+	memset(header, 0, sizeof(*header));
+	size_t offset = sizeof(ResultBlockHeader);
+	for (int c = 0; c < resultColumns; c++) {
+		size_t size = ResultWriter_encodeColumn(columns[c], rows, flags, block + offset, &header->columns[c]);
+		size_t padded = (size + 7) & ~(size_t)7;
+		memset(block + offset + size, 0, padded - size);
+		header->columns[c].offset = (uint32_t)offset;
+		header->columns[c].size = (uint32_t)size;
+		offset += padded;
+	}
+	header->rows = (uint32_t)rows;
+	header->size = (uint32_t)offset;
+	return offset;
+}
+
+/**
+* Writes every full buffer it is handed until the writer is closed.
+*/
+static int ResultWriter_thread(void* arg) {
+	TRACE_THREAD_NAME("result writer");
+	ResultWriter* writer = (ResultWriter*)arg;
+	mtx_lock(&writer->lock);
+	for (;;) {
+		while (!writer->full && !writer->closing) cnd_wait(&writer->wake, &writer->lock);
+		if (!writer->full) break; // closing and everything written
+		int buffer = writer->filling ^ 1;
+		int rows = writer->rows[buffer];
+		mtx_unlock(&writer->lock);
+
+		// the buffer is not touched by anyone else until full is cleared again
+		size_t size = ResultWriter_encode(writer->columns[buffer], rows, writer->flags, writer->block);
+		int failed = fwrite(writer->block, 1, size, writer->out) != size;
+
+		mtx_lock(&writer->lock);
+		writer->failed |= failed;
+		writer->rows[buffer] = 0;
+		writer->full = 0;
+		cnd_broadcast(&writer->written);
+	}
+	mtx_unlock(&writer->lock);
+	return 0;
+}
+
+/**
+* Hands the buffer being filled to the thread and fills the other one,
+* once the thread is done with it. Called with the lock held.
+*/
+static void ResultWriter_handOff(ResultWriter* writer) {
+	while (writer->full) cnd_wait(&writer->written, &writer->lock);
+	writer->full = 1;
+	writer->filling ^= 1;
+	cnd_signal(&writer->wake);
+}
+
+/**
+* Frees the buffers of a writer and closes its file, in any state of ResultWriter_open.
+*/
+static void ResultWriter_free(ResultWriter* writer) {
+	if (writer->out != NULL) fclose(writer->out);
+	free(writer->columns[0][0]);
+	free(writer->block);
+	free(writer);
+}
+
+/**
+* @brief Creates a result file and starts the thread that writes it
+*
+* @param path Path of the file, an existing file is replaced
+* @param seed Seed of the run, stored in the file header
+* @param flags RESULT_VARINT to store columns as varints where that is smaller, otherwise 0
+* @return Pointer to the writer, NULL if the file cannot be created or allocation fails
+*/
+ResultWriter* ResultWriter_open(const char* path, uint64_t seed, int flags) {
+	ResultWriter* writer = (ResultWriter*)calloc(1, sizeof(ResultWriter));
+	if (writer == NULL) return NULL;
+	writer->flags = flags;
+	uint64_t* rows = (uint64_t*)malloc(2 * resultColumns * (size_t)RESULT_BLOCK_ROWS * sizeof(uint64_t));
+	writer->block = (unsigned char*)malloc(RESULT_BLOCK_BYTES);
+	writer->out = fopen(path, "wb");
+	if (rows == NULL || writer->block == NULL || writer->out == NULL) {
+		free(rows);
+		ResultWriter_free(writer);
+		return NULL;
+	}
+	for (int b = 0; b < 2; b++) {
+		for (int c = 0; c < resultColumns; c++) {
+			writer->columns[b][c] = rows + ((size_t)b * resultColumns + (size_t)c) * RESULT_BLOCK_ROWS;
+		}
+	}
+
+	ResultFileHeader header;
+	header.magic = RESULT_MAGIC;
+	header.version = RESULT_VERSION;
+	header.columns = resultColumns;
+	header.blockRows = RESULT_BLOCK_ROWS;
+	header.reserved = 0;
+	header.seed = seed;
+	if (fwrite(&header, sizeof(header), 1, writer->out) != 1) {
+		ResultWriter_free(writer);
+		return NULL;
+	}
+
+	int locked = mtx_init(&writer->lock, mtx_plain) == thrd_success;
+	int wake = locked && cnd_init(&writer->wake) == thrd_success;
+	int written = wake && cnd_init(&writer->written) == thrd_success;
+	if (written && thrd_create(&writer->thread, ResultWriter_thread, writer) == thrd_success) return writer;
+	if (written) cnd_destroy(&writer->written);
+	if (wake) cnd_destroy(&writer->wake);
+	if (locked) mtx_destroy(&writer->lock);
+	ResultWriter_free(writer);
+	return NULL;
+}
+
+/**
+* @brief Adds the results of games to the file
+* @details The results are only copied; the thread of the writer encodes
+* and writes them once a block is full. Any number of threads may add at
+* the same time, rows from one call stay together and in order.
+*
+* @param writer The writer
+* @param results The results
+* @param count Number of results
+* @return 0, or -1 if writing an earlier block failed
+*/
+int ResultWriter_add(ResultWriter* writer, const GameResult* results, int count) {
+	mtx_lock(&writer->lock);
+	// handing off a full buffer may wait and release the lock; no other call may add meanwhile
+	while (writer->adding) cnd_wait(&writer->written, &writer->lock);
+	writer->adding = 1;
+	for (int i = 0; i < count; i++) {
+		int buffer = writer->filling;
+		int row = writer->rows[buffer]++;
+		uint64_t* const* columns = writer->columns[buffer];
+		columns[resultGame][row] = results[i].game;
+		columns[resultWinner][row] = (uint64_t)results[i].winner;
+		columns[resultTurns][row] = (uint64_t)results[i].turns;
+		columns[resultRecycles][row] = (uint64_t)results[i].recycles;
+		columns[resultHand1][row] = (uint64_t)results[i].handSizes[0];
+		columns[resultHand2][row] = (uint64_t)results[i].handSizes[1];
+		columns[resultCell][row] = results[i].cell;
+		columns[resultStream][row] = results[i].stream;
+		if (writer->rows[buffer] == RESULT_BLOCK_ROWS) ResultWriter_handOff(writer);
+	}
+	writer->adding = 0;
+	cnd_broadcast(&writer->written);
+	int failed = writer->failed;
+	mtx_unlock(&writer->lock);
+	return failed ? -1 : 0;
+}
+
+/**
+* @brief Writes the last block, stops the thread and closes the file
+*
+* @param writer The writer, it is freed; NULL is allowed
+* @return 0, or -1 if any block could not be written
+*/
+int ResultWriter_close(ResultWriter* writer) {
+	if (writer == NULL) return 0;
+	mtx_lock(&writer->lock);
+	while (writer->adding) cnd_wait(&writer->written, &writer->lock);
+	if (writer->rows[writer->filling] > 0) ResultWriter_handOff(writer);
+	writer->closing = 1;
+	cnd_signal(&writer->wake);
+	mtx_unlock(&writer->lock);
+	thrd_join(writer->thread, NULL);
+
+	int failed = writer->failed | (fclose(writer->out) != 0);
+	writer->out = NULL;
+	cnd_destroy(&writer->written);
+	cnd_destroy(&writer->wake);
+	mtx_destroy(&writer->lock);
+	ResultWriter_free(writer);
+	return failed ? -1 : 0;
+}
+
+/**
+* Checks a block header against the room left in the file.
+*
+* @return bytes of the block, 0 if it is cut short or damaged
+*/
+static size_t ResultFile_checkBlock(const unsigned char* block, size_t room) {
+	if (room < sizeof(ResultBlockHeader)) return 0;
+	const ResultBlockHeader* header = (const ResultBlockHeader*)block;
+	if (header->rows == 0 || header->rows > RESULT_BLOCK_ROWS || header->size < sizeof(ResultBlockHeader) ||
+		header->size > room || header->size % 8 != 0) {
+		return 0;
+	}
+	for (int c = 0; c < resultColumns; c++) {
+		const ResultColumnHeader* column = &header->columns[c];
+		if (column->offset < sizeof(ResultBlockHeader) || column->offset % 8 != 0 || column->offset > header->size ||
+			column->size > header->size - column->offset) {
+			return 0;
+		}
+		if (column->encoding == resultFixed) {
+			if ((column->width != 1 && column->width != 2 && column->width != 4 && column->width != 8) ||
+				column->size != header->rows * (uint32_t)column->width) {
+				return 0;
+			}
+		}
+		else if (column->encoding != resultVarint) {
+			return 0;
+		}
+	}
+	return header->size;
+}
+
+/**
+* Checks the file header and finds the complete blocks.
+*
+* @return 0, or -1 if the file is not a result file or allocation fails
+*/
+static int ResultFile_index(ResultFile* file) {
+	const unsigned char* data = (const unsigned char*)file->mapping;
+	if (file->size < sizeof(ResultFileHeader)) return -1;
+	const ResultFileHeader* header = (const ResultFileHeader*)data;
+	if (header->magic != RESULT_MAGIC || header->version != RESULT_VERSION || header->columns != resultColumns ||
+		header->blockRows != RESULT_BLOCK_ROWS) {
+		return -1;
+	}
+	file->header = header;
+
+	size_t offset = sizeof(ResultFileHeader);
+	size_t size;
+	int count = 0;
+	while ((size = ResultFile_checkBlock(data + offset, file->size - offset)) > 0) {
+		offset += size;
+		count++;
+	}
+	file->blocks = (size_t*)malloc((size_t)(count > 0 ? count : 1) * sizeof(size_t));
+	if (file->blocks == NULL) return -1;
+	offset = sizeof(ResultFileHeader);
+	for (int b = 0; b < count; b++) {
+		file->blocks[b] = offset;
+		file->rows += ((const ResultBlockHeader*)(data + offset))->rows;
+		offset += ((const ResultBlockHeader*)(data + offset))->size;
+	}
+	file->count = count;
+	return 0;
+}
+
+/**
+* @brief Maps a result file into memory
+* @details Only the headers are read here, the columns when they are used.
+*
+* @param path Path of the file
+* @return Pointer to the open file, NULL if it cannot be mapped or is not a result file
+*/
+ResultFile* ResultFile_open(const char* path) {
+	ResultFile* file = (ResultFile*)calloc(1, sizeof(ResultFile));
+	if (file == NULL) return NULL;
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER size;
+	if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+		if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+		free(file);
+		return NULL;
+	}
+	HANDLE view = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* mapping = view != NULL ? MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (mapping == NULL) {
+		if (view != NULL) CloseHandle(view);
+		CloseHandle(handle);
+		free(file);
+		return NULL;
+	}
+	file->file = handle;
+	file->view = view;
+	file->size = (size_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+		if (fd >= 0) close(fd);
+		free(file);
+		return NULL;
+	}
+	void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps the file open
+	if (mapping == MAP_FAILED) {
+		free(file);
+		return NULL;
+	}
+	file->size = (size_t)info.st_size;
+#endif
+
+	file->mapping = mapping;
+	if (ResultFile_index(file) != 0) {
+		ResultFile_close(file);
+		return NULL;
+	}
+	return file;
+}
+
+/**
+* @brief Unmaps a result file
+* @details Block headers returned by ResultFile_block must not be used afterwards.
+*
+* @param file Pointer to the file, NULL is allowed
+*/
+void ResultFile_close(ResultFile* file) {
+	if (file == NULL) return;
+#ifdef _WIN32
+	UnmapViewOfFile(file->mapping);
+	CloseHandle((HANDLE)file->view);
+	CloseHandle((HANDLE)file->file);
+#else
+	munmap(file->mapping, file->size);
+#endif
+	free(file->blocks);
+	free(file);
+}
+
+/**
+* @brief Returns the header of a block, without copying it
+* @details The minimum and maximum of every column in it tell whether the
+* block needs to be read at all.
+*
+* @param file Pointer to the open file
+* @param index Index of the block
+* @return Pointer into the mapping, NULL if index is out of range
+*/
+const ResultBlockHeader* ResultFile_block(const ResultFile* file, int index) {
+	if (file == NULL || index < 0 || index >= file->count) return NULL;
+	return (const ResultBlockHeader*)((const unsigned char*)file->mapping + file->blocks[index]);
+}
+
+/**
+* @brief Decodes one column of a block
+*
+* @param file Pointer to the open file
+* @param index Index of the block
+* @param column The column
+* @param values Receives one value per game of the block, room for RESULT_BLOCK_ROWS is always enough
+* @return Number of values, -1 if index or column is out of range or the varints are damaged
+*/
+int ResultFile_readColumn(const ResultFile* file, int index, ResultColumn column, uint64_t* values) {
+	const ResultBlockHeader* header = ResultFile_block(file, index);
+	if (header == NULL || column < 0 || column >= resultColumns) return -1;
+	const ResultColumnHeader* info = &header->columns[column];
+	const unsigned char* data = (const unsigned char*)header + info->offset;
+	int rows = (int)header->rows;
+	uint64_t min = info->min;
+
+	if (info->encoding == resultVarint) {
+		const unsigned char* end = data + info->size;
+		uint64_t previous = min;
+		for (int i = 0; i < rows; i++) {
+			uint64_t value = 0;
+			int shift = 0;
+			unsigned char byte;
+			do {
+				if (data == end || shift > 63) return -1;
+				byte = *data++;
+				value |= (uint64_t)(byte & 0x7F) << shift;
+				shift += 7;
+			} while (byte & 0x80);
+			previous += ResultFile_unzigzag(value);
+			values[i] = previous;
+		}
+		return rows;
+	}
+
+	switch (info->width) {
+	case 1:
+		for (int i = 0; i < rows; i++) values[i] = min + data[i];
+		break;
+	case 2:
+		for (int i = 0; i < rows; i++) values[i] = min + ((const uint16_t*)data)[i];
+		break;
+	case 4:
+		for (int i = 0; i < rows; i++) values[i] = min + ((const uint32_t*)data)[i];
+		break;
+	default:
+		for (int i = 0; i < rows; i++) values[i] = min + ((const uint64_t*)data)[i];
+		break;
+	}
+	return rows;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file ResultFile.h
+ * Provides interface for result files: the outcome of every game of a
+ * run, stored by column in a compact binary file.
+ *
+ * A result file is a ResultFileHeader followed by blocks of up to
+ * RESULT_BLOCK_ROWS games. Every block starts with a ResultBlockHeader
+ * that gives, for each column, the smallest and largest value in the block
+ * and where the column's data is. An aggregation that only needs some
+ * columns reads only those, and one that looks for e.g. long games skips
+ * every block whose largest turn count is too small without decoding it.
+ *
+ * A column is stored either with a fixed width, as the difference to the
+ * block's minimum in 1, 2, 4 or 8 bytes, or, if the writer allows it and
+ * it is smaller, as zigzag varints of the difference to the previous value
+ * (the first to the minimum). Game numbers that count up by one take one
+ * byte per game that way. Fixed-width columns start at a multiple of 8
+ * bytes, so they can be read in place as arrays of their width.
+ *
+ * ResultWriter collects rows in one block buffer while a thread of its own
+ * encodes and writes the other one, so the threads playing the games only
+ * copy their results. They wait only if a full buffer is ready before the
+ * thread has written the last one, i.e. when the disk cannot keep up.
+ *
+ * ResultFile_open maps the file into memory, like scenario files. A block
+ * cut short at the end of the file, left by a writer that was stopped, is
+ * left out. Numbers are stored in the byte order of the machine that wrote
+ * the file.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef RESULTFILE_H
+#define RESULTFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <threads.h>
+#include "game.h"
+
+#define RESULT_MAGIC 0x53524743u // "CGRS" when read as little endian
+#define RESULT_VERSION 2
+#define RESULT_BLOCK_ROWS 65536 // most games in one block
+#define RESULT_VARINT 1 // writer flag: a column may be stored as varints where that is smaller
+#define RESULT_UNFINISHED 2 // winner of a game stopped at the turn limit
+
+typedef enum { // columns of a result file, in the order they are stored
+	resultGame, // number of the game: in a campaign also its stream, in a sweep its index in its cell
+	resultWinner, // 0 or 1 for the player who won, RESULT_UNFINISHED
+	resultTurns, // turns played
+	resultRecycles, // times the played pile was shuffled back into the hidden deck
+	resultHand1, // cards left in the hand of player 1
+	resultHand2, // cards left in the hand of player 2
+	resultCell, // key of the game's cell in a sweep (see Sweep_cellKey), 0 in a campaign
+	resultStream, // stream of the seed the game shuffled with, the game's task in a sweep
+	resultColumns // number of columns
+} ResultColumn;
+
+typedef enum {
+	resultFixed, // value - min in width bytes
+	resultVarint // zigzag varint of the difference to the value before, the first to min
+} ResultEncoding;
+
+typedef struct {
+	uint64_t game;
+	int winner;
+	int turns;
+	int recycles;
+	int handSizes[2];
+	uint64_t cell;
+	uint64_t stream;
+} GameResult;
+
+typedef struct {
+	uint32_t magic; // RESULT_MAGIC
+	uint16_t version; // RESULT_VERSION
+	uint16_t columns; // resultColumns
+	uint32_t blockRows; // RESULT_BLOCK_ROWS
+	uint32_t reserved; // 0
+	uint64_t seed; // seed of the run
+} ResultFileHeader;
+
+typedef struct {
+	uint64_t min; // smallest value in the block
+	uint64_t max; // largest value in the block
+	uint32_t offset; // start of the data from the start of the block
+	uint32_t size; // bytes of data
+	uint8_t encoding; // ResultEncoding
+	uint8_t width; // bytes per value of a resultFixed column
+	uint8_t reserved[6]; // 0
+} ResultColumnHeader;
+
+typedef struct {
+	uint32_t rows; // games in the block
+	uint32_t size; // bytes of the block, header included
+	ResultColumnHeader columns[resultColumns];
+} ResultBlockHeader;
+
+_Static_assert(sizeof(ResultFileHeader) == 24, "ResultFileHeader must have no padding");
+_Static_assert(sizeof(ResultColumnHeader) == 32, "ResultColumnHeader must have no padding");
+_Static_assert(sizeof(ResultBlockHeader) % 8 == 0, "ResultBlockHeader must keep the columns aligned");
+
+typedef struct {
+	FILE* out;
+	int flags; // RESULT_VARINT or 0
+	uint64_t* columns[2][resultColumns]; // the two block buffers
+	int rows[2]; // rows in each buffer
+	int filling; // buffer that ResultWriter_add fills
+	int full; // 1 while the other buffer waits for or is being written by the thread
+	int closing; // set by ResultWriter_close
+	int failed; // set once a block could not be written
+	int adding; // 1 while a call of ResultWriter_add copies its rows
+	unsigned char* block; // the encoded block, only used by the thread
+	mtx_t lock; // guards everything above but block
+	cnd_t wake; // the thread waits on it for a full buffer
+	cnd_t written; // ResultWriter_add waits on it for the thread and for other adds
+	thrd_t thread;
+} ResultWriter;
+
+typedef struct {
+	const ResultFileHeader* header; // start of the mapping
+	size_t* blocks; // offset of every block in the mapping
+	int count; // number of complete blocks
+	uint64_t rows; // games in all complete blocks
+	void* mapping; // start of the mapped file
+	size_t size; // length of the mapping
+#ifdef _WIN32
+	void* file; // HANDLE of the file
+	void* view; // HANDLE of the file mapping
+#endif
+} ResultFile;
+
+void GameResult_capture(const Game* game, uint64_t number, int turns, GameResult* result);
+
+ResultWriter* ResultWriter_open(const char* path, uint64_t seed, int flags);
+int ResultWriter_add(ResultWriter* writer, const GameResult* results, int count);
+int ResultWriter_close(ResultWriter* writer);
+
+ResultFile* ResultFile_open(const char* path);
+void ResultFile_close(ResultFile* file);
+const ResultBlockHeader* ResultFile_block(const ResultFile* file, int index);
+int ResultFile_readColumn(const ResultFile* file, int index, ResultColumn column, uint64_t* values);
+
+#endif
@@ -0,0 +1,224 @@
+/**
+* @file Rng.c
+* Provides implementation of the batched random number generator:
+* seeding, bulk refill (AVX2 or scalar), jumps and the per-thread
+* default generator.
+*
+* @date 19.10.2026
+*/
+
+#include "Rng.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define RNG_THREAD_LOCAL __declspec(thread)
+#else
+#define RNG_THREAD_LOCAL _Thread_local
+#endif
+
+// xoshiro256 jump polynomial, equivalent to 2^128 calls of the generator
+static const uint64_t rngJump[4] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+static RNG_THREAD_LOCAL Rng rngDefault;
+static RNG_THREAD_LOCAL int rngDefaultSeeded = 0;
+
+static uint64_t Rng_rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+* splitmix64, used only to expand a seed into a full xoshiro state.
+*/
+static uint64_t Rng_splitmix(uint64_t* x) {
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+* Advances one lane by 2^128 steps.
+*/
+static void Rng_jumpLane(Rng* rng, int lane) {
+	uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+	for (int i = 0; i < 4; i++) {
+		for (int b = 0; b < 64; b++) {
+			if (rngJump[i] & ((uint64_t)1 << b)) {
+				s0 ^= rng->state[0][lane];
+				s1 ^= rng->state[1][lane];
+				s2 ^= rng->state[2][lane];
+				s3 ^= rng->state[3][lane];
+			}
+			// one plain xoshiro256 step of this lane
+			uint64_t t = rng->state[1][lane] << 17;
+			rng->state[2][lane] ^= rng->state[0][lane];
+			rng->state[3][lane] ^= rng->state[1][lane];
+			rng->state[1][lane] ^= rng->state[2][lane];
+			rng->state[0][lane] ^= rng->state[3][lane];
+			rng->state[2][lane] ^= t;
+			rng->state[3][lane] = Rng_rotl(rng->state[3][lane], 45);
+		}
+	}
+	rng->state[0][lane] = s0;
+	rng->state[1][lane] = s1;
+	rng->state[2][lane] = s2;
+	rng->state[3][lane] = s3;
+}
+
+/**
+* Seeds a generator. The same seed always gives the same sequence.
+*
+* @param rng The generator to seed
+* @param seed Any 64-bit value
+*/
+void Rng_seed(Rng* rng, uint64_t seed) {
+	uint64_t x = seed;
+	for (int w = 0; w < 4; w++) {
+		rng->state[w][0] = Rng_splitmix(&x);
+	}
+
+	// lane k is lane 0 advanced by k jumps, so the lanes never overlap
+	for (int lane = 1; lane < RNG_LANES; lane++) {
+		for (int w = 0; w < 4; w++) {
+			rng->state[w][lane] = rng->state[w][lane - 1];
+		}
+		Rng_jumpLane(rng, lane);
+	}
+	rng->next = 2 * RNG_BUFFER_WORDS; // empty buffer, first draw refills
+	rng->pending = 0;
+}
+
+/**
+* Seeds a generator with stream number stream of seed. Each (seed, stream)
+* pair always gives the same sequence, no matter which other streams were
+* made before or on which thread, so e.g. game i of a simulation can use
+* stream i and be replayed on its own.
+*
+* The stream is reached by counting, not by jumping: the state of lane 0
+* is expanded from a key that is a bijection of stream for a fixed seed,
+* so stream i costs the same as stream 0. Reaching it with Rng_jump would
+* take i jumps.
+*
+* @param rng The generator to seed
+* @param seed Any 64-bit value, shared by all streams of a run
+* @param stream Number of the stream
+*/
+void Rng_seedStream(Rng* rng, uint64_t seed, uint64_t stream) {
+	uint64_t x = seed;
+	uint64_t key = Rng_splitmix(&x); // nearby seeds give unrelated keys
+	Rng_seed(rng, key ^ (stream * 0xd1342543de82ef95ULL)); // odd multiplier, one key per stream
+}
+
+/**
+* Same as Rng_seed, but the work is put off until the first draw (or jump).
+* For generators that are seeded often and rarely used, e.g. one per replayed game.
+*/
+void Rng_seedLazy(Rng* rng, uint64_t seed) {
+	rng->pendingSeed = seed;
+	rng->pending = 1;
+	rng->next = 2 * RNG_BUFFER_WORDS; // empty buffer, first draw refills and seeds
+}
+
+/**
+* Refills the whole buffer with RNG_BUFFER_WORDS new words,
+* RNG_LANES words (one from each lane) per step.
+*
+* @param rng The generator to refill
+*/
+void Rng_refill(Rng* rng) {
+	if (rng->pending) Rng_seed(rng, rng->pendingSeed);
+#if defined(__AVX2__) && RNG_LANES == 4
+	__m256i s0 = _mm256_loadu_si256((const __m256i*)rng->state[0]);
+	__m256i s1 = _mm256_loadu_si256((const __m256i*)rng->state[1]);
+	__m256i s2 = _mm256_loadu_si256((const __m256i*)rng->state[2]);
+	__m256i s3 = _mm256_loadu_si256((const __m256i*)rng->state[3]);
+
+	for (int i = 0; i < RNG_BUFFER_WORDS; i += RNG_LANES) {
+		// rotl(s1 * 5, 7) * 9, with the multiplies done as shift + add
+		__m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+		x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+		x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+		_mm256_storeu_si256((__m256i*)&rng->buffer.words[i], x);
+
+		__m256i t = _mm256_slli_epi64(s1, 17);
+		s2 = _mm256_xor_si256(s2, s0);
+		s3 = _mm256_xor_si256(s3, s1);
+		s1 = _mm256_xor_si256(s1, s2);
+		s0 = _mm256_xor_si256(s0, s3);
+		s2 = _mm256_xor_si256(s2, t);
+		s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+	}
+
+	_mm256_storeu_si256((__m256i*)rng->state[0], s0);
+	_mm256_storeu_si256((__m256i*)rng->state[1], s1);
+	_mm256_storeu_si256((__m256i*)rng->state[2], s2);
+	_mm256_storeu_si256((__m256i*)rng->state[3], s3);
+#else
+	uint64_t s[4][RNG_LANES];
+	memcpy(s, rng->state, sizeof(s));
+
+	for (int i = 0; i < RNG_BUFFER_WORDS; i += RNG_LANES) {
+		for (int lane = 0; lane < RNG_LANES; lane++) {
+			rng->buffer.words[i + lane] = Rng_rotl(s[1][lane] * 5, 7) * 9;
+
+			uint64_t t = s[1][lane] << 17;
+			s[2][lane] ^= s[0][lane];
+			s[3][lane] ^= s[1][lane];
+			s[1][lane] ^= s[2][lane];
+			s[0][lane] ^= s[3][lane];
+			s[2][lane] ^= t;
+			s[3][lane] = Rng_rotl(s[3][lane], 45);
+		}
+	}
+
+	memcpy(rng->state, s, sizeof(s));
+#endif
+	rng->next = 0;
+}
+
+/**
+* Advances every lane by RNG_LANES jumps, i.e. past everything the
+* generator could ever produce before the jump. A copy of a generator
+* followed by Rng_jump on the original gives two non-overlapping streams.
+* Words already in the buffer are discarded.
+*
+* @param rng The generator to advance
+*/
+void Rng_jump(Rng* rng) {
+	if (rng->pending) Rng_seed(rng, rng->pendingSeed);
+	for (int lane = 0; lane < RNG_LANES; lane++) {
+		for (int j = 0; j < RNG_LANES; j++) {
+			Rng_jumpLane(rng, lane);
+		}
+	}
+	rng->next = 2 * RNG_BUFFER_WORDS;
+}
+
+/**
+* Returns the calling thread's default generator, used by CardDeck_shuffle.
+* Unless Rng_seedDefault was called first, it is seeded from the time and
+* the address of the thread's generator, so threads get different streams.
+*/
+Rng* Rng_default(void) {
+	if (!rngDefaultSeeded) {
+		Rng_seed(&rngDefault, (uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)&rngDefault);
+		rngDefaultSeeded = 1;
+	}
+	return &rngDefault;
+}
+
+/**
+* Reseeds the calling thread's default generator, e.g. for reproducible runs.
+*
+* @param seed Any 64-bit value
+*/
+void Rng_seedDefault(uint64_t seed) {
+	Rng_seed(&rngDefault, seed);
+	rngDefaultSeeded = 1;
+}
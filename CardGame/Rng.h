@@ -0,0 +1,85 @@
+/**
+ * @file Rng.h
+ * Provides interface for the batched random number generator used
+ * by shuffling: a buffer of random 64-bit words that is refilled in
+ * bulk, and unbiased bounded integers taken from that buffer.
+ *
+ * The generator is xoshiro256** run as RNG_LANES independent lanes.
+ * Lane k starts k jumps (k * 2^128 steps) after lane 0, so lanes never
+ * overlap. A refill steps all lanes together, which is vectorized with
+ * AVX2 when the compiler targets it; the scalar path produces exactly
+ * the same words, so results do not depend on the instruction set.
+ *
+ * Bounded integers use Lemire's multiply-and-reject method, which
+ * needs one 32-bit word in the common case and has no modulo bias.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+#define RNG_LANES 4 // independent xoshiro256** streams stepped together
+#define RNG_BUFFER_WORDS 256 // 64-bit words produced per refill, multiple of RNG_LANES
+
+typedef struct {
+	uint64_t state[4][RNG_LANES]; // xoshiro256** state, state[w][lane] so one row is one vector
+	union {
+		uint64_t words[RNG_BUFFER_WORDS];
+		uint32_t halves[2 * RNG_BUFFER_WORDS];
+	} buffer; // random output not handed out yet
+	int next; // next unused 32-bit half of buffer
+	int pending; // set by Rng_seedLazy until the state is seeded
+	uint64_t pendingSeed; // seed to apply on the first draw while pending
+} Rng;
+
+void Rng_seed(Rng* rng, uint64_t seed);
+void Rng_seedLazy(Rng* rng, uint64_t seed);
+void Rng_seedStream(Rng* rng, uint64_t seed, uint64_t stream);
+void Rng_refill(Rng* rng);
+void Rng_jump(Rng* rng);
+Rng* Rng_default(void);
+void Rng_seedDefault(uint64_t seed);
+
+/**
+* Returns the next random 32-bit word from the buffer.
+*/
+static inline uint32_t Rng_next32(Rng* rng) {
+	if (rng->next >= 2 * RNG_BUFFER_WORDS) Rng_refill(rng);
+	return rng->buffer.halves[rng->next++];
+}
+
+/**
+* Returns the next random 64-bit word from the buffer.
+*/
+static inline uint64_t Rng_next64(Rng* rng) {
+	rng->next = (rng->next + 1) & ~1; // skip a half used by Rng_next32
+	if (rng->next >= 2 * RNG_BUFFER_WORDS) Rng_refill(rng);
+	uint64_t word = rng->buffer.words[rng->next / 2];
+	rng->next += 2;
+	return word;
+}
+
+/**
+* Returns an unbiased random integer in [0, range) using Lemire's method.
+*
+* @param rng The generator to draw from
+* @param range Number of possible results, must be at least 1
+*/
+static inline uint32_t Rng_bounded(Rng* rng, uint32_t range) {
+	uint64_t product = (uint64_t)Rng_next32(rng) * range;
+	uint32_t low = (uint32_t)product;
+
+	if (low < range) { // only then can the result be biased
+		uint32_t threshold = (0u - range) % range;
+		while (low < threshold) {
+			product = (uint64_t)Rng_next32(rng) * range;
+			low = (uint32_t)product;
+		}
+	}
+	return (uint32_t)(product >> 32);
+}
+
+#endif
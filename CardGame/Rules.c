@@ -0,0 +1,49 @@
+/**
+* @file Rules.c
+* Implementation of the rule variant names and the slow, general match test.
+*
+* @date 19.10.2026
+*/
+
+#include <string.h>
+#include "Rules.h"
+
+const char* const ruleNames[rulesCount] = {
+#define RULES_NAME(name, text, match) text,
+	RULES_VARIANTS(RULES_NAME)
+#undef RULES_NAME
+};
+
+/**
+* @brief Looks a rule variant up by its command line name
+*
+* @param name Name such as "standard" or "wild-eights"
+* @return The variant, or -1 if no variant has that name
+*/
+int Rules_fromName(const char* name) {
+	for (int i = 0; i < rulesCount; i++) {
+		if (strcmp(name, ruleNames[i]) == 0) return i;
+	}
+	return -1;
+}
+
+/**
+* @brief Tests one card against the top card under any variant
+* @details Picks the predicate on every call, for code that tests a few
+* cards, such as building tables. Hand scans use the per-variant scans in
+* game.c instead.
+*
+* @param rules The variant
+* @param card The card to play
+* @param top The top card of the played pile
+* @return 1 if card may be played on top, 0 if not or the variant is unknown
+*/
+int Rules_matches(RuleVariant rules, const Card* card, const Card* top) {
+	switch (rules) {
+#define RULES_CASE(name, text, match) case rules##name: return Rules_match##name(card, top);
+		RULES_VARIANTS(RULES_CASE)
+#undef RULES_CASE
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,58 @@
+/**
+ * @file Rules.h
+ * Provides interface for the rule variants: which hand card may be played
+ * on the top card of the played pile.
+ *
+ * Every variant is one line of RULES_VARIANTS: its name, the name used on
+ * the command line, and its match condition written in terms of card and
+ * top. From that list each variant gets its own inline predicate
+ * Rules_match<Name>, and game.c gets its own hand scan per variant with
+ * the predicate compiled into the loop. A game picks its variant once
+ * per turn; the loop over the hand never asks which variant it runs, so
+ * the standard rule costs what the hard-coded suit-or-rank test did.
+ *
+ * To add a variant, add a line to RULES_VARIANTS.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef RULES_H
+#define RULES_H
+
+#include "Card.h"
+
+/**
+* Returns 1 if two ranks are next to each other, Ace and Two count as next
+* to each other too.
+*/
+static inline int Rules_adjacent(Rank a, Rank b) {
+	int distance = (int)a - (int)b;
+	return distance == 1 || distance == -1 || distance == 12 || distance == -12;
+}
+
+// every rule variant: X(Name, command line name, match condition on card and top)
+#define RULES_VARIANTS(X) \
+	X(Standard, "standard", card->suit == top->suit || card->rank == top->rank) \
+	X(SuitOnly, "suit", card->suit == top->suit) \
+	X(RankOnly, "rank", card->rank == top->rank) \
+	X(WildEights, "wild-eights", card->rank == EIGHT || card->suit == top->suit || card->rank == top->rank) \
+	X(AdjacentRank, "adjacent", card->suit == top->suit || Rules_adjacent(card->rank, top->rank))
+
+typedef enum {
+#define RULES_ENUM(name, text, match) rules##name,
+	RULES_VARIANTS(RULES_ENUM)
+#undef RULES_ENUM
+	rulesCount
+} RuleVariant;
+
+#define RULES_PREDICATE(name, text, match) \
+	static inline int Rules_match##name(const Card* card, const Card* top) { return match; }
+RULES_VARIANTS(RULES_PREDICATE)
+#undef RULES_PREDICATE
+
+extern const char* const ruleNames[rulesCount];
+
+int Rules_fromName(const char* name);
+int Rules_matches(RuleVariant rules, const Card* card, const Card* top);
+
+#endif
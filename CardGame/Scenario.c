@@ -0,0 +1,247 @@
+/**
+* @file Scenario.c
+* Implementation of scenario files.
+*
+* @date 19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Scenario.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+* Checks the header against the size of the file.
+*
+* @return number of records, -1 if the file is not a valid scenario file
+*/
+static int ScenarioFile_validate(const void* data, size_t size) {
+	if (size < sizeof(ScenarioFileHeader)) return -1;
+	const ScenarioFileHeader* header = (const ScenarioFileHeader*)data;
+	if (header->magic != SCENARIO_MAGIC || header->version != SCENARIO_VERSION ||
+		header->packs < 1 || header->packs > SCENARIO_MAX_PACKS ||
+		header->recordSize != Scenario_recordSize((int)header->packs) || header->count > (uint32_t)INT32_MAX) {
+		return -1;
+	}
+	if ((size - sizeof(ScenarioFileHeader)) / header->recordSize < header->count) return -1;
+	return (int)header->count;
+}
+
+/**
+* @brief Maps a scenario file into memory
+* @details Only the header is checked here. The records are read when they
+* are used, so opening a large file costs the same as opening a small one.
+*
+* @param path Path of the file
+* @return Pointer to the open file, NULL if it cannot be mapped or is not a scenario file
+*/
+ScenarioFile* ScenarioFile_open(const char* path) {
+	ScenarioFile* file = (ScenarioFile*)malloc(sizeof(ScenarioFile));
+	if (file == NULL) return NULL;
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER size;
+	if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+		if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+		free(file);
+		return NULL;
+	}
+	HANDLE view = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* mapping = view != NULL ? MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (mapping == NULL) {
+		if (view != NULL) CloseHandle(view);
+		CloseHandle(handle);
+		free(file);
+		return NULL;
+	}
+	file->file = handle;
+	file->view = view;
+	file->size = (size_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+		if (fd >= 0) close(fd);
+		free(file);
+		return NULL;
+	}
+	void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps the file open
+	if (mapping == MAP_FAILED) {
+		free(file);
+		return NULL;
+	}
+	file->size = (size_t)info.st_size;
+#endif
+
+	file->mapping = mapping;
+	file->count = ScenarioFile_validate(mapping, file->size);
+	if (file->count < 0) {
+		ScenarioFile_close(file);
+		return NULL;
+	}
+	file->packs = (int)((const ScenarioFileHeader*)mapping)->packs;
+	file->records = (const ScenarioRecord*)((const unsigned char*)mapping + sizeof(ScenarioFileHeader));
+	return file;
+}
+
+/**
+* @brief Unmaps a scenario file
+* @details Records returned by ScenarioFile_at must not be used afterwards.
+*
+* @param file Pointer to the file, NULL is allowed
+*/
+void ScenarioFile_close(ScenarioFile* file) {
+	if (file == NULL) return;
+#ifdef _WIN32
+	UnmapViewOfFile(file->mapping);
+	CloseHandle((HANDLE)file->view);
+	CloseHandle((HANDLE)file->file);
+#else
+	munmap(file->mapping, file->size);
+#endif
+	free(file);
+}
+
+/**
+* @brief Returns a record of a scenario file, without copying it
+*
+* @param file Pointer to the open file
+* @param index Index of the record
+* @return Pointer into the mapping, NULL if index is out of range or the
+* record claims more room than the file gives it
+*/
+const ScenarioRecord* ScenarioFile_at(const ScenarioFile* file, int index) {
+	if (file == NULL || index < 0 || index >= file->count) return NULL;
+	const ScenarioRecord* record = ScenarioRecord_at((void*)file->records, file->packs, index);
+	// Scenario_newGame reads as many cards as the record's packs allow, which must stay inside the record
+	return record->packs >= 1 && record->packs <= file->packs ? record : NULL;
+}
+
+/**
+* @brief Writes records to a new scenario file
+*
+* @param path Path of the file, an existing file is replaced
+* @param records The records, Scenario_recordSize(packs) bytes each
+* @param count Number of records
+* @param packs Packs every record has room for, as given to Scenario_capture
+* @return 0, or -1 if the file cannot be written or packs is out of range
+*/
+int ScenarioFile_write(const char* path, const ScenarioRecord* records, int count, int packs) {
+	if (count < 0 || packs < 1 || packs > SCENARIO_MAX_PACKS) return -1;
+	FILE* out = fopen(path, "wb");
+	if (out == NULL) return -1;
+
+	ScenarioFileHeader header;
+	header.magic = SCENARIO_MAGIC;
+	header.version = SCENARIO_VERSION;
+	header.recordSize = (uint16_t)Scenario_recordSize(packs);
+	header.count = (uint32_t)count;
+	header.packs = (uint32_t)packs;
+	int failed = fwrite(&header, sizeof(header), 1, out) != 1 ||
+		(count > 0 && fwrite(records, header.recordSize, (size_t)count, out) != (size_t)count);
+	failed |= fclose(out) != 0;
+	return failed ? -1 : 0;
+}
+
+/**
+* Packs the cards of a deck, top card first.
+*
+* @return number of cards packed, -1 if more than room cards are in the deck
+*/
+static int Scenario_packDeck(const CardDeck* deck, PackedCard* cards, int room) {
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		if (it.index > room) return -1;
+		cards[it.index - 1] = Card_pack(*card);
+	}
+	return it.index;
+}
+
+/**
+* @brief Records the current state of a game as a scenario
+*
+* @param game The game, it is only read
+* @param seed Seed stored in the record
+* @param packs Packs the record has room for, at least the game's
+* @param record Receives the scenario, Scenario_recordSize(packs) bytes
+* @return ok, or illegalCard if packs is out of range or the game holds more than packs packs of cards
+*/
+deckError Scenario_capture(const Game* game, uint64_t seed, int packs, ScenarioRecord* record) {
+	if (packs < 1 || packs > SCENARIO_MAX_PACKS) return illegalCard;
+	const CardDeck* decks[3] = { &game->hidden, &game->p1, &game->p2 };
+	uint16_t* counts[3] = { &record->hiddenCount, &record->p1Count, &record->p2Count };
+	int room = packs * PACK_SIZE;
+
+	memset(record, 0, Scenario_recordSize(packs));
+	record->seed = seed;
+	record->turn = (uint8_t)game->turn;
+	record->packs = (uint8_t)packs;
+	int used = 0;
+	for (int d = 0; d < 3; d++) {
+		int count = Scenario_packDeck(decks[d], record->cards + used, room - used);
+		if (count < 0) return illegalCard;
+		*counts[d] = (uint16_t)count;
+		used += count;
+	}
+
+	// the played pile keeps the cards below its top card oldest first, the record newest first
+	const PlayedPile* played = &game->played;
+	if (played->count > room - used) return illegalCard;
+	if (played->count > 0) record->cards[used] = played->top;
+	for (int i = 1; i < played->count; i++) {
+		record->cards[used + i] = played->cards[played->count - 1 - i];
+	}
+	record->playedCount = (uint16_t)played->count;
+	return ok;
+}
+
+/**
+* @brief Builds a game from a scenario
+* @details The decks are filled straight from the packed cards of the record.
+* rng is seeded with the record's seed and used for every later shuffle of
+* the game, so replaying a record always plays the same game.
+*
+* @param record The scenario, e.g. from ScenarioFile_at; it must have room for its packs
+* @param game Receives the game, free it with Game_free
+* @param rng Generator of the game, it must live as long as the game
+* @return ok, illegalCard if the record is NULL or invalid, noMemory if allocation fails
+*/
+deckError Scenario_newGame(const ScenarioRecord* record, Game* game, Rng* rng) {
+	if (record == NULL) return illegalCard;
+	int counts[4] = { record->hiddenCount, record->p1Count, record->p2Count, record->playedCount };
+	if (counts[0] + counts[1] + counts[2] + counts[3] > record->packs * PACK_SIZE || record->turn > 1) return illegalCard;
+	for (int c = 0; c < counts[0] + counts[1] + counts[2] + counts[3]; c++) {
+		if (record->cards[c] >= PACK_SIZE) return illegalCard;
+	}
+
+	Rng_seedLazy(rng, record->seed); // most replays never shuffle, so only seed on the first draw
+	deckError err = Game_initDecks(game, rng);
+	if (err != ok) return err;
+	game->turn = record->turn;
+
+	CardDeck* decks[3] = { &game->hidden, &game->p1, &game->p2 };
+	int used = 0;
+	for (int d = 0; d < 3 && err == ok; d++) {
+		err = CardDeck_insertPackedAfter(decks[d], record->cards + used, counts[d]);
+		decks[d]->current = decks[d]->head;
+		used += counts[d];
+	}
+	for (int i = counts[3] - 1; i >= 0 && err == ok; i--) {
+		err = PlayedPile_push(&game->played, Card_unpack(record->cards[used + i]));
+	}
+	if (err != ok) Game_free(game);
+	else Game_recordShoe(game);
+	return err;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file Scenario.h
+ * Provides interface for scenario files: fixed game layouts for replaying.
+ *
+ * A scenario is the exact state a game starts from: the order of the
+ * hidden deck, both hands, the played deck, the player to move and the
+ * seed for any later reshuffle. A scenario file is a ScenarioFileHeader
+ * followed by ScenarioRecords of one size, so record i is found without
+ * reading the ones before it.
+ *
+ * All records of a file hold games of up to the same number of packs,
+ * stored in the header. A record has room for that many packs of cards,
+ * Scenario_recordSize(packs) bytes, so files of one-pack games stay small
+ * and games of up to SCENARIO_MAX_PACKS packs can be saved as well.
+ * Arrays of records are indexed with ScenarioRecord_at.
+ *
+ * ScenarioFile_open maps the file into memory instead of reading it, and
+ * ScenarioFile_at returns a pointer into the mapping, so nothing is copied
+ * or parsed. Scenario_newGame copies the packed cards of a record straight
+ * into the game's decks.
+ *
+ * Numbers are stored in the byte order of the machine that wrote the file;
+ * a file from a machine with the other byte order fails the magic check.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Card.h"
+#include "CardDeck.h"
+#include "game.h"
+#include "Rng.h"
+
+#define SCENARIO_MAGIC 0x4E435343u // "CSCN" when read as little endian
+#define SCENARIO_VERSION 2
+#define SCENARIO_MAX_PACKS 255 // most packs a record has room for, packs is one byte
+
+typedef struct {
+	uint32_t magic; // SCENARIO_MAGIC
+	uint16_t version; // SCENARIO_VERSION
+	uint16_t recordSize; // Scenario_recordSize(packs)
+	uint32_t count; // number of records
+	uint32_t packs; // packs every record has room for
+} ScenarioFileHeader;
+
+typedef struct {
+	uint64_t seed; // seed of the game's generator, used when the hidden deck is recycled
+	uint16_t hiddenCount; // cards of the hidden deck
+	uint16_t p1Count; // cards of player 1
+	uint16_t p2Count; // cards of player 2
+	uint16_t playedCount; // cards of the played deck
+	uint8_t turn; // player to move, 0 or 1
+	uint8_t packs; // room of cards, in packs
+	uint8_t reserved[6]; // 0
+	PackedCard cards[]; // packs * PACK_SIZE: hidden, p1, p2 then played, each deck top card first, then 0
+} ScenarioRecord;
+
+_Static_assert(sizeof(ScenarioFileHeader) == 16, "ScenarioFileHeader must have no padding");
+_Static_assert(sizeof(ScenarioRecord) == 24, "ScenarioRecord must have no padding");
+
+/**
+* Returns the size of a record with room for packs packs, a multiple of 8
+* so records following each other stay aligned.
+*/
+static inline size_t Scenario_recordSize(int packs) {
+	return (sizeof(ScenarioRecord) + (size_t)packs * PACK_SIZE + 7) & ~(size_t)7;
+}
+
+/**
+* Returns record index of an array of records with room for packs packs each.
+*/
+static inline ScenarioRecord* ScenarioRecord_at(void* records, int packs, int index) {
+	return (ScenarioRecord*)((unsigned char*)records + (size_t)index * Scenario_recordSize(packs));
+}
+
+typedef struct {
+	const ScenarioRecord* records; // the records inside the mapping
+	int count; // number of records
+	int packs; // packs every record has room for
+	void* mapping; // start of the mapped file
+	size_t size; // length of the mapping
+#ifdef _WIN32
+	void* file; // HANDLE of the file
+	void* view; // HANDLE of the file mapping
+#endif
+} ScenarioFile;
+
+ScenarioFile* ScenarioFile_open(const char* path);
+void ScenarioFile_close(ScenarioFile* file);
+const ScenarioRecord* ScenarioFile_at(const ScenarioFile* file, int index);
+int ScenarioFile_write(const char* path, const ScenarioRecord* records, int count, int packs);
+
+deckError Scenario_capture(const Game* game, uint64_t seed, int packs, ScenarioRecord* record);
+deckError Scenario_newGame(const ScenarioRecord* record, Game* game, Rng* rng);
+
+#endif
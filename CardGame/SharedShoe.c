@@ -0,0 +1,199 @@
+/**
+* @file SharedShoe.c
+* Implementation of the shoe shared by several game threads.
+*
+* The whole shoe state is one 64-bit word: the generation (how often the
+* shoe has been reshuffled) and the index of the next card. A draw claims
+* cards with a compare-and-swap on that word, so a claim can never mix two
+* generations, and cards are copied out of the buffer of the generation
+* they were claimed in.
+*
+* Generation g uses buffers[g & 1]. Preparing generation g + 1 overwrites
+* the buffer of generation g - 1, whose last readers may still be copying.
+* A reader announces itself in readers[] of the buffer of the generation it
+* saw before its claim, and leaves after the copy. The reshuffler runs only
+* once generation g is exhausted: it first waits for readers[] of the old
+* buffer to drop to zero, then shuffles into it and only then stores
+* generation g + 1. A reader that still counts itself on the old buffer
+* after that wait saw generation g - 1, and its claim fails because the
+* shoe is at generation g already, so it copies nothing. All of this uses
+* sequentially consistent atomics.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <threads.h>
+#include "SharedShoe.h"
+
+#define SHAREDSHOE_STATE(generation, next) (((uint64_t)(generation) << 32) | (uint32_t)(next))
+#define SHAREDSHOE_GENERATION(state) ((uint32_t)((state) >> 32))
+#define SHAREDSHOE_NEXT(state) ((uint32_t)(state))
+
+/**
+* @brief Creates a shared shoe holding the cards of a deck
+* @details The first generation deals the cards in the deck's order, so the
+* deck is normally shuffled first. Every later generation is a fresh shuffle
+* of the same cards. The deck itself is only read.
+*
+* @param deck Deck to copy the cards from, must not be empty
+* @param seed Seed for the reshuffles
+* @return Pointer to the new shoe, NULL if the deck is empty or allocation fails
+*/
+SharedShoe* SharedShoe_create(const CardDeck* deck, uint64_t seed) {
+	if (deck == NULL) return NULL;
+	int size = CardDeck_count(deck);
+	if (size <= 0) return NULL;
+
+	SharedShoe* shoe = (SharedShoe*)malloc(sizeof(SharedShoe));
+	if (shoe == NULL) return NULL;
+	shoe->buffers[0] = (PackedCard*)malloc((size_t)size);
+	shoe->buffers[1] = (PackedCard*)malloc((size_t)size);
+	if (shoe->buffers[0] == NULL || shoe->buffers[1] == NULL) {
+		free(shoe->buffers[0]);
+		free(shoe->buffers[1]);
+		free(shoe);
+		return NULL;
+	}
+
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		shoe->buffers[0][it.index - 1] = Card_pack(*card);
+	}
+
+	shoe->size = size;
+	atomic_init(&shoe->state, SHAREDSHOE_STATE(0, 0));
+	atomic_init(&shoe->readers[0], 0);
+	atomic_init(&shoe->readers[1], 0);
+	atomic_flag_clear(&shoe->reshuffling);
+	Rng_seed(&shoe->rng, seed);
+	return shoe;
+}
+
+/**
+* @brief Frees a shared shoe
+* @details No thread may be drawing from the shoe any more.
+*
+* @param shoe Pointer to the shoe, NULL is allowed
+*/
+void SharedShoe_delete(SharedShoe* shoe) {
+	if (shoe == NULL) return;
+	free(shoe->buffers[0]);
+	free(shoe->buffers[1]);
+	free(shoe);
+}
+
+/**
+* Moves the shoe from an exhausted generation to the next one. One caller
+* does the work, every other caller waits until it is done.
+*/
+static void SharedShoe_reshuffle(SharedShoe* shoe, uint32_t generation) {
+	if (atomic_flag_test_and_set(&shoe->reshuffling)) {
+		while (SHAREDSHOE_GENERATION(atomic_load(&shoe->state)) == generation) {
+			thrd_yield();
+		}
+		return;
+	}
+
+	// another thread may have finished this reshuffle before we got the flag
+	if (SHAREDSHOE_GENERATION(atomic_load(&shoe->state)) == generation) {
+		int target = (generation + 1) & 1;
+		while (atomic_load(&shoe->readers[target]) > 0) {
+			thrd_yield();
+		}
+
+		// the buffer already holds every card of the shoe, in the order of generation - 1
+		PackedCard* cards = shoe->buffers[target];
+		if (generation == 0) {
+			for (int i = 0; i < shoe->size; i++) cards[i] = shoe->buffers[0][i];
+		}
+		for (int i = shoe->size - 1; i > 0; i--) {
+			int pos = (int)Rng_bounded(&shoe->rng, (uint32_t)i + 1);
+			PackedCard temp = cards[i];
+			cards[i] = cards[pos];
+			cards[pos] = temp;
+		}
+
+		atomic_store(&shoe->state, SHAREDSHOE_STATE(generation + 1, 0));
+	}
+	atomic_flag_clear(&shoe->reshuffling);
+}
+
+/**
+* @brief Draws the next cards from the shoe
+* @details Claims up to count consecutive cards without locking. All claimed
+* cards come from the same generation, so fewer than count cards are returned
+* when the shoe runs out in the middle; the next call reshuffles. Safe to call
+* from any number of threads.
+*
+* @param shoe Pointer to the shoe
+* @param cards Array receiving the cards in draw order
+* @param count Maximum number of cards to draw
+* @return Number of cards drawn, between 1 and count, 0 if the arguments are invalid
+*/
+int SharedShoe_drawBatch(SharedShoe* shoe, Card* cards, int count) {
+	if (shoe == NULL || cards == NULL || count <= 0) return 0;
+
+	for (;;) {
+		uint64_t state = atomic_load(&shoe->state);
+		uint32_t generation = SHAREDSHOE_GENERATION(state);
+		uint32_t next = SHAREDSHOE_NEXT(state);
+		if (next >= (uint32_t)shoe->size) {
+			SharedShoe_reshuffle(shoe, generation);
+			continue;
+		}
+
+		int buffer = generation & 1;
+		atomic_fetch_add(&shoe->readers[buffer], 1);
+		int claimed = 0;
+		for (;;) {
+			uint32_t left = (uint32_t)shoe->size - next;
+			claimed = left < (uint32_t)count ? (int)left : count;
+			if (atomic_compare_exchange_weak(&shoe->state, &state, state + (uint32_t)claimed)) break;
+
+			// lost the race: retry within the same generation while it has cards left
+			next = SHAREDSHOE_NEXT(state);
+			if (SHAREDSHOE_GENERATION(state) != generation || next >= (uint32_t)shoe->size) {
+				claimed = 0;
+				break;
+			}
+		}
+
+		if (claimed > 0) {
+			const PackedCard* source = shoe->buffers[buffer] + next;
+			for (int i = 0; i < claimed; i++) {
+				cards[i] = Card_unpack(source[i]);
+			}
+		}
+		atomic_fetch_sub(&shoe->readers[buffer], 1);
+		if (claimed > 0) return claimed;
+	}
+}
+
+/**
+* @brief Draws one card from the shoe
+*
+* @param shoe Pointer to the shoe
+* @param card Receives the card
+* @return ok, or illegalCard if the arguments are invalid
+*/
+deckError SharedShoe_draw(SharedShoe* shoe, Card* card) {
+	return SharedShoe_drawBatch(shoe, card, 1) == 1 ? ok : illegalCard;
+}
+
+/**
+* @brief Returns how often the shoe has been reshuffled
+*/
+uint32_t SharedShoe_generation(SharedShoe* shoe) {
+	return SHAREDSHOE_GENERATION(atomic_load(&shoe->state));
+}
+
+/**
+* @brief Returns the number of cards left before the next reshuffle
+* @details Only a snapshot while other threads are drawing.
+*/
+int SharedShoe_remaining(SharedShoe* shoe) {
+	uint32_t next = SHAREDSHOE_NEXT(atomic_load(&shoe->state));
+	return next >= (uint32_t)shoe->size ? 0 : shoe->size - (int)next;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file SharedShoe.h
+ * Provides interface for a shoe that many game threads draw from at once.
+ *
+ * A SharedShoe is a multi-pack shoe for several tables running on their
+ * own threads. Instead of a mutex around CardDeck_useTop, the cards sit in
+ * an array and a draw claims the next cards by advancing one atomic word,
+ * so tables never wait for each other while the shoe has cards left.
+ *
+ * The shoe has two card buffers. When the current one runs dry, exactly
+ * one drawing thread becomes the reshuffler: it shuffles a fresh copy of
+ * the shoe into the other buffer and then switches to it, while the other
+ * threads wait for the switch. Before a buffer is overwritten the
+ * reshuffler waits until no thread is still copying cards out of it.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SHAREDSHOE_H
+#define SHAREDSHOE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "Card.h"
+#include "CardDeck.h"
+#include "Rng.h"
+
+typedef struct {
+	PackedCard* buffers[2]; // the shoe of even and odd generations
+	int size; // cards in the shoe
+	_Atomic(uint64_t) state; // generation in the high 32 bits, next card to draw in the low 32
+	atomic_int readers[2]; // threads copying cards out of each buffer
+	atomic_flag reshuffling; // held by the thread preparing the next generation
+	Rng rng; // used by the reshuffler only
+} SharedShoe;
+
+SharedShoe* SharedShoe_create(const CardDeck* deck, uint64_t seed);
+void SharedShoe_delete(SharedShoe* shoe);
+
+int SharedShoe_drawBatch(SharedShoe* shoe, Card* cards, int count);
+deckError SharedShoe_draw(SharedShoe* shoe, Card* card);
+uint32_t SharedShoe_generation(SharedShoe* shoe);
+int SharedShoe_remaining(SharedShoe* shoe);
+
+#endif
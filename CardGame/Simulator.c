@@ -0,0 +1,351 @@
+/**
+* @file Simulator.c
+* Implementation of the many-games simulator.
+*
+* The interleaved runner splits Game_playTurn into steps that each touch
+* at most one node that may not be cached yet, and prefetches that node one
+* step ahead. The scan is the same first-match scan as CardDeck_findMatch,
+* and the move itself is Game_finishTurn, so the games play exactly as
+* they would with Game_playTurn. Games with rules other than the standard
+* ones, or a strategy other than first match, pick their card in one step
+* with Game_chooseMatch.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <threads.h>
+#include "Simulator.h"
+#include "Trace.h"
+
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#define SIM_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define SIM_PREFETCH(p) __builtin_prefetch(p)
+#endif
+
+/**
+* @brief Creates numGames games, each dealt from its own shuffled shoe
+* @details Game i shuffles with stream i of seed (see Rng_seedStream), so
+* two simulators created with the same arguments play the same games.
+*
+* @param numGames Number of games
+* @param numPacks Packs in the shoe of every game
+* @param seed Seed shared by the streams of all games
+* @param maxTurns Turn limit of every game
+* @return Pointer to the new simulator, NULL if allocation fails
+*/
+Simulator* Simulator_create(int numGames, int numPacks, uint64_t seed, int maxTurns) {
+	return Simulator_createRange(0, numGames, numPacks, seed, maxTurns);
+}
+
+/**
+* @brief Creates games firstGame to firstGame + numGames - 1 of a simulation
+* @details Game firstGame + i of the new simulator is dealt and played
+* exactly like that game of a simulator that holds all games, so any part
+* of a simulation can be replayed on its own or given to another thread.
+*
+* @param firstGame Number of the first game, which uses stream firstGame of seed
+* @param numGames Number of games
+* @param numPacks Packs in the shoe of every game
+* @param seed Seed shared by the streams of all games
+* @param maxTurns Turn limit of every game
+* @return Pointer to the new simulator, NULL if allocation fails
+*/
+Simulator* Simulator_createRange(uint64_t firstGame, int numGames, int numPacks, uint64_t seed, int maxTurns) {
+	if (numGames <= 0 || numPacks <= 0) return NULL;
+	Simulator* sim = (Simulator*)malloc(sizeof(Simulator));
+	if (sim == NULL) return NULL;
+	sim->games = (SimGame*)malloc((size_t)numGames * sizeof(SimGame));
+	sim->rngs = (Rng*)malloc((size_t)numGames * sizeof(Rng));
+	sim->count = 0;
+	sim->maxTurns = maxTurns;
+	if (sim->games == NULL || sim->rngs == NULL) {
+		Simulator_delete(sim);
+		return NULL;
+	}
+
+	for (int i = 0; i < numGames; i++) {
+		Rng_seedStream(&sim->rngs[i], seed, firstGame + (uint64_t)i);
+		if (Game_init(&sim->games[i].game, numPacks, &sim->rngs[i]) != ok) {
+			Simulator_delete(sim);
+			return NULL;
+		}
+		sim->games[i].step = simTurnStart;
+		sim->games[i].turns = 0;
+		sim->count++;
+	}
+	return sim;
+}
+
+/**
+* @brief Frees a simulator and all its games
+*
+* @param sim Pointer to the simulator, NULL is allowed
+*/
+void Simulator_delete(Simulator* sim) {
+	if (sim == NULL) return;
+	for (int i = 0; i < sim->count; i++) {
+		Game_free(&sim->games[i].game);
+	}
+	free(sim->games);
+	free(sim->rngs);
+	free(sim);
+}
+
+/**
+* Returns whether a game is over after its last turn.
+*/
+static int Simulator_isOver(const Simulator* sim, const SimGame* game) {
+	return game->game.status == win || game->turns >= sim->maxTurns;
+}
+
+/**
+* @brief Plays every game to the end, one game after the other
+*
+* @param sim Pointer to the simulator
+* @return Number of turns played
+*/
+long long Simulator_runSequential(Simulator* sim) {
+	long long turns = 0;
+	for (int i = 0; i < sim->count; i++) {
+		SimGame* game = &sim->games[i];
+		while (game->step != simDone) {
+			if (Simulator_isOver(sim, game)) {
+				game->step = simDone;
+				break;
+			}
+			Game_playTurn(&game->game);
+			game->turns++;
+			turns++;
+		}
+	}
+	return turns;
+}
+
+typedef struct {
+	Simulator* sim;
+	int begin; // first game of this thread
+	int end; // one past the last game
+	long long turns; // turns this thread played
+} SimWorker;
+
+/**
+* Plays the games of one worker to the end, one after the other.
+*/
+static int Simulator_runWorker(void* arg) {
+	SimWorker* worker = (SimWorker*)arg;
+	Simulator part = *worker->sim;
+	part.games += worker->begin;
+	part.rngs += worker->begin;
+	part.count = worker->end - worker->begin;
+	worker->turns = Simulator_runSequential(&part);
+	return 0;
+}
+
+/**
+* Runs a worker on a thread of its own, named in traces.
+*/
+static int Simulator_workerThread(void* arg) {
+	TRACE_THREAD_NAME("simulator worker");
+	TRACE_SCOPE(Simulator_workerThread);
+	return Simulator_runWorker(arg);
+}
+
+/**
+* @brief Plays every game to the end on numThreads threads
+* @details Every game has its own generator and decks, so the games do not
+* depend on each other and the results are the same as with
+* Simulator_runSequential(), for any number of threads. The calling
+* thread plays the first share; a share whose thread cannot be started
+* is played on the calling thread as well.
+*
+* @param sim Pointer to the simulator
+* @param numThreads Threads to use, 1 to CARDDECK_MAX_THREADS
+* @return Number of turns played
+*/
+long long Simulator_runParallel(Simulator* sim, int numThreads) {
+	if (numThreads < 1) numThreads = 1;
+	if (numThreads > CARDDECK_MAX_THREADS) numThreads = CARDDECK_MAX_THREADS;
+	if (numThreads > sim->count) numThreads = sim->count > 0 ? sim->count : 1;
+
+	SimWorker workers[CARDDECK_MAX_THREADS];
+	thrd_t threads[CARDDECK_MAX_THREADS];
+	int started[CARDDECK_MAX_THREADS];
+	for (int t = 0; t < numThreads; t++) {
+		workers[t].sim = sim;
+		workers[t].begin = (int)((long long)sim->count * t / numThreads);
+		workers[t].end = (int)((long long)sim->count * (t + 1) / numThreads);
+		workers[t].turns = 0;
+	}
+
+	for (int t = 1; t < numThreads; t++) {
+		started[t] = thrd_create(&threads[t], Simulator_workerThread, &workers[t]) == thrd_success;
+	}
+	Simulator_runWorker(&workers[0]);
+	long long turns = workers[0].turns;
+	for (int t = 1; t < numThreads; t++) {
+		if (started[t]) {
+			thrd_join(threads[t], NULL);
+		}
+		else {
+			Simulator_runWorker(&workers[t]);
+		}
+		turns += workers[t].turns;
+	}
+	return turns;
+}
+
+/**
+* @brief Plays one turn of every game per round until all games are over
+* @details This is how games that advance together (e.g. on a shared clock)
+* are played without interleaving: each turn runs to its end before the
+* next game gets its turn.
+*
+* @param sim Pointer to the simulator
+* @return Number of turns played
+*/
+long long Simulator_runLockstep(Simulator* sim) {
+	long long turns = 0;
+	long long played;
+	do {
+		played = 0;
+		for (int i = 0; i < sim->count; i++) {
+			SimGame* game = &sim->games[i];
+			if (game->step == simDone) continue;
+			if (Simulator_isOver(sim, game)) {
+				game->step = simDone;
+				continue;
+			}
+			Game_playTurn(&game->game);
+			game->turns++;
+			played++;
+		}
+		turns += played;
+	} while (played > 0);
+	return turns;
+}
+
+/**
+* Finishes the current turn of a game with the scan result.
+*/
+static void Simulator_finishTurn(const Simulator* sim, SimGame* game, int matchIndex) {
+	Game_finishTurn(&game->game, matchIndex);
+	game->turns++;
+	game->step = Simulator_isOver(sim, game) ? simDone : simTurnStart;
+}
+
+/**
+* Advances a game by one step. Every step ends with a prefetch of what the
+* next step of this game will read.
+*/
+static void Simulator_step(const Simulator* sim, SimGame* game) {
+	switch (game->step) {
+	case simTurnStart: {
+		const CardDeck* hand = game->game.turn == 0 ? &game->game.p1 : &game->game.p2;
+		SIM_PREFETCH(hand->head);
+		game->step = simTurnLoad;
+		break;
+	}
+	case simTurnLoad: {
+		game->hand = CardDeck_iter(game->game.turn == 0 ? &game->game.p1 : &game->game.p2);
+		game->top = PlayedPile_top(&game->game.played);
+		if (game->top == NULL) {
+			Simulator_finishTurn(sim, game, -1); // nothing to match against
+			break;
+		}
+		if (game->game.rules != rulesStandard || game->game.strategy != strategyFirstMatch) {
+			Simulator_finishTurn(sim, game, Game_chooseMatch(&game->game)); // other rules and strategies pick in one step
+			break;
+		}
+		if (game->hand.node != NULL) SIM_PREFETCH(game->hand.node);
+		game->step = simTurnScan;
+		break;
+	}
+	case simTurnScan: {
+		const CardNode* node = game->hand.node;
+		if (node == NULL) {
+			Simulator_finishTurn(sim, game, -1);
+			break;
+		}
+		if (Rules_matchStandard(&node->card, game->top)) {
+			Simulator_finishTurn(sim, game, game->hand.index);
+			break;
+		}
+		game->hand.node = node->successor;
+		game->hand.index++;
+		if (game->hand.node != NULL) SIM_PREFETCH(game->hand.node);
+		break;
+	}
+	case simDone:
+		break;
+	}
+}
+
+/**
+* Returns the next game from *nextGame on that is not over yet, NULL if none is left.
+*/
+static SimGame* Simulator_nextGame(Simulator* sim, int* nextGame) {
+	while (*nextGame < sim->count) {
+		SimGame* game = &sim->games[(*nextGame)++];
+		if (Simulator_isOver(sim, game)) game->step = simDone;
+		if (game->step != simDone) return game;
+	}
+	return NULL;
+}
+
+/**
+* Returns the number of turns all games have played so far.
+*/
+static long long Simulator_totalTurns(const Simulator* sim) {
+	long long turns = 0;
+	for (int i = 0; i < sim->count; i++) {
+		turns += sim->games[i].turns;
+	}
+	return turns;
+}
+
+/**
+* @brief Plays one turn of every game per round, width turns at a time
+* @details Plays the same rounds as Simulator_runLockstep(), but the turns
+* of a round are interleaved: width games are in flight and take one step
+* each in turn. When a game's turn is over, the next game of the round
+* takes its place. A window of 8 to 32 games is enough to overlap the
+* cache misses; much wider windows evict the prefetched nodes again before
+* they are used.
+*
+* @param sim Pointer to the simulator
+* @param width Games in flight at once, 0 or less (or more than there are) runs all games at once
+* @return Number of turns played, -1 if allocation fails
+*/
+long long Simulator_runInterleaved(Simulator* sim, int width) {
+	if (width <= 0 || width > sim->count) width = sim->count;
+	SimGame** slots = (SimGame**)malloc((size_t)width * sizeof(SimGame*));
+	if (slots == NULL) return -1;
+
+	long long before = Simulator_totalTurns(sim);
+	for (;;) {
+		int nextGame = 0;
+		int active = 0;
+		while (active < width && (slots[active] = Simulator_nextGame(sim, &nextGame)) != NULL) {
+			active++;
+		}
+		if (active == 0) break; // every game is over
+
+		while (active > 0) {
+			for (int s = 0; s < active; ) {
+				Simulator_step(sim, slots[s]);
+				if (slots[s]->step == simTurnLoad || slots[s]->step == simTurnScan) {
+					s++; // turn still going
+				}
+				else if ((slots[s] = Simulator_nextGame(sim, &nextGame)) == NULL) {
+					slots[s] = slots[--active]; // nothing left in this round, shrink the window
+				}
+			}
+		}
+	}
+
+	free(slots);
+	return Simulator_totalTurns(sim) - before;
+}
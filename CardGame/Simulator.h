@@ -0,0 +1,63 @@
+/**
+ * @file Simulator.h
+ * Provides interface for running many games on one thread.
+ *
+ * A turn is little work and a lot of waiting: scanning a hand chases one
+ * CardNode pointer per card, and with thousands of games most of those
+ * nodes are not in the cache. Simulator_runInterleaved() therefore runs a
+ * window of games round-robin as small state machines. Every step of a
+ * game issues a prefetch for the node it needs next and then hands over
+ * to the next game, so the cache misses of different games overlap
+ * instead of being waited out one after the other.
+ *
+ * All run functions play exactly the same turns, so the interleaved one
+ * can be checked against Simulator_runSequential() and compared with
+ * Simulator_runLockstep(), which gives every game one turn per round.
+ *
+ * Game i always shuffles with stream i of the simulator's seed, so the
+ * results do not depend on how the games are split over threads
+ * (Simulator_runParallel) or which of them are played at all
+ * (Simulator_createRange).
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include "game.h"
+#include "Rng.h"
+
+typedef enum { // where a game continues on its next step
+	simTurnStart, // prefetch the head node of the hand
+	simTurnLoad, // read the first hand node and the top played card, prefetch the first card node
+	simTurnScan, // compare one hand card with the top played card
+	simDone // the game is won or reached the turn limit
+} SimStep;
+
+typedef struct {
+	Game game;
+	SimStep step; // next step of this game
+	CardDeckIter hand; // scan position in the hand of the player to move
+	const Card* top; // top played card during the scan
+	int turns; // turns played so far
+} SimGame;
+
+typedef struct {
+	SimGame* games; // all games
+	Rng* rngs; // generator of each game, only used when a deck is shuffled
+	int count; // number of games
+	int maxTurns; // a game stops after this many turns even without a winner
+} Simulator;
+
+Simulator* Simulator_create(int numGames, int numPacks, uint64_t seed, int maxTurns);
+Simulator* Simulator_createRange(uint64_t firstGame, int numGames, int numPacks, uint64_t seed, int maxTurns);
+void Simulator_delete(Simulator* sim);
+
+long long Simulator_runSequential(Simulator* sim);
+long long Simulator_runParallel(Simulator* sim, int numThreads);
+long long Simulator_runLockstep(Simulator* sim);
+long long Simulator_runInterleaved(Simulator* sim, int width);
+
+#endif
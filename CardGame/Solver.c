@@ -0,0 +1,383 @@
+/**
+* @file Solver.c
+* Implementation of the endgame solver.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "Solver.h"
+#include "bench.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define SOLVER_ALL ((1ull << PACK_SIZE) - 1) // every card of the pack
+#define SOLVER_TOP_SHIFT PACK_SIZE // the top card sits above the hidden cards in the third key word
+#define SOLVER_RULES_SHIFT (PACK_SIZE + 6) // and the rule variant above the top card
+#define SOLVER_VALUE_ONE 0xFFFFFFFFull // a win chance of 1 in the table
+#define SOLVER_VALID (1ull << 63) // set in every stored data word, so an empty entry never matches
+
+/*
+* Data word of a table entry:
+* bits 0..31 win chance of the player to move, in units of 1 / SOLVER_VALUE_ONE
+* bits 32..47 turns searched below the position
+* bit 48 exact
+* bits 49..54 best card, 63 for a draw
+* bit 63 SOLVER_VALID
+*/
+
+typedef struct {
+	SolverTable* table;
+	SolverStats* stats;
+	const uint64_t* match; // matchMask of the rule variant
+	uint64_t rules; // rule variant, shifted into place for the key
+} SolverSearch;
+
+typedef struct {
+	double value; // win chance of the player to move
+	int exact;
+} SolverValue;
+
+static uint64_t matchMask[rulesCount][PACK_SIZE]; // cards that may be played on each top card, per rule variant
+static once_flag matchOnce = ONCE_FLAG_INIT;
+
+/**
+* Fills matchMask, once.
+*/
+static void Solver_buildMasks(void) {
+	for (int rules = 0; rules < rulesCount; rules++) {
+		for (int top = 0; top < PACK_SIZE; top++) {
+			for (int c = 0; c < PACK_SIZE; c++) {
+				if (Rules_matches((RuleVariant)rules, &orderedPack[c], &orderedPack[top])) {
+					matchMask[rules][top] |= 1ull << c;
+				}
+			}
+		}
+	}
+}
+
+/**
+* Number of set bits, i.e. cards in a set.
+*/
+static inline int Solver_count(uint64_t cards) {
+#if defined(__GNUC__)
+	return __builtin_popcountll(cards);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(cards); // needs the POPCNT instruction, which every x64 processor of the last 15 years has
+#else
+	int count = 0;
+	for (; cards != 0; cards &= cards - 1) count++;
+	return count;
+#endif
+}
+
+/**
+* Index of the lowest card in a set that is not empty.
+*/
+static inline int Solver_lowest(uint64_t cards) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(cards);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, cards);
+	return (int)index;
+#else
+	int index = 0;
+	while ((cards & 1) == 0) {
+		cards >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+/**
+* @brief Creates an empty transposition table
+*
+* @param bits The table has 2^bits entries of 32 bytes each, 1 to 40
+* @return The table, or NULL if bits is out of range or allocation fails
+*/
+SolverTable* SolverTable_create(int bits) {
+	if (bits < 1 || bits > 40) return NULL;
+	SolverTable* table = (SolverTable*)malloc(sizeof(SolverTable));
+	if (table == NULL) return NULL;
+	size_t count = (size_t)1 << bits;
+	table->entries = (SolverEntry*)calloc(count, sizeof(SolverEntry));
+	if (table->entries == NULL) {
+		free(table);
+		return NULL;
+	}
+	table->mask = count - 1;
+	return table;
+}
+
+/**
+* @brief Frees a transposition table
+*
+* @param table The table, may be NULL
+*/
+void SolverTable_delete(SolverTable* table) {
+	if (table == NULL) return;
+	free(table->entries);
+	free(table);
+}
+
+/**
+* @brief Forgets every stored position, no thread may use the table meanwhile
+*
+* @param table The table
+*/
+void SolverTable_clear(SolverTable* table) {
+	memset(table->entries, 0, (size_t)(table->mask + 1) * sizeof(SolverEntry));
+}
+
+/**
+* Adds one card to a state, failing if it already holds the card.
+*/
+static deckError Solver_addCard(uint64_t* seen, uint64_t* set, Card card) {
+	if (card.suit < CLUB || card.suit > DIAMOND || card.rank < TWO || card.rank > ACE) return illegalCard;
+	uint64_t bit = 1ull << Card_pack(card);
+	if (*seen & bit) return illegalCard;
+	*seen |= bit;
+	*set |= bit;
+	return ok;
+}
+
+/**
+* Adds every card of a deck to a state.
+*/
+static deckError Solver_addDeck(uint64_t* seen, uint64_t* set, const CardDeck* deck) {
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		deckError err = Solver_addCard(seen, set, *card);
+		if (err != ok) return err;
+	}
+	return ok;
+}
+
+/**
+* @brief Reads the position of a game played with one pack
+* @details Cards that are neither in a hand, in the hidden deck nor on top
+* of the played pile are taken to be below the top card.
+*
+* @param game The game, it is only read
+* @param state Receives the position
+* @return ok, or illegalCard if a card is there twice or the played pile is empty
+*/
+deckError Solver_stateFromGame(const Game* game, SolverState* state) {
+	memset(state, 0, sizeof(*state));
+	if (PlayedPile_count(&game->played) == 0) return illegalCard;
+	uint64_t seen = 0;
+	uint64_t played = 0;
+	deckError err = Solver_addDeck(&seen, &state->hand[0], &game->p1);
+	if (err == ok) err = Solver_addDeck(&seen, &state->hand[1], &game->p2);
+	if (err == ok) err = Solver_addDeck(&seen, &state->hidden, &game->hidden);
+	if (err == ok) err = Solver_addCard(&seen, &played, *PlayedPile_top(&game->played));
+	for (int i = 0; err == ok && i < game->played.count - 1; i++) {
+		err = Solver_addCard(&seen, &played, Card_unpack(game->played.cards[i]));
+	}
+	state->top = game->played.top;
+	state->turn = game->turn;
+	state->rules = game->rules;
+	return err;
+}
+
+/**
+* @brief Plays a card from the hand of the player to move
+* @details To grade another way of picking a card, compare the win chance
+* of Solver_solve with 1 minus the win chance of the position after this
+* card, which is a chance for the other player.
+*
+* @param state The position
+* @param card Packed card to play
+* @param next Receives the position after the card, the other player is to move
+* @return ok, or illegalCard if the player does not hold the card or it does not match the top card
+*/
+deckError Solver_play(const SolverState* state, int card, SolverState* next) {
+	call_once(&matchOnce, Solver_buildMasks);
+	if (card < 0 || card >= PACK_SIZE || state->top < 0 || state->top >= PACK_SIZE || state->rules < 0 || state->rules >= rulesCount) {
+		return illegalCard;
+	}
+	uint64_t bit = 1ull << card;
+	if ((state->hand[state->turn] & bit & matchMask[state->rules][state->top]) == 0) return illegalCard;
+	*next = *state;
+	next->hand[state->turn] &= ~bit;
+	next->top = card;
+	next->turn = 1 - state->turn;
+	return ok;
+}
+
+/**
+* Mixes the three key words into a table index.
+*/
+static inline uint64_t Solver_hash(uint64_t mine, uint64_t theirs, uint64_t rest) {
+	uint64_t h = mine * 0x9e3779b97f4a7c15ull;
+	h ^= theirs + 0x632be59bd9b4e019ull + (h << 6) + (h >> 2);
+	h ^= rest * 0xc2b2ae3d27d4eb4full;
+	return h ^ (h >> 29);
+}
+
+/**
+* Looks a position up, returns 1 and fills value and best if a usable entry is found.
+*/
+static int Solver_probe(SolverSearch* search, const uint64_t key[3], int depth, SolverValue* value, int* best) {
+	search->stats->probes++;
+	SolverEntry* entry = &search->table->entries[Solver_hash(key[0], key[1], key[2]) & search->table->mask];
+	uint64_t data = atomic_load_explicit(&entry->words[3], memory_order_relaxed);
+	if ((data & SOLVER_VALID) == 0) return 0;
+	for (int i = 0; i < 3; i++) {
+		if ((atomic_load_explicit(&entry->words[i], memory_order_relaxed) ^ data) != key[i]) return 0;
+	}
+	int exact = (int)((data >> 48) & 1);
+	int searched = (int)((data >> 32) & 0xFFFF);
+	if (!exact && searched < depth) return 0; // searched too shallow to be used here
+	value->value = (double)(data & SOLVER_VALUE_ONE) / (double)SOLVER_VALUE_ONE;
+	value->exact = exact;
+	int card = (int)((data >> 49) & 63);
+	*best = card == 63 ? SOLVER_DRAW : card;
+	search->stats->hits++;
+	return 1;
+}
+
+/**
+* Stores a position, replacing whatever was in its entry.
+*/
+static void Solver_store(SolverSearch* search, const uint64_t key[3], int depth, SolverValue value, int best) {
+	SolverEntry* entry = &search->table->entries[Solver_hash(key[0], key[1], key[2]) & search->table->mask];
+	uint64_t data = SOLVER_VALID
+		| (uint64_t)(best == SOLVER_DRAW ? 63 : best) << 49
+		| (uint64_t)(value.exact != 0) << 48
+		| (uint64_t)(depth > 0xFFFF ? 0xFFFF : depth) << 32
+		| (uint64_t)(value.value * (double)SOLVER_VALUE_ONE + 0.5);
+	for (int i = 0; i < 3; i++) {
+		atomic_store_explicit(&entry->words[i], key[i] ^ data, memory_order_relaxed);
+	}
+	atomic_store_explicit(&entry->words[3], data, memory_order_relaxed);
+}
+
+static SolverValue Solver_search(SolverSearch* search, uint64_t mine, uint64_t theirs, uint64_t hidden, int top, int depth, int* best);
+
+/**
+* Value for the player to move of handing the turn over to the other player.
+*/
+static inline SolverValue Solver_handOver(SolverSearch* search, uint64_t mine, uint64_t theirs, uint64_t hidden, int top, int depth) {
+	int unused;
+	SolverValue child = Solver_search(search, theirs, mine, hidden, top, depth - 1, &unused);
+	child.value = 1.0 - child.value;
+	return child;
+}
+
+/**
+* Expectimax over the position with mine to move, returns the win chance of mine.
+*/
+static SolverValue Solver_search(SolverSearch* search, uint64_t mine, uint64_t theirs, uint64_t hidden, int top, int depth, int* best) {
+	SolverValue result = { 0.0, 1 };
+	*best = SOLVER_DRAW;
+	if (theirs == 0) return result; // the other player went out last turn
+	if (mine == 0) {
+		result.value = 1.0;
+		return result;
+	}
+	if (depth <= 0) {
+		result.value = 0.5; // unfinished when the search stops, counted as half a win
+		result.exact = 0;
+		return result;
+	}
+
+	uint64_t key[3] = { mine, theirs, hidden | (uint64_t)top << SOLVER_TOP_SHIFT | search->rules };
+	if (Solver_probe(search, key, depth, &result, best)) return result;
+	search->stats->nodes++;
+
+	uint64_t moves = mine & search->match[top];
+	if (depth == 1 && (moves != 0 ? (mine & (mine - 1)) != 0 : (hidden | ~(mine | theirs | 1ull << top)) & SOLVER_ALL)) {
+		// on the last turn only going out counts, every other move ends unfinished
+		result.value = 0.5;
+		result.exact = 0;
+		*best = moves != 0 ? Solver_lowest(moves) : SOLVER_DRAW;
+	}
+	else if (moves != 0) {
+		result.value = -1.0;
+		for (uint64_t left = moves; left != 0; left &= left - 1) {
+			int card = Solver_lowest(left);
+			uint64_t hand = mine & ~(1ull << card);
+			SolverValue child;
+			if (hand == 0) {
+				child.value = 1.0;
+				child.exact = 1;
+			}
+			else {
+				child = Solver_handOver(search, hand, theirs, hidden, card, depth);
+			}
+			result.exact &= child.exact;
+			if (child.value > result.value) {
+				result.value = child.value;
+				*best = card;
+			}
+			if (child.value >= 1.0 && child.exact) {
+				result.exact = 1; // a sure win, the other cards cannot do better
+				break;
+			}
+		}
+	}
+	else {
+		// no match: draw from the hidden cards, or from the recycled played cards once there are none
+		uint64_t draws = hidden != 0 ? hidden : SOLVER_ALL & ~(mine | theirs | 1ull << top);
+		if (draws == 0) {
+			if ((theirs & search->match[top]) == 0) {
+				result.value = 0.5; // nobody can ever move again
+			}
+			else {
+				result = Solver_handOver(search, mine, theirs, 0, top, depth);
+			}
+		}
+		else {
+			double sum = 0.0;
+			for (uint64_t left = draws; left != 0; left &= left - 1) {
+				uint64_t bit = left & (~left + 1);
+				SolverValue child = Solver_handOver(search, mine | bit, theirs, draws & ~bit, top, depth);
+				sum += child.value;
+				result.exact &= child.exact;
+			}
+			result.value = sum / Solver_count(draws);
+		}
+	}
+
+	Solver_store(search, key, depth, result, *best);
+	return result;
+}
+
+/**
+* @brief Finds the best move and the win chance of the player to move
+* @details Several threads may solve positions with one table at once,
+* each with its own stats.
+*
+* @param table Transposition table, it keeps its positions for later calls
+* @param state The position, from one pack only
+* @param maxDepth Most turns to look ahead
+* @param stats Receives the search counts and time, NULL if not needed
+* @return The win chance of the player to move and the card to play
+*/
+SolverResult Solver_solve(SolverTable* table, const SolverState* state, int maxDepth, SolverStats* stats) {
+	call_once(&matchOnce, Solver_buildMasks);
+	SolverStats local;
+	memset(&local, 0, sizeof(local));
+	RuleVariant rules = state->rules >= 0 && state->rules < rulesCount ? state->rules : rulesStandard;
+	SolverSearch search = { table, &local, matchMask[rules], (uint64_t)rules << SOLVER_RULES_SHIFT };
+	double start = Bench_seconds();
+
+	int best;
+	SolverValue value = Solver_search(&search, state->hand[state->turn], state->hand[1 - state->turn], state->hidden, state->top, maxDepth, &best);
+	local.seconds = Bench_seconds() - start;
+	if (stats != NULL) *stats = local;
+
+	SolverResult result;
+	result.winChance = value.value;
+	result.bestCard = best;
+	result.exact = value.exact;
+	return result;
+}
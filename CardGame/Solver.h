@@ -0,0 +1,81 @@
+/**
+ * @file Solver.h
+ * Provides interface for the endgame solver: the best play and the win
+ * probability of a single-pack position.
+ *
+ * A position is known as sets of cards: both hands, the cards that can be
+ * drawn and the top played card. The order of the hidden deck is not
+ * known, so every draw is a chance node over the cards left to draw; when
+ * the hidden deck is empty, the played cards below the top card are
+ * recycled and drawn from instead, as in Game_finishTurn. The player to
+ * move picks any matching card (not just the first one, as
+ * CardDeck_findMatch does) or draws when nothing matches. The solver runs
+ * expectimax over these moves and draws, each player maximising their own
+ * chance to win.
+ *
+ * Draws and recycles can repeat positions, so the search stops after
+ * maxDepth turns and counts an unfinished line as half a win. A result
+ * is exact when no line reached that depth.
+ *
+ * Positions are keyed by three 64-bit words: the hand of the player to
+ * move, the other hand, and the hidden cards with the top card and the
+ * rule variant in the bits above them. The player to move is always
+ * "mine", so both players share entries. The transposition table is a
+ * fixed-size array that any number of threads can use at once without
+ * locks: each entry stores its key words XORed with its data word, so an
+ * entry torn by two threads writing at once no longer matches any key and
+ * is ignored.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "Card.h"
+#include "CardDeck.h"
+#include "game.h"
+
+#define SOLVER_DRAW -1 // bestCard when the player to move has to draw
+
+typedef struct {
+	uint64_t hand[2]; // bit c is set if the player holds packed card c
+	uint64_t hidden; // cards that can be drawn
+	int top; // packed top card of the played pile
+	int turn; // player to move, 0 or 1
+	RuleVariant rules; // which cards match the top card
+} SolverState;
+
+typedef struct {
+	_Atomic(uint64_t) words[4]; // the three key words XORed with the data word, then the data word
+} SolverEntry;
+
+typedef struct {
+	SolverEntry* entries; // 2^bits entries
+	uint64_t mask; // entries - 1
+} SolverTable;
+
+typedef struct {
+	long long nodes; // positions searched
+	long long probes; // table lookups
+	long long hits; // lookups that returned a value
+	double seconds; // time spent in Solver_solve
+} SolverStats;
+
+typedef struct {
+	double winChance; // chance that the player to move wins with best play from both sides
+	int bestCard; // packed card to play, or SOLVER_DRAW
+	int exact; // 1 if no line reached maxDepth
+} SolverResult;
+
+SolverTable* SolverTable_create(int bits);
+void SolverTable_delete(SolverTable* table);
+void SolverTable_clear(SolverTable* table);
+
+deckError Solver_stateFromGame(const Game* game, SolverState* state);
+deckError Solver_play(const SolverState* state, int card, SolverState* next);
+SolverResult Solver_solve(SolverTable* table, const SolverState* state, int maxDepth, SolverStats* stats);
+
+#endif
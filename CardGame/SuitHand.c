@@ -0,0 +1,136 @@
+/**
+* @file SuitHand.c
+* Implementation of the suit-grouped hand.
+*
+* @date 19.10.2026
+*/
+
+#include <string.h>
+#include <threads.h>
+#include "SuitHand.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static uint16_t allowed[rulesCount][PACK_SIZE][4]; // ranks of each suit that may be played on each top card
+static once_flag allowedOnce = ONCE_FLAG_INIT;
+
+/**
+* Fills allowed, once.
+*/
+static void SuitHand_buildAllowed(void) {
+	for (int rules = 0; rules < rulesCount; rules++) {
+		for (int top = 0; top < PACK_SIZE; top++) {
+			for (int c = 0; c < PACK_SIZE; c++) {
+				if (Rules_matches((RuleVariant)rules, &orderedPack[c], &orderedPack[top])) {
+					allowed[rules][top][orderedPack[c].suit] |= (uint16_t)(1u << orderedPack[c].rank);
+				}
+			}
+		}
+	}
+}
+
+/**
+* Returns the highest rank in a rank mask that is not empty.
+*/
+static inline int SuitHand_highestRank(uint16_t ranks) {
+#if defined(__GNUC__)
+	return 31 - __builtin_clz(ranks);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, ranks);
+	return (int)index;
+#else
+	int rank = ACE;
+	while ((ranks & (1u << rank)) == 0) rank--;
+	return rank;
+#endif
+}
+
+/**
+* @brief Empties a hand
+*
+* @param hand The hand
+*/
+void SuitHand_clear(SuitHand* hand) {
+	memset(hand, 0, sizeof(*hand));
+}
+
+/**
+* @brief Sets a hand to the cards of a deck
+*
+* @param hand The hand
+* @param deck Deck of valid cards, it is only read
+*/
+void SuitHand_fromDeck(SuitHand* hand, const CardDeck* deck) {
+	SuitHand_clear(hand);
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		SuitHand_add(hand, *card);
+	}
+}
+
+/**
+* @brief Finds the cards of a hand that may be played on a top card
+*
+* @param hand The hand
+* @param rules Rule variant that decides what matches
+* @param top The top card of the played pile, valid
+* @param playable Receives one rank mask per suit, bit r set if that card may be played
+*/
+void SuitHand_playable(const SuitHand* hand, RuleVariant rules, const Card* top, uint16_t playable[4]) {
+	call_once(&allowedOnce, SuitHand_buildAllowed);
+	const uint16_t* ranks = allowed[rules][Card_pack(*top)];
+	for (int s = 0; s < 4; s++) {
+		playable[s] = hand->ranks[s] & ranks[s];
+	}
+}
+
+/**
+* @brief Finds the highest card of a hand that may be played on a top card
+* @details Of cards with the same rank, the one of the lowest suit is taken.
+*
+* @param hand The hand
+* @param rules Rule variant that decides what matches
+* @param top The top card of the played pile, valid
+* @param card Receives the card, unchanged if nothing matches
+* @return 1 if a card matches, otherwise 0
+*/
+int SuitHand_highestMatch(const SuitHand* hand, RuleVariant rules, const Card* top, Card* card) {
+	uint16_t playable[4];
+	SuitHand_playable(hand, rules, top, playable);
+	uint16_t any = playable[0] | playable[1] | playable[2] | playable[3];
+	if (any == 0) return 0;
+	int rank = SuitHand_highestRank(any);
+	int suit = 0;
+	while ((playable[suit] & (1u << rank)) == 0) suit++;
+	card->suit = (Suit)suit;
+	card->rank = (Rank)rank;
+	return 1;
+}
+
+/**
+* @brief Finds the highest playable card of the suit the hand holds most of
+* @details Only suits with a card that may be played count. Of suits held
+* equally often, the lowest is taken.
+*
+* @param hand The hand
+* @param rules Rule variant that decides what matches
+* @param top The top card of the played pile, valid
+* @param card Receives the card, unchanged if nothing matches
+* @return 1 if a card matches, otherwise 0
+*/
+int SuitHand_longestSuitMatch(const SuitHand* hand, RuleVariant rules, const Card* top, Card* card) {
+	uint16_t playable[4];
+	SuitHand_playable(hand, rules, top, playable);
+	int best = -1;
+	for (int s = 0; s < 4; s++) {
+		if (playable[s] != 0 && (best < 0 || hand->suitCount[s] > hand->suitCount[best])) best = s;
+	}
+	if (best < 0) return 0;
+	card->suit = (Suit)best;
+	card->rank = (Rank)SuitHand_highestRank(playable[best]);
+	return 1;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file SuitHand.h
+ * Provides interface for a player's hand grouped by suit and ordered by
+ * rank, kept next to the CardDeck of the hand.
+ *
+ * A SuitHand counts the copies of each of the 52 cards a player holds,
+ * and keeps one 13-bit rank mask per suit with a bit for every rank held.
+ * Adding and removing a card is O(1), and so are the questions strategies
+ * ask: how many cards of a suit, the highest card that matches the top
+ * card, the suit with the most cards that can be played. None of them
+ * walks the hand.
+ *
+ * The CardDeck of the hand stays the hand itself, in dealing order, so the
+ * first-match rule and everything that reads hands works as before. A game
+ * only keeps SuitHands when its strategy asks them (Game_setStrategy), and
+ * then updates them together with the hands in Game_deal and
+ * Game_finishTurn. Code that puts cards into a hand directly calls
+ * SuitHand_fromDeck afterwards.
+ *
+ * A card can be held up to 65535 times, so games may use up to 65535
+ * packs.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SUITHAND_H
+#define SUITHAND_H
+
+#include <stdint.h>
+#include "Card.h"
+#include "CardDeck.h"
+#include "Rules.h"
+
+typedef struct {
+	uint16_t count[4][13]; // copies held of each card, by suit and rank
+	uint16_t ranks[4]; // bit r is set if at least one card of the suit with rank r is held
+	int suitCount[4]; // cards held of each suit
+	int total; // cards held
+} SuitHand;
+
+void SuitHand_clear(SuitHand* hand);
+void SuitHand_fromDeck(SuitHand* hand, const CardDeck* deck);
+void SuitHand_playable(const SuitHand* hand, RuleVariant rules, const Card* top, uint16_t playable[4]);
+int SuitHand_highestMatch(const SuitHand* hand, RuleVariant rules, const Card* top, Card* card);
+int SuitHand_longestSuitMatch(const SuitHand* hand, RuleVariant rules, const Card* top, Card* card);
+
+/**
+* Adds a valid card to the hand.
+*/
+static inline void SuitHand_add(SuitHand* hand, Card card) {
+	hand->count[card.suit][card.rank]++;
+	hand->ranks[card.suit] |= (uint16_t)(1u << card.rank);
+	hand->suitCount[card.suit]++;
+	hand->total++;
+}
+
+/**
+* Removes a card the hand holds.
+*/
+static inline void SuitHand_remove(SuitHand* hand, Card card) {
+	if (--hand->count[card.suit][card.rank] == 0) hand->ranks[card.suit] &= (uint16_t)~(1u << card.rank);
+	hand->suitCount[card.suit]--;
+	hand->total--;
+}
+
+/**
+* Returns the number of cards of a suit in the hand.
+*/
+static inline int SuitHand_countSuit(const SuitHand* hand, Suit suit) {
+	return hand->suitCount[suit];
+}
+
+/**
+* Returns the number of copies of a card in the hand.
+*/
+static inline int SuitHand_countCard(const SuitHand* hand, Card card) {
+	return hand->count[card.suit][card.rank];
+}
+
+#endif
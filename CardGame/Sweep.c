@@ -0,0 +1,312 @@
+/**
+* @file Sweep.c
+* Implementation of parameter sweeps.
+*
+* @date 19.10.2026
+*/
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "Sweep.h"
+#include "Trace.h"
+
+static const char* const strategyNames[strategyCount] = { "first", "highest", "longest-suit" };
+
+typedef struct {
+	const SweepConfig* config;
+	SweepCell* cells;
+	int* remaining; // tasks of each cell that are not done yet
+	int numCells;
+	int tasksPerCell;
+	PackedCard* shoes[SWEEP_MAX_PACKS + 1]; // ordered shoe of each pack count, shared by all threads
+	atomic_int nextTask; // next task a worker takes
+	mtx_t lock; // guards cells, remaining and out
+	FILE* out; // NULL writes nothing
+	int failed; // set if a game could not be set up
+} Sweep;
+
+/**
+* @brief Fills in a sweep over 1 to 16 packs, hands of 3 to 15 cards, every
+* strategy and every rule variant but suit-only and rank-only, 1000
+* games per cell
+* @details Under suit-only and rank-only rules the top card never changes
+* its suit or rank, so games almost never end and every one of them plays
+* to the turn limit. They are only swept when asked for.
+*
+* @param config The settings to fill in
+*/
+void Sweep_defaults(SweepConfig* config) {
+	config->minPacks = 1;
+	config->maxPacks = SWEEP_MAX_PACKS;
+	config->minHand = 3;
+	config->maxHand = SWEEP_MAX_HAND;
+	config->rulesMask = ((1u << rulesCount) - 1) & ~(1u << rulesSuitOnly) & ~(1u << rulesRankOnly);
+	config->strategyMask = (1u << strategyCount) - 1;
+	config->gamesPerCell = 1000;
+	config->seed = 1;
+	config->maxTurns = 1000;
+	config->numThreads = CardDeck_hardwareThreads();
+	config->results = NULL;
+}
+
+/**
+* @brief Returns the key of a cell, which its games' streams are made from
+*
+* @param cell The cell, only its settings are used
+* @return The key, the same for the same settings in any sweep
+*/
+uint64_t Sweep_cellKey(const SweepCell* cell) {
+	return (((uint64_t)cell->numPacks * 32 + (uint64_t)cell->handSize) * 8 + cell->rules) * 4 + cell->strategy;
+}
+
+/**
+* Writes the column names.
+*/
+static void Sweep_writeHeader(FILE* out) {
+	fprintf(out, "packs\thand\trules\tstrategy\tgames\tturns\tp1_wins\tp2_wins\tunfinished\tturns_squared\tlongest\n");
+}
+
+/**
+* Writes the totals of a finished cell as one line.
+*/
+static void Sweep_writeCell(FILE* out, const SweepCell* cell) {
+	fprintf(out, "%d\t%d\t%s\t%s\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\n",
+		cell->numPacks, cell->handSize, ruleNames[cell->rules], strategyNames[cell->strategy],
+		(unsigned long long)cell->games, (unsigned long long)cell->turns,
+		(unsigned long long)cell->wins[0], (unsigned long long)cell->wins[1],
+		(unsigned long long)cell->unfinished, (unsigned long long)cell->turnsSquared,
+		(unsigned long long)cell->longest);
+}
+
+/**
+* Plays one game from a shuffled copy of the shoe and adds it to the totals.
+* If result is not NULL, it receives the game's result under number.
+*
+* @return 0, or -1 if the game cannot be set up or has lost or doubled a card
+*/
+static int Sweep_playGame(const SweepConfig* config, const SweepCell* cell, const PackedCard* shoe,
+	PackedCard* cards, Rng* rng, SweepCell* totals, uint64_t number, GameResult* result) {
+	int count = cell->numPacks * PACK_SIZE;
+	memcpy(cards, shoe, (size_t)count);
+	for (int i = count - 1; i > 0; i--) {
+		int pos = (int)Rng_bounded(rng, (uint32_t)i + 1);
+		PackedCard card = cards[i];
+		cards[i] = cards[pos];
+		cards[pos] = card;
+	}
+
+	Game game;
+	if (Game_initDecks(&game, rng) != ok) return -1;
+	game.rules = cell->rules;
+	deckError err = CardDeck_insertPackedAfter(&game.hidden, cards, count);
+	game.hidden.current = game.hidden.head;
+	Game_recordShoe(&game);
+	if (err == ok) err = Game_setStrategy(&game, cell->strategy);
+	if (err == ok) err = Game_dealHands(&game, cell->handSize);
+	if (err != ok) {
+		Game_free(&game);
+		return -1;
+	}
+
+	uint64_t turns = 0;
+	while (game.status == ongoing && turns < (uint64_t)config->maxTurns) {
+		Game_playTurn(&game);
+		turns++;
+	}
+	if (!Game_checkCards(&game)) {
+		Game_free(&game);
+		return -1;
+	}
+	if (result != NULL) GameResult_capture(&game, number, (int)turns, result);
+	totals->games++;
+	totals->turns += turns;
+	totals->turnsSquared += turns * turns;
+	if (turns > totals->longest) totals->longest = turns;
+	if (game.status == win) {
+		totals->wins[game.turn]++; // the winner keeps the turn
+	}
+	else {
+		totals->unfinished++;
+	}
+	Game_free(&game);
+	return 0;
+}
+
+/**
+* Takes tasks until none are left, then returns.
+*/
+static int Sweep_worker(void* arg) {
+	Sweep* sweep = (Sweep*)arg;
+	const SweepConfig* config = sweep->config;
+	PackedCard* cards = (PackedCard*)malloc((size_t)config->maxPacks * PACK_SIZE);
+	GameResult* results = config->results != NULL ? (GameResult*)malloc(SWEEP_CHUNK * sizeof(GameResult)) : NULL;
+	if (cards == NULL || (config->results != NULL && results == NULL)) {
+		mtx_lock(&sweep->lock);
+		sweep->failed = 1;
+		mtx_unlock(&sweep->lock);
+		free(cards);
+		free(results);
+		return 0;
+	}
+
+	int numTasks = sweep->numCells * sweep->tasksPerCell;
+	int task;
+	while ((task = atomic_fetch_add(&sweep->nextTask, 1)) < numTasks) {
+		int c = task / sweep->tasksPerCell;
+		int chunk = task % sweep->tasksPerCell;
+		SweepCell* cell = &sweep->cells[c];
+		uint64_t first = (uint64_t)chunk * SWEEP_CHUNK;
+		uint64_t last = first + SWEEP_CHUNK < config->gamesPerCell ? first + SWEEP_CHUNK : config->gamesPerCell;
+
+		// the stream depends on the cell and the task only, not on the grid or the thread
+		uint64_t key = Sweep_cellKey(cell);
+		Rng rng;
+		Rng_seedStream(&rng, config->seed ^ (key * 0x9e3779b97f4a7c15ull), (uint64_t)chunk);
+
+		SweepCell totals;
+		memset(&totals, 0, sizeof(totals));
+		int failed = 0;
+		for (uint64_t g = first; g < last && !failed; g++) {
+			GameResult* result = results != NULL ? &results[g - first] : NULL;
+			failed = Sweep_playGame(config, cell, sweep->shoes[cell->numPacks], cards, &rng, &totals, g, result) != 0;
+			if (result != NULL) {
+				result->cell = key;
+				result->stream = (uint64_t)chunk;
+			}
+		}
+		if (results != NULL && !failed) {
+			failed = ResultWriter_add(config->results, results, (int)(last - first)) != 0;
+		}
+
+		mtx_lock(&sweep->lock);
+		sweep->failed |= failed;
+		cell->games += totals.games;
+		cell->turns += totals.turns;
+		cell->wins[0] += totals.wins[0];
+		cell->wins[1] += totals.wins[1];
+		cell->unfinished += totals.unfinished;
+		cell->turnsSquared += totals.turnsSquared;
+		if (totals.longest > cell->longest) cell->longest = totals.longest;
+		if (--sweep->remaining[c] == 0 && sweep->out != NULL) {
+			Sweep_writeCell(sweep->out, cell);
+		}
+		mtx_unlock(&sweep->lock);
+	}
+	free(cards);
+	free(results);
+	return 0;
+}
+
+/**
+* Runs a worker on a thread of its own, named in traces.
+*/
+static int Sweep_workerThread(void* arg) {
+	TRACE_THREAD_NAME("sweep worker");
+	TRACE_SCOPE(Sweep_workerThread);
+	return Sweep_worker(arg);
+}
+
+/**
+* Frees everything Sweep_run allocated but the cells.
+*/
+static void Sweep_free(Sweep* sweep) {
+	for (int p = 0; p <= SWEEP_MAX_PACKS; p++) {
+		free(sweep->shoes[p]);
+	}
+	free(sweep->remaining);
+}
+
+/**
+* @brief Plays a sweep on worker threads
+* @details The calling thread works as one of the workers. A worker whose
+* thread cannot be started is left out.
+*
+* @param config The settings, see Sweep_defaults
+* @param out Receives the totals of every cell as it finishes, NULL writes nothing
+* @param numCells Receives the number of cells
+* @return The totals of every cell in grid order (packs, then hand size, rules
+* and strategy), free them with free(); NULL if the settings are invalid,
+* allocation fails, a game lost or doubled a card (see Game_checkCards) or
+* config->results could not be written
+*/
+SweepCell* Sweep_run(const SweepConfig* config, FILE* out, int* numCells) {
+	*numCells = 0;
+	if (config->minPacks < 1 || config->maxPacks > SWEEP_MAX_PACKS || config->minPacks > config->maxPacks ||
+		config->minHand < SWEEP_MIN_HAND || config->maxHand > SWEEP_MAX_HAND || config->minHand > config->maxHand ||
+		config->gamesPerCell == 0 || config->gamesPerCell > (uint64_t)SWEEP_CHUNK * 0x7FFF) {
+		return NULL;
+	}
+
+	Sweep sweep;
+	memset(&sweep, 0, sizeof(sweep));
+	sweep.config = config;
+	sweep.out = out;
+	sweep.tasksPerCell = (int)((config->gamesPerCell + SWEEP_CHUNK - 1) / SWEEP_CHUNK);
+
+	int count = 0;
+	for (int r = 0; r < rulesCount; r++) count += (config->rulesMask >> r) & 1;
+	int strategies = 0;
+	for (int s = 0; s < strategyCount; s++) strategies += (config->strategyMask >> s) & 1;
+	count *= strategies * (config->maxPacks - config->minPacks + 1) * (config->maxHand - config->minHand + 1);
+	if (count == 0) return NULL;
+
+	SweepCell* cells = (SweepCell*)calloc((size_t)count, sizeof(SweepCell));
+	sweep.remaining = (int*)malloc((size_t)count * sizeof(int));
+	int failed = cells == NULL || sweep.remaining == NULL;
+	for (int p = config->minPacks; p <= config->maxPacks && !failed; p++) {
+		sweep.shoes[p] = (PackedCard*)malloc((size_t)p * PACK_SIZE);
+		failed = sweep.shoes[p] == NULL;
+		for (int c = 0; c < p * PACK_SIZE && !failed; c++) {
+			sweep.shoes[p][c] = (PackedCard)(c % PACK_SIZE);
+		}
+	}
+	if (failed || mtx_init(&sweep.lock, mtx_plain) != thrd_success) {
+		Sweep_free(&sweep);
+		free(cells);
+		return NULL;
+	}
+
+	int c = 0;
+	for (int p = config->minPacks; p <= config->maxPacks; p++) {
+		for (int h = config->minHand; h <= config->maxHand; h++) {
+			for (int r = 0; r < rulesCount; r++) {
+				for (int s = 0; s < strategyCount; s++) {
+					if (((config->rulesMask >> r) & 1) == 0 || ((config->strategyMask >> s) & 1) == 0) continue;
+					cells[c].numPacks = p;
+					cells[c].handSize = h;
+					cells[c].rules = (RuleVariant)r;
+					cells[c].strategy = (GameStrategy)s;
+					sweep.remaining[c] = sweep.tasksPerCell;
+					c++;
+				}
+			}
+		}
+	}
+	sweep.cells = cells;
+	sweep.numCells = count;
+	atomic_init(&sweep.nextTask, 0);
+	if (out != NULL) Sweep_writeHeader(out);
+
+	int numThreads = config->numThreads < 1 ? 1 : config->numThreads;
+	if (numThreads > CARDDECK_MAX_THREADS) numThreads = CARDDECK_MAX_THREADS;
+	thrd_t threads[CARDDECK_MAX_THREADS];
+	int started[CARDDECK_MAX_THREADS];
+	for (int t = 1; t < numThreads; t++) {
+		started[t] = thrd_create(&threads[t], Sweep_workerThread, &sweep) == thrd_success;
+	}
+	Sweep_worker(&sweep);
+	for (int t = 1; t < numThreads; t++) {
+		if (started[t]) thrd_join(threads[t], NULL);
+	}
+
+	mtx_destroy(&sweep.lock);
+	Sweep_free(&sweep);
+	if (sweep.failed) {
+		free(cells);
+		return NULL;
+	}
+	*numCells = count;
+	return cells;
+}
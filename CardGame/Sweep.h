@@ -0,0 +1,78 @@
+/**
+ * @file Sweep.h
+ * Provides interface for parameter sweeps: many games for every
+ * combination of pack count, hand size, rule variant and strategy.
+ *
+ * Every combination is a cell of the sweep, and every cell is split into
+ * tasks of SWEEP_CHUNK games. Worker threads take the next task from a
+ * shared counter, so long cells (few packs, rules where games seldom end)
+ * do not hold up the rest. The ordered shoe of every pack count is built
+ * once before the threads start and only read by them; a game copies it,
+ * shuffles the copy and puts it into its hidden deck in one bulk insert.
+ *
+ * Task t of a cell plays its games with stream t of a key made from the
+ * cell and the seed of the sweep, so a cell has the same results whatever
+ * else is swept with it and on any number of threads.
+ *
+ * When the last task of a cell is done, its totals are written as one line
+ * of tab-separated columns, in the order cells finish. The first line
+ * names the columns.
+ *
+ * If SweepConfig.results is set, every game is also written to that
+ * result file (see ResultFile.h), a task's games together. A row holds the
+ * key of the game's cell (Sweep_cellKey), the task as its stream and the
+ * game's index in the cell. The game is replayed by seeding a generator
+ * with Rng_seedStream(seed ^ key * 0x9e3779b97f4a7c15, stream) and playing
+ * the cell's games from stream * SWEEP_CHUNK up to it.
+ *
+ * Games are between two players, the only number of players Game knows.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+#include "ResultFile.h"
+#include "Rules.h"
+
+#define SWEEP_MAX_PACKS 16 // most packs a sweep can use
+#define SWEEP_MIN_HAND 1 // fewest cards a player can be dealt
+#define SWEEP_MAX_HAND 15 // most cards a player can be dealt
+#define SWEEP_CHUNK 4096 // games per task
+
+typedef struct {
+	int minPacks; // fewest packs swept, 1 or more
+	int maxPacks; // most packs swept, up to SWEEP_MAX_PACKS
+	int minHand; // smallest hand size swept, SWEEP_MIN_HAND or more
+	int maxHand; // largest hand size swept, up to SWEEP_MAX_HAND
+	unsigned rulesMask; // bit r is set to sweep rule variant r
+	unsigned strategyMask; // bit s is set to sweep strategy s
+	uint64_t gamesPerCell; // games played in every cell
+	uint64_t seed; // seed of the whole sweep
+	int maxTurns; // a game stops after this many turns even without a winner
+	int numThreads; // worker threads, 1 to CARDDECK_MAX_THREADS
+	ResultWriter* results; // receives a row for every game, NULL writes none
+} SweepConfig;
+
+typedef struct {
+	int numPacks;
+	int handSize; // cards dealt to each player
+	RuleVariant rules;
+	GameStrategy strategy;
+	uint64_t games; // games played
+	uint64_t turns; // turns played over all games
+	uint64_t wins[2]; // games won by player 1 and player 2
+	uint64_t unfinished; // games stopped at the turn limit
+	uint64_t turnsSquared; // sum of the squared turns of every game, for the variance
+	uint64_t longest; // most turns of any game
+} SweepCell;
+
+void Sweep_defaults(SweepConfig* config);
+uint64_t Sweep_cellKey(const SweepCell* cell);
+SweepCell* Sweep_run(const SweepConfig* config, FILE* out, int* numCells);
+
+#endif
@@ -0,0 +1,167 @@
+/**
+* @file Trace.c
+* Provides implementation of the event tracer: per-thread ring
+* buffers and the Chrome trace JSON writer.
+*
+* Rings are registered on a global list the first time a thread
+* records an event and are never freed, so events of threads that
+* already exited are still written at exit.
+*
+* @date 19.10.2026
+*/
+
+#include "Trace.h"
+
+#ifdef CARDGAME_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _MSC_VER
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct {
+	const char* name; // static name of the scope
+	uint64_t start; // begin time in nanoseconds
+	uint64_t duration; // duration in nanoseconds
+} TraceEvent;
+
+typedef struct TraceRing {
+	TraceEvent events[TRACE_RING_SIZE];
+	uint64_t written; // total events recorded, the ring holds the last TRACE_RING_SIZE
+	int tid; // small sequential thread id used in the trace
+	const char* threadName; // optional name set with Trace_nameThread
+	struct TraceRing* next; // next registered ring (another thread)
+} TraceRing;
+
+static _Atomic(TraceRing*) traceRings = NULL; // every thread's ring
+static atomic_int traceNextTid = 1;
+static atomic_flag traceWriteRegistered = ATOMIC_FLAG_INIT;
+static TRACE_THREAD_LOCAL TraceRing* traceLocal = NULL;
+
+static void Trace_writeAtExit(void);
+
+/**
+* Returns the calling thread's ring, registering a new one
+* (and the exit writer) the first time a thread records an event.
+*/
+static TraceRing* Trace_local(void) {
+	if (traceLocal != NULL) return traceLocal;
+
+	TraceRing* ring = (TraceRing*)calloc(1, sizeof(TraceRing));
+	if (ring == NULL) return NULL;
+	ring->tid = atomic_fetch_add(&traceNextTid, 1);
+
+	ring->next = atomic_load(&traceRings);
+	while (!atomic_compare_exchange_weak(&traceRings, &ring->next, ring)) {
+	}
+	traceLocal = ring;
+
+	if (!atomic_flag_test_and_set(&traceWriteRegistered)) {
+		atexit(Trace_writeAtExit);
+	}
+	return ring;
+}
+
+/**
+* Reads the trace clock in nanoseconds.
+*/
+uint64_t Trace_now(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+* Cleanup handler of TRACE_SCOPE: records the scope that is
+* being left as one complete event in the thread's ring.
+*
+* @param scope The scope that is being left
+*/
+void Trace_endScope(TraceScope* scope) {
+	uint64_t end = Trace_now();
+	TraceRing* ring = Trace_local();
+	if (ring == NULL) return; // no memory for a ring, drop the event
+
+	TraceEvent* event = &ring->events[ring->written & (TRACE_RING_SIZE - 1)];
+	event->name = scope->name;
+	event->start = scope->start;
+	event->duration = end - scope->start;
+	ring->written++;
+}
+
+/**
+* Names the calling thread in the trace, e.g. "worker 3".
+*
+* @param name Static string naming the thread
+*/
+void Trace_nameThread(const char* name) {
+	TraceRing* ring = Trace_local();
+	if (ring != NULL) ring->threadName = name;
+}
+
+/**
+* Writes every ring as Chrome trace JSON.
+* Must not race with threads that are still recording.
+*
+* @param path File to write the trace to
+* @return 0 on success, -1 if the file could not be written
+*/
+int Trace_write(const char* path) {
+	FILE* file = fopen(path, "w");
+	if (file == NULL) return -1;
+
+	// find the earliest event so timestamps start near zero
+	uint64_t epoch = UINT64_MAX;
+	for (TraceRing* ring = atomic_load(&traceRings); ring != NULL; ring = ring->next) {
+		uint64_t first = ring->written > TRACE_RING_SIZE ? ring->written - TRACE_RING_SIZE : 0;
+		for (uint64_t i = first; i < ring->written; i++) {
+			uint64_t start = ring->events[i & (TRACE_RING_SIZE - 1)].start;
+			if (start < epoch) epoch = start;
+		}
+	}
+	if (epoch == UINT64_MAX) epoch = 0;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	int firstEvent = 1;
+	for (TraceRing* ring = atomic_load(&traceRings); ring != NULL; ring = ring->next) {
+		if (ring->threadName != NULL) {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				firstEvent ? "" : ",\n", ring->tid, ring->threadName);
+			firstEvent = 0;
+		}
+
+		uint64_t first = ring->written > TRACE_RING_SIZE ? ring->written - TRACE_RING_SIZE : 0;
+		for (uint64_t i = first; i < ring->written; i++) {
+			TraceEvent* event = &ring->events[i & (TRACE_RING_SIZE - 1)];
+			// chrome trace timestamps are in microseconds
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				firstEvent ? "" : ",\n", event->name, ring->tid,
+				(double)(event->start - epoch) / 1000.0, (double)event->duration / 1000.0);
+			firstEvent = 0;
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	return fclose(file) == 0 ? 0 : -1;
+}
+
+/**
+* Registered with atexit: writes the trace to CARDGAME_TRACE_FILE
+* or cardgame_trace.json.
+*/
+static void Trace_writeAtExit(void) {
+	const char* path = getenv("CARDGAME_TRACE_FILE");
+	if (path == NULL || path[0] == '\0') path = "cardgame_trace.json";
+
+	if (Trace_write(path) != 0) {
+		fprintf(stderr, "could not write trace to %s\n", path);
+	}
+}
+
+#endif
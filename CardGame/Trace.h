@@ -0,0 +1,62 @@
+/**
+ * @file Trace.h
+ * Provides an optional low-overhead event tracer for game and deck
+ * timelines. Traced scopes are written as Chrome trace JSON, which can
+ * be opened in chrome://tracing or ui.perfetto.dev.
+ *
+ * Each thread records into its own fixed-size ring buffer, so tracing
+ * never takes a lock. When a ring is full the oldest events of that
+ * thread are overwritten. A scope is stored as one complete event
+ * (begin time plus duration), so a wrapped ring never leaves an
+ * unmatched begin or end behind.
+ *
+ * Tracing is only compiled in when CARDGAME_TRACE is defined, otherwise
+ * the macros expand to nothing. The trace is written at exit to the file
+ * named by the CARDGAME_TRACE_FILE environment variable, or to
+ * cardgame_trace.json. Like Instrument.h, scopes need the cleanup
+ * attribute (GCC/Clang).
+ *
+ * Worker threads (parallel shuffle, simulator, sweep, load generator,
+ * result writer) name themselves and, except for the result writer,
+ * trace their whole run as one scope, so uneven shares show up as
+ * scopes of different length on the named threads.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_RING_SIZE 65536 // events kept per thread, must be a power of two
+
+#ifdef CARDGAME_TRACE
+
+#include <stdint.h>
+
+typedef struct {
+	const char* name; // static name of the traced scope
+	uint64_t start; // begin time in nanoseconds
+} TraceScope;
+
+uint64_t Trace_now(void);
+void Trace_endScope(TraceScope* scope);
+void Trace_nameThread(const char* name);
+int Trace_write(const char* path);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRACE_SCOPE(fn) \
+	TraceScope traceScope_ __attribute__((cleanup(Trace_endScope))) = { #fn, Trace_now() }
+#else
+#define TRACE_SCOPE(fn)
+#endif
+
+#define TRACE_THREAD_NAME(name) Trace_nameThread(name)
+
+#else
+
+#define TRACE_SCOPE(fn)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+/**
+* @file Train.c
+* Implementation of the training workload of profile-guided builds.
+*
+* @date 19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "Train.h"
+#include "bench.h"
+#include "CardDeck.h"
+#include "Rng.h"
+#include "Simulator.h"
+#include "game.h"
+
+#define TRAIN_GAMES 600 // games per round played turn by turn
+#define TRAIN_SIM_GAMES 2048 // games per round played by the simulator, spread over the pack counts
+#define TRAIN_SIM_WIDTH 16 // games the simulator keeps in flight
+#define TRAIN_DECK_CARDS 1000000 // cards shuffled per round, spread over the deck sizes
+#define TRAIN_HAND_OPS 300000 // hand operations per round
+
+static const int trainPacks[] = { 1, 2, 3, 4, 6, 8 };
+#define TRAIN_PACK_COUNTS ((int)(sizeof(trainPacks) / sizeof(trainPacks[0])))
+
+/**
+* Plays TRAIN_GAMES games turn by turn, cycling through the pack counts,
+* strategies and rule variants.
+*
+* @return 0, or -1 if a game cannot be set up
+*/
+static int Train_games(Rng* rng, TrainReport* report) {
+	for (int g = 0; g < TRAIN_GAMES; g++) {
+		Game game;
+		if (Game_init(&game, trainPacks[g % TRAIN_PACK_COUNTS], rng) != ok) return -1;
+		if (Game_setStrategy(&game, (GameStrategy)(g / TRAIN_PACK_COUNTS % strategyCount)) != ok) {
+			Game_free(&game);
+			return -1;
+		}
+		game.rules = (RuleVariant)(g / (TRAIN_PACK_COUNTS * strategyCount) % rulesCount);
+		int t = 0;
+		while (t < TRAIN_MAX_TURNS && game.status == ongoing) {
+			Game_playTurn(&game);
+			t++;
+		}
+		report->games++;
+		report->turns += t;
+		report->recycles += game.recycles;
+		Game_free(&game);
+	}
+	return 0;
+}
+
+/**
+* Plays TRAIN_SIM_GAMES games with Simulator_runInterleaved, a batch per pack count.
+*
+* @return 0, or -1 if allocation fails
+*/
+static int Train_simulator(uint64_t seed, TrainReport* report) {
+	for (int p = 0; p < TRAIN_PACK_COUNTS; p++) {
+		int count = TRAIN_SIM_GAMES / TRAIN_PACK_COUNTS;
+		Simulator* sim = Simulator_create(count, trainPacks[p], seed + (uint64_t)p, TRAIN_MAX_TURNS);
+		long long turns = sim != NULL ? Simulator_runInterleaved(sim, TRAIN_SIM_WIDTH) : -1;
+		if (turns < 0) {
+			Simulator_delete(sim);
+			return -1;
+		}
+		report->games += count;
+		report->turns += turns;
+		for (int i = 0; i < count; i++) {
+			report->recycles += sim->games[i].game.recycles;
+		}
+		Simulator_delete(sim);
+	}
+	return 0;
+}
+
+/**
+* Shuffles and sorts decks of every pack count, and recycles linked played
+* decks into them.
+*
+* @return 0, or -1 if allocation fails
+*/
+static int Train_decks(Rng* rng, TrainReport* report) {
+	for (int p = 0; p < TRAIN_PACK_COUNTS; p++) {
+		int cards = trainPacks[p] * PACK_SIZE;
+		CardDeck deck;
+		CardDeck played;
+		if (CardDeck_init(&deck) != ok) return -1;
+		if (CardDeck_init(&played) != ok || CardDeck_fillDeck(&deck, trainPacks[p]) == NULL) {
+			CardDeck_destroy(&deck);
+			CardDeck_destroy(&played);
+			return -1;
+		}
+		deckError err = ok;
+		for (int r = 0; r < TRAIN_DECK_CARDS / TRAIN_PACK_COUNTS / cards && err == ok; r++) {
+			err = CardDeck_shuffleWith(&deck, rng);
+			report->shuffles++;
+			if (r % 2 == 0) {
+				CardDeck_sort(&deck);
+				report->sorts++;
+			}
+			// play half the deck onto a linked played deck and recycle it back
+			for (int c = 0; c < cards / 2 && err == ok; c++) {
+				Card* card = CardDeck_useTop(&deck, &err);
+				if (card != NULL) err = CardDeck_insertToTop(&played, *card);
+				free(card);
+			}
+			if (err == ok) err = CardDeck_recycleHiddenWith(&deck, &played, rng);
+			report->recycles++;
+		}
+		CardDeck_destroy(&deck);
+		CardDeck_destroy(&played);
+		if (err != ok) return -1;
+	}
+	return 0;
+}
+
+/**
+* Draws cards into a hand from a shuffled shoe and plays them from random
+* positions, keeping the hand between 3 and 15 cards.
+*
+* @return 0, or -1 if allocation fails
+*/
+static int Train_hands(Rng* rng, TrainReport* report) {
+	CardDeck shoe;
+	CardDeck hand;
+	if (CardDeck_init(&shoe) != ok) return -1;
+	if (CardDeck_init(&hand) != ok) {
+		CardDeck_destroy(&shoe);
+		return -1;
+	}
+	deckError err = ok;
+	int count = 0;
+	for (int i = 0; i < TRAIN_HAND_OPS && err == ok; i++) {
+		if (shoe.head->successor == NULL) {
+			if (CardDeck_fillDeck(&shoe, 2) == NULL) err = noMemory;
+			else err = CardDeck_shuffleWith(&shoe, rng);
+		}
+		if (err != ok) break;
+		Card* card;
+		if (count < 3 || (count < 15 && Rng_bounded(rng, 2) == 0)) {
+			card = CardDeck_useTop(&shoe, &err);
+			if (card != NULL && (err = CardDeck_insertToTop(&hand, *card)) == ok) count++;
+		}
+		else {
+			card = CardDeck_removeAt(&hand, (int)Rng_bounded(rng, (uint32_t)count), &err);
+			count -= card != NULL;
+		}
+		free(card);
+		report->handOps++;
+	}
+	CardDeck_destroy(&shoe);
+	CardDeck_destroy(&hand);
+	return err == ok ? 0 : -1;
+}
+
+/**
+* @brief Plays the training workload
+*
+* @param rounds Rounds to play, each does all parts of the workload once
+* @param report Receives what was played
+* @return 0, or -1 if allocation fails
+*/
+int Train_run(int rounds, TrainReport* report) {
+	memset(report, 0, sizeof(*report));
+	double start = Bench_seconds();
+	int failed = 0;
+	for (int r = 0; r < rounds && !failed; r++) {
+		Rng rng;
+		Rng_seed(&rng, 50 + (uint64_t)r);
+		failed = Train_games(&rng, report) != 0 || Train_simulator(500 + (uint64_t)r, report) != 0 ||
+			Train_decks(&rng, report) != 0 || Train_hands(&rng, report) != 0;
+	}
+	report->seconds = Bench_seconds() - start;
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file Train.h
+ * Provides interface for the training workload of profile-guided builds:
+ * what the program is run with between the instrumented and the optimized
+ * build, so the compiler learns which branches and calls are hot.
+ *
+ * A profile only helps with the work it has seen, so the workload mixes
+ * what long simulation runs do rather than repeating one benchmark:
+ *
+ * - whole games of 1 to 8 packs, with every strategy and every rule
+ *   variant, played turn by turn with Game_playTurn; the suit-only and
+ *   rank-only variants and the large shoes give long games that recycle
+ *   the played pile many times
+ * - batches of games played by Simulator_runInterleaved, the way
+ *   campaigns play them
+ * - shuffles and sorts of decks of 1 to 8 packs, and linked played decks
+ *   recycled with CardDeck_recycleHiddenWith
+ * - hand operations: cards drawn with CardDeck_useTop and played from
+ *   random positions with CardDeck_removeAt
+ *
+ * Round r always uses the same seeds, so every run plays the same games
+ * and profiles of two builds of the same sources are alike. Run it with
+ * "<program> train [rounds]"; the Linux Makefile does that for "make pgo".
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef TRAIN_H
+#define TRAIN_H
+
+#define TRAIN_ROUNDS 16 // rounds "train" plays unless told otherwise
+#define TRAIN_MAX_TURNS 5000 // turn limit of every game, high so long games recycle many times
+
+typedef struct {
+	long long games; // games played
+	long long turns; // turns played in them
+	long long recycles; // times a played pile went back into the hidden deck
+	long long shuffles; // shuffles outside the games
+	long long sorts; // sorts
+	long long handOps; // cards drawn into and played from hands outside the games
+	double seconds; // time the rounds took
+} TrainReport;
+
+int Train_run(int rounds, TrainReport* report);
+
+#endif
@@ -0,0 +1,896 @@
+/**
+* @file bench.c
+* Implementation of the micro benchmarks.
+* Each benchmark prints its own results to stdout.
+*
+* @date 19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <threads.h>
+#include "bench.h"
+#include "CardDeck.h"
+#include "ChunkDeck.h"
+#include "IndexedDeck.h"
+#include "Rng.h"
+#include "SharedShoe.h"
+#include "Simulator.h"
+#include "Scenario.h"
+#include "CardFormat.h"
+#include "PlayedPile.h"
+#include "Solver.h"
+#include "SuitHand.h"
+#include "ResultFile.h"
+#include "Campaign.h"
+#include "DeckDiff.h"
+
+#define BENCH_RNG_DRAWS 50000000 // random numbers drawn per rng measurement
+#define BENCH_SHUFFLE_CARDS 10000000 // cards shuffled per deck size, spread over repeats
+#define BENCH_HAND_OPS 200000 // random-position operations per hand size
+#define BENCH_SHOE_DRAWS 2000000 // cards drawn per thread from the shared shoe
+#define BENCH_SHOE_PACKS 8 // packs in the shared shoe
+#define BENCH_GAMES_MAX_TURNS 1000 // turn limit of every simulated game
+#define BENCH_SCENARIOS 200000 // scenarios written to and replayed from the scenario file
+#define BENCH_FORMAT_CARDS 20000000 // cards written per format measurement, spread over repeats
+#define BENCH_PILE_CARDS 20000000 // cards played and recycled per played pile measurement
+#define BENCH_SOLVER_POSITIONS 50 // game positions solved per depth
+#define BENCH_SOLVER_HAND 3 // positions are taken once a hand has this many cards
+#define BENCH_SOLVER_TABLE_BITS 20 // the solver table has 2^bits entries
+#define BENCH_RULES_SCANS 20000000 // hand scans per rule variant and hand size
+#define BENCH_RULES_TOPS 1024 // different top cards the scans cycle through
+#define BENCH_STRATEGY_QUERIES 5000000 // queries per hand size and way of answering
+#define BENCH_STRATEGY_GAMES 16384 // games played per strategy
+#define BENCH_RESULTS_ROWS 20000000 // game results written per encoding
+#define BENCH_RESULTS_BATCH 16384 // results per ResultWriter_add, a campaign batch
+#define BENCH_RESULTS_CAMPAIGN 200000 // campaign games played with and without a result file
+#define BENCH_BACKENDS_OPS 2000000 // operations of the differential check per starting deck size
+
+/**
+* Returns a monotonic-enough wall clock in seconds.
+*/
+double Bench_seconds(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+* Random numbers per second: raw 64-bit words and bounded draws
+* from the batched generator, against rand() for reference.
+*/
+static void Bench_rng(void) {
+	Rng rng;
+	Rng_seed(&rng, 1);
+	uint64_t sink = 0; // keeps the compiler from dropping the draws
+
+	double start = Bench_seconds();
+	for (int i = 0; i < BENCH_RNG_DRAWS; i++) {
+		sink ^= Rng_next64(&rng);
+	}
+	double words = Bench_seconds() - start;
+
+	start = Bench_seconds();
+	for (int i = 0; i < BENCH_RNG_DRAWS; i++) {
+		sink += Rng_bounded(&rng, 52);
+	}
+	double bounded = Bench_seconds() - start;
+
+	start = Bench_seconds();
+	for (int i = 0; i < BENCH_RNG_DRAWS; i++) {
+		sink += (uint64_t)(rand() % 52);
+	}
+	double crand = Bench_seconds() - start;
+
+	printf("rng: Rng_next64        %8.1f M/s\n", BENCH_RNG_DRAWS / words / 1e6);
+	printf("rng: Rng_bounded(52)   %8.1f M/s\n", BENCH_RNG_DRAWS / bounded / 1e6);
+	printf("rng: rand() %% 52       %8.1f M/s\n", BENCH_RNG_DRAWS / crand / 1e6);
+	printf("rng: (sink %llx)\n", (unsigned long long)(sink & 0xff));
+}
+
+/**
+* Shuffle time for decks of 1 up to 10,000 packs.
+*/
+static void Bench_shuffle(void) {
+	static const int packs[] = { 1, 8, 64, 1000, 10000 };
+	Rng rng;
+	Rng_seed(&rng, 2);
+
+	for (int p = 0; p < (int)(sizeof(packs) / sizeof(packs[0])); p++) {
+		CardDeck* deck = CardDeck_createOrdered(packs[p]);
+		if (deck == NULL) {
+			printf("shuffle: no memory for %d packs\n", packs[p]);
+			return;
+		}
+		int cards = packs[p] * PACK_SIZE;
+		int repeats = BENCH_SHUFFLE_CARDS / cards > 0 ? BENCH_SHUFFLE_CARDS / cards : 1;
+
+		double start = Bench_seconds();
+		for (int r = 0; r < repeats; r++) {
+			CardDeck_shuffleWith(deck, &rng);
+		}
+		double elapsed = Bench_seconds() - start;
+
+		printf("shuffle: %6d packs %8d cards %12.3f us/shuffle %8.2f ns/card\n",
+			packs[p], cards, elapsed / repeats * 1e6, elapsed / repeats / cards * 1e9);
+		CardDeck_delete(deck);
+	}
+}
+
+/**
+* Parallel shuffle of a 10,000-pack shoe against the sequential linear
+* shuffle, for 1, 2, 4, ... threads up to the number of processors.
+*/
+static void Bench_shuffleParallel(void) {
+	const int numPacks = 10000;
+	const int repeats = 10;
+	Rng rng;
+	Rng_seed(&rng, 3);
+
+	CardDeck* deck = CardDeck_createOrdered(numPacks);
+	if (deck == NULL) {
+		printf("shuffle-parallel: no memory for %d packs\n", numPacks);
+		return;
+	}
+
+	double start = Bench_seconds();
+	for (int r = 0; r < repeats; r++) {
+		CardDeck_shuffleWith(deck, &rng);
+	}
+	double sequential = (Bench_seconds() - start) / repeats;
+	printf("shuffle-parallel: %d packs sequential %10.3f ms\n", numPacks, sequential * 1e3);
+
+	int maxThreads = CardDeck_hardwareThreads();
+	if (maxThreads < 2) maxThreads = 2; // always show at least one parallel run
+	for (int threads = 1; threads <= maxThreads && threads <= CARDDECK_MAX_THREADS; threads *= 2) {
+		start = Bench_seconds();
+		for (int r = 0; r < repeats; r++) {
+			CardDeck_shuffleParallel(deck, &rng, threads);
+		}
+		double parallel = (Bench_seconds() - start) / repeats;
+		printf("shuffle-parallel: %d packs %2d threads %10.3f ms  speedup %5.2fx\n",
+			numPacks, threads, parallel * 1e3, sequential / parallel);
+	}
+	CardDeck_delete(deck);
+}
+
+/**
+* Large player hands: count, look at, remove and re-insert cards at random
+* positions, on the list deck, the chunked deck and the indexed deck.
+*/
+static void Bench_hand(void) {
+	static const int handSizes[] = { 16, 256, 4096, 65536 };
+
+	for (int h = 0; h < (int)(sizeof(handSizes) / sizeof(handSizes[0])); h++) {
+		int numPacks = (handSizes[h] + PACK_SIZE - 1) / PACK_SIZE;
+		int size = numPacks * PACK_SIZE;
+		int ops = BENCH_HAND_OPS * 16 / handSizes[h] > 0 ? BENCH_HAND_OPS * 16 / handSizes[h] : 1;
+		Rng rng;
+		deckError err;
+		long long sink = 0;
+
+		CardDeck* list = CardDeck_createOrdered(numPacks);
+		Rng_seed(&rng, 4);
+		double start = Bench_seconds();
+		for (int i = 0; i < ops; i++) {
+			int count = CardDeck_count(list);
+			int index = (int)Rng_bounded(&rng, (uint32_t)count);
+			sink += CardDeck_cardNodeAt(list, index, &err)->card.rank;
+			Card* card = CardDeck_removeAt(list, (int)Rng_bounded(&rng, (uint32_t)count), &err);
+			CardDeck_insertToTop(list, *card);
+			free(card);
+		}
+		double listTime = (Bench_seconds() - start) / ops;
+		CardDeck_delete(list);
+
+		ChunkDeck* chunked = ChunkDeck_create();
+		ChunkDeck_fillDeck(chunked, numPacks);
+		Rng_seed(&rng, 4);
+		start = Bench_seconds();
+		for (int i = 0; i < ops; i++) {
+			int count = ChunkDeck_count(chunked);
+			int index = (int)Rng_bounded(&rng, (uint32_t)count);
+			sink += ChunkDeck_cardAt(chunked, index, &err).rank;
+			Card card = ChunkDeck_removeAt(chunked, (int)Rng_bounded(&rng, (uint32_t)count), &err);
+			ChunkDeck_insertToTop(chunked, card);
+		}
+		double chunkTime = (Bench_seconds() - start) / ops;
+		ChunkDeck_delete(chunked);
+
+		IndexedDeck* indexed = IndexedDeck_create();
+		IndexedDeck_fillDeck(indexed, numPacks);
+		Rng_seed(&rng, 4);
+		start = Bench_seconds();
+		for (int i = 0; i < ops; i++) {
+			int count = IndexedDeck_count(indexed);
+			int index = (int)Rng_bounded(&rng, (uint32_t)count);
+			sink += IndexedDeck_cardAt(indexed, index, &err).rank;
+			Card card = IndexedDeck_removeAt(indexed, (int)Rng_bounded(&rng, (uint32_t)count), &err);
+			IndexedDeck_insertToTop(indexed, card);
+		}
+		double indexedTime = (Bench_seconds() - start) / ops;
+		IndexedDeck_delete(indexed);
+
+		printf("hand: %6d cards  list %10.1f ns/op  chunked %8.1f ns/op (%6.2fx)  indexed %8.1f ns/op (%6.2fx) (sink %lld)\n",
+			size, listTime * 1e9, chunkTime * 1e9, listTime / chunkTime,
+			indexedTime * 1e9, listTime / indexedTime, sink & 1);
+	}
+}
+
+typedef struct {
+	CardDeck* deck; // shoe of the locked variant
+	mtx_t* lock; // guards deck
+	SharedShoe* shoe; // shoe of the lock-free variant
+	int batch; // cards per SharedShoe_drawBatch call
+	unsigned checksum; // keeps the draws from being optimized away
+} ShoeTable;
+
+/**
+* One table drawing from a CardDeck behind a mutex, refilling it when empty.
+*/
+static int Bench_shoeLocked(void* arg) {
+	ShoeTable* table = (ShoeTable*)arg;
+	for (int i = 0; i < BENCH_SHOE_DRAWS; i++) {
+		mtx_lock(table->lock);
+		Card* card = CardDeck_useTop(table->deck, NULL);
+		if (card == NULL) {
+			CardDeck_fillDeck(table->deck, BENCH_SHOE_PACKS);
+			CardDeck_shuffle(table->deck);
+			card = CardDeck_useTop(table->deck, NULL);
+		}
+		mtx_unlock(table->lock);
+		table->checksum += card->rank;
+		free(card);
+	}
+	return 0;
+}
+
+/**
+* One table drawing from the lock-free shared shoe.
+*/
+static int Bench_shoeShared(void* arg) {
+	ShoeTable* table = (ShoeTable*)arg;
+	Card cards[16];
+	for (int drawn = 0; drawn < BENCH_SHOE_DRAWS; ) {
+		int want = BENCH_SHOE_DRAWS - drawn < table->batch ? BENCH_SHOE_DRAWS - drawn : table->batch;
+		int got = SharedShoe_drawBatch(table->shoe, cards, want);
+		for (int i = 0; i < got; i++) table->checksum += cards[i].rank;
+		drawn += got;
+	}
+	return 0;
+}
+
+/**
+* Runs one table per thread and returns the draws per second of all tables.
+*/
+static double Bench_shoeTables(ShoeTable* tables, int numThreads, thrd_start_t table) {
+	thrd_t threads[CARDDECK_MAX_THREADS];
+	double start = Bench_seconds();
+	for (int t = 1; t < numThreads; t++) {
+		thrd_create(&threads[t], table, &tables[t]);
+	}
+	table(&tables[0]);
+	for (int t = 1; t < numThreads; t++) {
+		thrd_join(threads[t], NULL);
+	}
+	return (double)BENCH_SHOE_DRAWS * numThreads / (Bench_seconds() - start);
+}
+
+/**
+* Compares tables drawing from one shoe through a mutex with the lock-free
+* SharedShoe, drawing single cards and batches of 8.
+*/
+static void Bench_shoe(void) {
+	ShoeTable tables[CARDDECK_MAX_THREADS];
+	mtx_t lock;
+	mtx_init(&lock, mtx_plain);
+	CardDeck* deck = CardDeck_createOrdered(BENCH_SHOE_PACKS);
+	CardDeck_shuffle(deck);
+	SharedShoe* shoe = SharedShoe_create(deck, 4);
+	if (shoe == NULL) {
+		printf("shoe: no memory\n");
+		CardDeck_delete(deck);
+		mtx_destroy(&lock);
+		return;
+	}
+
+	int maxThreads = CardDeck_hardwareThreads();
+	if (maxThreads < 2) maxThreads = 2; // always show at least one contended run
+	for (int threads = 1; threads <= maxThreads && threads <= CARDDECK_MAX_THREADS; threads *= 2) {
+		for (int t = 0; t < threads; t++) {
+			tables[t] = (ShoeTable){ deck, &lock, shoe, 1, 0 };
+		}
+		double locked = Bench_shoeTables(tables, threads, Bench_shoeLocked);
+		double shared = Bench_shoeTables(tables, threads, Bench_shoeShared);
+		for (int t = 0; t < threads; t++) tables[t].batch = 8;
+		double batched = Bench_shoeTables(tables, threads, Bench_shoeShared);
+		printf("shoe: %2d threads  mutex %8.2f M/s  lock-free %8.2f M/s  batch 8 %8.2f M/s\n",
+			threads, locked * 1e-6, shared * 1e-6, batched * 1e-6);
+	}
+
+	SharedShoe_delete(shoe);
+	CardDeck_delete(deck);
+	mtx_destroy(&lock);
+}
+
+typedef long long (*SimRun)(Simulator* sim, int width);
+
+static long long Bench_gamesSequential(Simulator* sim, int width) {
+	return Simulator_runSequential(sim);
+}
+
+static long long Bench_gamesLockstep(Simulator* sim, int width) {
+	return Simulator_runLockstep(sim);
+}
+
+/**
+* Plays numGames fresh games with run and returns the turns per second.
+*/
+static double Bench_gamesRun(int numGames, SimRun run, int width) {
+	Simulator* sim = Simulator_create(numGames, 1, 5, BENCH_GAMES_MAX_TURNS);
+	if (sim == NULL) return 0.0;
+	double start = Bench_seconds();
+	long long turns = run(sim, width);
+	double rate = turns / (Bench_seconds() - start);
+	Simulator_delete(sim);
+	return rate;
+}
+
+/**
+* Compares turns per second of games played one at a time to completion
+* with games that take one turn each per round, first turn by turn
+* (lockstep) and then interleaved with prefetching.
+*/
+static void Bench_games(void) {
+	static const int gameCounts[] = { 64, 1024, 16384, 131072 };
+	static const int widths[] = { 8, 16, 32 };
+
+	for (int g = 0; g < (int)(sizeof(gameCounts) / sizeof(gameCounts[0])); g++) {
+		int numGames = gameCounts[g];
+		double sequential = Bench_gamesRun(numGames, Bench_gamesSequential, 0);
+		double lockstep = Bench_gamesRun(numGames, Bench_gamesLockstep, 0);
+		if (sequential == 0.0 || lockstep == 0.0) {
+			printf("games: no memory for %d games\n", numGames);
+			return;
+		}
+		printf("games: %6d games  one at a time %6.2f M turns/s  lockstep %6.2f M turns/s\n",
+			numGames, sequential * 1e-6, lockstep * 1e-6);
+		for (int w = 0; w < (int)(sizeof(widths) / sizeof(widths[0])); w++) {
+			double interleaved = Bench_gamesRun(numGames, Simulator_runInterleaved, widths[w]);
+			printf("games: %6d games  %2d interleaved %6.2f M turns/s  %5.2fx lockstep\n",
+				numGames, widths[w], interleaved * 1e-6, interleaved / lockstep);
+		}
+	}
+}
+
+/**
+* Writes BENCH_SCENARIOS dealt games to a scenario file, then compares the
+* cost of loading a game from the mapped file with dealing a new game and
+* with playing the loaded game to the end.
+*/
+static void Bench_scenario(void) {
+	const char* path = "cardgame_bench_scenarios.bin";
+	ScenarioRecord* records = (ScenarioRecord*)malloc(BENCH_SCENARIOS * Scenario_recordSize(1));
+	if (records == NULL) {
+		printf("scenario: no memory\n");
+		return;
+	}
+	Rng rng;
+	Rng_seed(&rng, 8);
+	Game game;
+
+	double start = Bench_seconds();
+	for (int i = 0; i < BENCH_SCENARIOS; i++) {
+		Game_init(&game, 1, &rng);
+		Scenario_capture(&game, (uint64_t)i, 1, ScenarioRecord_at(records, 1, i));
+		Game_free(&game);
+	}
+	double deal = (Bench_seconds() - start) / BENCH_SCENARIOS;
+	int written = ScenarioFile_write(path, records, BENCH_SCENARIOS, 1);
+	free(records);
+	ScenarioFile* file = written == 0 ? ScenarioFile_open(path) : NULL;
+	if (file == NULL) {
+		printf("scenario: cannot write or map %s\n", path);
+		remove(path);
+		return;
+	}
+
+	start = Bench_seconds();
+	for (int i = 0; i < file->count; i++) {
+		Scenario_newGame(ScenarioFile_at(file, i), &game, &rng);
+		Game_free(&game);
+	}
+	double load = (Bench_seconds() - start) / file->count;
+
+	long long turns = 0;
+	start = Bench_seconds();
+	for (int i = 0; i < file->count; i++) {
+		Scenario_newGame(ScenarioFile_at(file, i), &game, &rng);
+		for (int t = 0; t < BENCH_GAMES_MAX_TURNS && game.status == ongoing; t++) {
+			Game_playTurn(&game);
+			turns++;
+		}
+		Game_free(&game);
+	}
+	double replay = (Bench_seconds() - start) / file->count;
+
+	printf("scenario: %d scenarios, %zu bytes each\n", file->count, Scenario_recordSize(file->packs));
+	printf("scenario: deal and shuffle %8.1f ns/game\n", deal * 1e9);
+	printf("scenario: load from file   %8.1f ns/game\n", load * 1e9);
+	printf("scenario: load and play    %8.1f ns/game (%.1f turns/game, load is %.0f%%)\n",
+		replay * 1e9, (double)turns / file->count, 100.0 * load / replay);
+	ScenarioFile_close(file);
+	remove(path);
+}
+
+/**
+* Writes a deck the way CardDeck_print used to, two or three printf calls per card.
+*/
+static void Bench_printfDeck(const CardDeck* deck, FILE* out) {
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	fprintf(out, "deck: \n");
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		fprintf(out, "%s-%s", suitNames[card->suit], rankNames[card->rank]);
+		if (CardDeckIter_peek(&it) != NULL) {
+			fprintf(out, ", ");
+		}
+	}
+	fprintf(out, "\n");
+}
+
+/**
+* Writes whole decks of 1 and 64 packs to a temporary file with printf per
+* card and with the formatter in both styles.
+*/
+static void Bench_format(void) {
+	static const int packs[] = { 1, 64 };
+	FILE* out = tmpfile();
+	if (out == NULL) {
+		printf("format: cannot open a temporary file\n");
+		return;
+	}
+
+	for (int p = 0; p < (int)(sizeof(packs) / sizeof(packs[0])); p++) {
+		CardDeck* deck = CardDeck_create();
+		if (deck == NULL || CardDeck_fillDeck(deck, packs[p]) == NULL) {
+			printf("format: no memory\n");
+			CardDeck_delete(deck);
+			break;
+		}
+		CardDeck_shuffleWith(deck, Rng_default());
+		int cards = packs[p] * PACK_SIZE;
+		int repeats = BENCH_FORMAT_CARDS / cards;
+		double times[3];
+
+		for (int method = 0; method < 3; method++) {
+			rewind(out);
+			double start = Bench_seconds();
+			for (int r = 0; r < repeats; r++) {
+				if (r % 64 == 0) rewind(out); // keep the file small
+				if (method == 0) Bench_printfDeck(deck, out);
+				else CardFormat_printDeck(deck, method == 1 ? formatLong : formatShort, out);
+			}
+			fflush(out);
+			times[method] = (Bench_seconds() - start) / ((double)repeats * cards);
+		}
+		printf("format: %2d pack(s) printf %6.1f ns/card, formatter %6.1f ns/card (%.1fx), short %6.1f ns/card\n",
+			packs[p], times[0] * 1e9, times[1] * 1e9, times[0] / times[1], times[2] * 1e9);
+		CardDeck_delete(deck);
+	}
+	fclose(out);
+}
+
+/**
+* Plays whole shoes onto a played deck and recycles them into the hidden
+* deck, once with a linked CardDeck as the played deck and once with a
+* PlayedPile. Emptying the hidden deck again is not timed.
+*/
+static void Bench_pile(void) {
+	static const int packs[] = { 1, 8 };
+	Rng rng;
+	Rng_seed(&rng, 41);
+
+	for (int p = 0; p < (int)(sizeof(packs) / sizeof(packs[0])); p++) {
+		int cards = packs[p] * PACK_SIZE;
+		int repeats = BENCH_PILE_CARDS / cards;
+		CardDeck hidden;
+		CardDeck played;
+		PlayedPile pile;
+		if (CardDeck_init(&hidden) != ok || CardDeck_init(&played) != ok || PlayedPile_init(&pile) != ok) {
+			printf("pile: no memory\n");
+			CardDeck_destroy(&hidden);
+			CardDeck_destroy(&played);
+			PlayedPile_destroy(&pile);
+			return;
+		}
+
+		double play[2] = { 0.0, 0.0 };
+		double recycle[2] = { 0.0, 0.0 };
+		for (int method = 0; method < 2; method++) {
+			for (int r = 0; r < repeats; r++) {
+				double start = Bench_seconds();
+				for (int c = 0; c < cards; c++) {
+					if (method == 0) CardDeck_insertToTop(&played, orderedPack[c % PACK_SIZE]);
+					else PlayedPile_push(&pile, orderedPack[c % PACK_SIZE]);
+				}
+				double middle = Bench_seconds();
+				if (method == 0) CardDeck_recycleHiddenWith(&hidden, &played, &rng);
+				else PlayedPile_recycleInto(&pile, &hidden, &rng);
+				double recycled = Bench_seconds();
+				play[method] += middle - start;
+				recycle[method] += recycled - middle;
+				CardDeck_destroy(&hidden);
+				CardDeck_init(&hidden);
+			}
+		}
+
+		double scale = 1e9 / ((double)repeats * cards);
+		printf("pile: %d pack(s) linked played deck: play %5.1f ns/card, recycle and shuffle %5.1f ns/card\n",
+			packs[p], play[0] * scale, recycle[0] * scale);
+		printf("pile: %d pack(s) played pile:        play %5.1f ns/card, recycle and shuffle %5.1f ns/card\n",
+			packs[p], play[1] * scale, recycle[1] * scale);
+		CardDeck_destroy(&hidden);
+		CardDeck_destroy(&played);
+		PlayedPile_destroy(&pile);
+	}
+}
+
+/**
+* Solves endgames from random games at growing depths, with the table
+* cleared before every position, and grades the first matching card that
+* Game_playTurn plays against the solver's best card.
+*/
+static void Bench_solver(void) {
+	static const int depths[] = { 4, 5, 6 };
+	SolverTable* table = SolverTable_create(BENCH_SOLVER_TABLE_BITS);
+	if (table == NULL) {
+		printf("solver: no memory\n");
+		return;
+	}
+
+	for (int d = 0; d < (int)(sizeof(depths) / sizeof(depths[0])); d++) {
+		Rng rng;
+		Rng_seed(&rng, 42);
+		SolverStats total;
+		memset(&total, 0, sizeof(total));
+		int positions = 0;
+		int exact = 0;
+		int graded = 0;
+		int suboptimal = 0;
+		double regret = 0.0;
+		for (int i = 0; i < BENCH_SOLVER_POSITIONS; i++) {
+			Game game;
+			if (Game_init(&game, 1, &rng) != ok) {
+				Game_free(&game);
+				continue;
+			}
+			// play on until a hand is down to its last few cards
+			for (int t = 0; t < BENCH_GAMES_MAX_TURNS && game.status == ongoing &&
+				CardDeck_count(&game.p1) > BENCH_SOLVER_HAND && CardDeck_count(&game.p2) > BENCH_SOLVER_HAND; t++) {
+				Game_playTurn(&game);
+			}
+			SolverState state;
+			if (game.status == ongoing && Solver_stateFromGame(&game, &state) == ok) {
+				SolverTable_clear(table);
+				SolverStats stats;
+				SolverResult best = Solver_solve(table, &state, depths[d], &stats);
+				total.nodes += stats.nodes;
+				total.probes += stats.probes;
+				total.hits += stats.hits;
+				total.seconds += stats.seconds;
+				positions++;
+				exact += best.exact;
+
+				int match = CardDeck_findMatch(&game);
+				SolverState next;
+				if (match >= 0 && best.bestCard != SOLVER_DRAW) {
+					const CardDeck* hand = game.turn == 0 ? &game.p1 : &game.p2;
+					CardDeckIter it = CardDeck_iter(hand);
+					const Card* card = NULL;
+					for (int m = 0; m <= match; m++) card = CardDeckIter_next(&it);
+					if (card != NULL && Solver_play(&state, Card_pack(*card), &next) == ok) {
+						double loss = best.winChance - (1.0 - Solver_solve(table, &next, depths[d] - 1, NULL).winChance);
+						regret += loss;
+						suboptimal += loss > 1e-9;
+						graded++;
+					}
+				}
+			}
+			Game_free(&game);
+		}
+
+		printf("solver: depth %d  %4d positions (%3d exact)  %8.2f M nodes/s  %5.1f%% table hits  %7.3f ms/position\n",
+			depths[d], positions, exact, total.seconds > 0.0 ? total.nodes / total.seconds / 1e6 : 0.0,
+			total.probes > 0 ? 100.0 * total.hits / total.probes : 0.0, positions > 0 ? total.seconds * 1e3 / positions : 0.0);
+		printf("solver: depth %d  first match is not the best card in %d of %d positions, mean loss %.4f win chance\n",
+			depths[d], suboptimal, graded, graded > 0 ? regret / graded : 0.0);
+	}
+	SolverTable_delete(table);
+}
+
+/**
+* CardDeck_findMatch as it was before rule variants: suit or rank, hard-coded.
+*/
+static int Bench_findMatchFixed(const Game* game) {
+	const Card* target = PlayedPile_top(&game->played);
+	if (target == NULL) return -1;
+	CardDeckIter hand = CardDeck_iter(game->turn == 0 ? &game->p1 : &game->p2);
+	const Card* currentCard;
+	while ((currentCard = CardDeckIter_next(&hand)) != NULL) {
+		if (currentCard->suit == target->suit || currentCard->rank == target->rank) return hand.index - 1;
+	}
+	return -1;
+}
+
+/**
+* Scans the same hands against the same top cards with the hard-coded
+* suit-or-rank scan and with CardDeck_findMatch under every rule variant.
+* The standard variant should cost the same as the hard-coded scan.
+*/
+static void Bench_rules(void) {
+	static const int handSizes[] = { 8, 64 };
+	Rng rng;
+	Rng_seed(&rng, 43);
+	PackedCard tops[BENCH_RULES_TOPS];
+	for (int i = 0; i < BENCH_RULES_TOPS; i++) tops[i] = (PackedCard)Rng_bounded(&rng, PACK_SIZE);
+
+	for (int h = 0; h < (int)(sizeof(handSizes) / sizeof(handSizes[0])); h++) {
+		Game game;
+		if (Game_initDecks(&game, &rng) != ok) {
+			printf("rules: no memory\n");
+			return;
+		}
+		for (int c = 0; c < handSizes[h]; c++) {
+			CardDeck_insertToTop(&game.p1, orderedPack[Rng_bounded(&rng, PACK_SIZE)]);
+		}
+		PlayedPile_push(&game.played, orderedPack[0]);
+
+		long long sink = 0;
+		double start = Bench_seconds();
+		for (int i = 0; i < BENCH_RULES_SCANS; i++) {
+			game.played.top = tops[i % BENCH_RULES_TOPS];
+			sink += Bench_findMatchFixed(&game);
+		}
+		double fixed = (Bench_seconds() - start) / BENCH_RULES_SCANS;
+		printf("rules: %2d cards  hard-coded   %6.2f ns/scan\n", handSizes[h], fixed * 1e9);
+
+		for (int rules = 0; rules < rulesCount; rules++) {
+			game.rules = (RuleVariant)rules;
+			start = Bench_seconds();
+			for (int i = 0; i < BENCH_RULES_SCANS; i++) {
+				game.played.top = tops[i % BENCH_RULES_TOPS];
+				sink += CardDeck_findMatch(&game);
+			}
+			double variant = (Bench_seconds() - start) / BENCH_RULES_SCANS;
+			printf("rules: %2d cards  %-12s %6.2f ns/scan (%5.2fx hard-coded)\n",
+				handSizes[h], ruleNames[rules], variant * 1e9, variant / fixed);
+		}
+		printf("rules: (sink %lld)\n", sink & 1);
+		Game_free(&game);
+	}
+}
+
+/**
+* Highest card matching the top card, found by walking the hand.
+*/
+static int Bench_highestByWalk(const CardDeck* deck, const Card* top) {
+	CardDeckIter hand = CardDeck_iter(deck);
+	const Card* card;
+	int highest = -1;
+	while ((card = CardDeckIter_next(&hand)) != NULL) {
+		if ((card->suit == top->suit || card->rank == top->rank) && (int)card->rank > highest) highest = card->rank;
+	}
+	return highest;
+}
+
+/**
+* Strategy questions answered by walking the hand and by the suit-grouped
+* hand, then whole games with each strategy against first match.
+*/
+static void Bench_strategy(void) {
+	static const int handSizes[] = { 8, 64 };
+	static const char* names[] = { "first match", "highest", "longest suit" };
+	Rng rng;
+	Rng_seed(&rng, 44);
+
+	for (int h = 0; h < (int)(sizeof(handSizes) / sizeof(handSizes[0])); h++) {
+		CardDeck deck;
+		if (CardDeck_init(&deck) != ok) {
+			printf("strategy: no memory\n");
+			return;
+		}
+		for (int c = 0; c < handSizes[h]; c++) {
+			CardDeck_insertToTop(&deck, orderedPack[Rng_bounded(&rng, PACK_SIZE)]);
+		}
+		SuitHand hand;
+		SuitHand_fromDeck(&hand, &deck);
+
+		long long sink = 0;
+		double start = Bench_seconds();
+		for (int i = 0; i < BENCH_STRATEGY_QUERIES; i++) {
+			const Card* top = &orderedPack[i % PACK_SIZE];
+			sink += Bench_highestByWalk(&deck, top);
+		}
+		double walk = (Bench_seconds() - start) / BENCH_STRATEGY_QUERIES;
+		start = Bench_seconds();
+		for (int i = 0; i < BENCH_STRATEGY_QUERIES; i++) {
+			Card card = INVALID_CARD;
+			SuitHand_highestMatch(&hand, rulesStandard, &orderedPack[i % PACK_SIZE], &card);
+			sink += card.rank;
+		}
+		double grouped = (Bench_seconds() - start) / BENCH_STRATEGY_QUERIES;
+		printf("strategy: %2d cards highest match  walk %7.2f ns  suit-grouped %6.2f ns (%5.1fx) (sink %lld)\n",
+			handSizes[h], walk * 1e9, grouped * 1e9, walk / grouped, sink & 1);
+		CardDeck_destroy(&deck);
+	}
+
+	for (int strategy = strategyFirstMatch; strategy <= strategyLongestSuit; strategy++) {
+		Simulator* sim = Simulator_create(BENCH_STRATEGY_GAMES, 1, 44, BENCH_GAMES_MAX_TURNS);
+		if (sim == NULL) {
+			printf("strategy: no memory\n");
+			return;
+		}
+		int wins[2] = { 0, 0 };
+		for (int i = 0; i < sim->count; i++) Game_setStrategy(&sim->games[i].game, (GameStrategy)strategy);
+		double start = Bench_seconds();
+		long long turns = Simulator_runSequential(sim);
+		double elapsed = Bench_seconds() - start;
+		for (int i = 0; i < sim->count; i++) {
+			if (sim->games[i].game.status == win) wins[sim->games[i].game.turn]++;
+		}
+		printf("strategy: %-12s %6.1f ns/turn  %5.1f turns/game  player 1 wins %5.1f%%\n",
+			names[strategy], elapsed / turns * 1e9, (double)turns / sim->count, 100.0 * wins[0] / sim->count);
+		Simulator_delete(sim);
+	}
+}
+
+/**
+* Writes game results taken from real games to a result file with fixed
+* columns and with varints, reads them back, and compares a campaign that
+* writes its results with one that does not.
+*/
+static void Bench_results(void) {
+	static const char* names[] = { "fixed", "varint" };
+	const char* path = "cardgame_bench_results.bin";
+	GameResult* results = (GameResult*)malloc(BENCH_RESULTS_BATCH * sizeof(GameResult));
+	uint64_t* values = (uint64_t*)malloc(RESULT_BLOCK_ROWS * sizeof(uint64_t));
+	Simulator* sim = Simulator_create(BENCH_RESULTS_BATCH, 1, 46, BENCH_GAMES_MAX_TURNS);
+	if (results == NULL || values == NULL || sim == NULL) {
+		printf("results: no memory\n");
+		free(results);
+		free(values);
+		Simulator_delete(sim);
+		return;
+	}
+	Simulator_runInterleaved(sim, CAMPAIGN_WIDTH);
+	for (int i = 0; i < sim->count; i++) {
+		GameResult_capture(&sim->games[i].game, (uint64_t)i, sim->games[i].turns, &results[i]);
+	}
+	Simulator_delete(sim);
+
+	for (int flags = 0; flags <= RESULT_VARINT; flags += RESULT_VARINT) {
+		double start = Bench_seconds();
+		ResultWriter* writer = ResultWriter_open(path, 46, flags);
+		if (writer == NULL) {
+			printf("results: cannot create %s\n", path);
+			break;
+		}
+		uint64_t rows = 0;
+		double adding = 0;
+		while (rows < BENCH_RESULTS_ROWS) {
+			for (int i = 0; i < BENCH_RESULTS_BATCH; i++) results[i].game = rows + (uint64_t)i;
+			double before = Bench_seconds();
+			ResultWriter_add(writer, results, BENCH_RESULTS_BATCH);
+			adding += Bench_seconds() - before;
+			rows += BENCH_RESULTS_BATCH;
+		}
+		int failed = ResultWriter_close(writer);
+		double write = Bench_seconds() - start;
+
+		start = Bench_seconds();
+		ResultFile* file = failed == 0 ? ResultFile_open(path) : NULL;
+		uint64_t turns = 0;
+		long long skipped = 0;
+		for (int b = 0; file != NULL && b < file->count; b++) {
+			int count = ResultFile_readColumn(file, b, resultTurns, values);
+			for (int i = 0; i < count; i++) turns += values[i];
+			skipped += ResultFile_block(file, b)->columns[resultTurns].max < BENCH_GAMES_MAX_TURNS; // blocks a search for unfinished games would skip
+		}
+		double read = Bench_seconds() - start;
+		if (file == NULL) {
+			printf("results: cannot write or map %s\n", path);
+			break;
+		}
+		printf("results: %-6s %llu games, %5.2f bytes/game, add %5.1f ns/game, written at %6.1f M games/min, "
+			"turns read at %6.1f M games/s (%lld of %d blocks hold no unfinished game)\n",
+			names[flags], (unsigned long long)file->rows, (double)file->size / file->rows, adding / rows * 1e9,
+			rows / write * 60e-6, rows / read * 1e-6, skipped, file->count);
+		ResultFile_close(file);
+	}
+	free(results);
+	free(values);
+
+	double elapsed[2];
+	for (int withFile = 0; withFile < 2; withFile++) {
+		Campaign campaign;
+		Campaign_init(&campaign, 46, BENCH_RESULTS_CAMPAIGN, 1, BENCH_GAMES_MAX_TURNS);
+		campaign.results = withFile ? ResultWriter_open(path, campaign.seed, RESULT_VARINT) : NULL;
+		double start = Bench_seconds();
+		Campaign_run(&campaign, 0, NULL, 0);
+		ResultWriter_close(campaign.results);
+		elapsed[withFile] = Bench_seconds() - start;
+	}
+	printf("results: campaign %6.1f ns/game without a result file, %6.1f ns/game with one (%+.1f%%)\n",
+		elapsed[0] / BENCH_RESULTS_CAMPAIGN * 1e9, elapsed[1] / BENCH_RESULTS_CAMPAIGN * 1e9,
+		100.0 * (elapsed[1] / elapsed[0] - 1));
+	remove(path);
+}
+
+/**
+* Plays the differential check of the deck backends and reports the
+* operations per second of each backend from the same runs.
+*/
+static void Bench_backends(void) {
+	static const int packs[] = { 1, 4 };
+	for (int p = 0; p < (int)(sizeof(packs) / sizeof(packs[0])); p++) {
+		DiffReport report;
+		int differing = DeckDiff_run(47, BENCH_BACKENDS_OPS, packs[p], &report);
+		if (differing < 0) {
+			printf("backends: no memory\n");
+			return;
+		}
+		printf("backends: %d pack(s), %lld ops: %lld inserts, %lld useTop, %lld removeAt, %lld findMatch, "
+			"%lld sorts, %lld shuffles, %lld recycles\n", packs[p], (long long)BENCH_BACKENDS_OPS,
+			report.opCounts[diffInsertToTop], report.opCounts[diffUseTop], report.opCounts[diffRemoveAt],
+			report.opCounts[diffFindMatch], report.opCounts[diffSort], report.opCounts[diffShuffle],
+			report.opCounts[diffRecycleHidden]);
+		for (int b = 0; b < diffBackends; b++) {
+			const DiffBackendReport* backend = &report.backends[b];
+			printf("backends:   %-8s %8.2f M ops/s (%4.2fx list)", backend->name, backend->ops / backend->seconds * 1e-6,
+				report.backends[diffList].seconds / report.backends[diffList].ops * backend->ops / backend->seconds);
+			if (backend->mismatch >= 0) printf("  DIFFERS after operation %lld", backend->mismatch);
+			printf("\n");
+		}
+	}
+}
+
+static const Benchmark benchmarks[] = {
+	{ "rng", Bench_rng },
+	{ "shuffle", Bench_shuffle },
+	{ "shuffle-parallel", Bench_shuffleParallel },
+	{ "hand", Bench_hand },
+	{ "shoe", Bench_shoe },
+	{ "games", Bench_games },
+	{ "scenario", Bench_scenario },
+	{ "format", Bench_format },
+	{ "pile", Bench_pile },
+	{ "solver", Bench_solver },
+	{ "rules", Bench_rules },
+	{ "strategy", Bench_strategy },
+	{ "results", Bench_results },
+	{ "backends", Bench_backends },
+};
+
+/**
+* Runs one benchmark by name, or all of them.
+*
+* @param name Name of the benchmark, NULL runs every benchmark
+* @return EXIT_SUCCESS, or EXIT_FAILURE if no benchmark has that name
+*/
+int Bench_run(const char* name) {
+	int found = 0;
+	for (int i = 0; i < (int)(sizeof(benchmarks) / sizeof(benchmarks[0])); i++) {
+		if (name == NULL || strcmp(name, benchmarks[i].name) == 0) {
+			benchmarks[i].run();
+			found = 1;
+		}
+	}
+	if (!found) {
+		printf("unknown benchmark %s\n", name);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
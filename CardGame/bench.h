@@ -0,0 +1,21 @@
+/**
+ * @file bench.h
+ * Provides interface for the micro benchmarks of the deck operations.
+ * Run them with "<program> bench" for all of them, or
+ * "<program> bench <name>" for a single one.
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+typedef struct {
+	const char* name; // name used on the command line
+	void (*run)(void); // runs the benchmark and prints its results
+} Benchmark;
+
+double Bench_seconds(void);
+int Bench_run(const char* name);
+
+#endif
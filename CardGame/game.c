@@ -6,28 +6,193 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "game.h"
 #include "CardDeck.h"
+#include "Instrument.h"
+#include "Trace.h"
+
+/*
+* Game_initDecks
+*
+* sets up a game with four empty decks, player 1 has the first turn
+* used by Game_init, and by loaders that put the cards in place themselves
+*
+* if a deck cannot be created the decks created so far are freed again
+*/
+
+deckError Game_initDecks(Game* game, Rng* rng)
+{
+	game->status = ongoing;
+	game->turn = 0;
+	game->verbose = 0;
+	game->rng = rng;
+	game->rules = rulesStandard;
+	game->strategy = strategyFirstMatch;
+	game->hands = NULL;
+	game->recycles = 0;
+	game->shoe = 0;
+
+	// every deck starts with just a head node, the played pile with an empty buffer
+	// the pile comes first, it can be destroyed even if setting it up failed
+	game->hidden.head = game->p1.head = game->p2.head = NULL;
+	if (PlayedPile_init(&game->played) != ok || CardDeck_init(&game->hidden) != ok ||
+		CardDeck_init(&game->p1) != ok || CardDeck_init(&game->p2) != ok)
+	{
+		Game_free(game);
+		return noMemory;
+	}
+	return ok;
+}
+
+/*
+* Game_init
+*
+* sets up a new game: creates the four decks, fills the hidden deck
+* with numPacks packs, shuffles it with rng and deals the cards
+* player 1 has the first turn
+*
+* if anything goes wrong the decks created so far are freed again
+* and the error code is returned
+*/
+
+deckError Game_init(Game* game, int numPacks, Rng* rng)
+{
+	deckError err = Game_initDecks(game, rng);
+	if (err != ok)
+	{
+		return err;
+	}
+
+	// fill and shuffle the hidden deck
+	if (CardDeck_fillDeck(&game->hidden, numPacks) == NULL)
+	{
+		Game_free(game);
+		return noMemory;
+	}
+	err = CardDeck_shuffleWith(&game->hidden, rng != NULL ? rng : Rng_default());
+	if (err == ok)
+	{
+		err = Game_deal(game);
+	}
+	if (err != ok)
+	{
+		Game_free(game);
+	}
+	else
+	{
+		Game_recordShoe(game);
+	}
+	return err;
+}
+
+/*
+* Game_recordShoe
+*
+* records the cards the game holds now as the ones it must keep, so
+* Game_checkCards can tell later if a card was lost or doubled
+* Game_init calls it, loaders that put the cards in place themselves
+* call it once they are done
+*/
+
+void Game_recordShoe(Game* game)
+{
+	game->shoe = game->hidden.tally + game->played.tally + game->p1.tally + game->p2.tally;
+}
+
+/*
+* Game_checkCards
+*
+* checks that hidden, played, p1 and p2 together still hold the cards
+* recorded by Game_recordShoe, with a sum of the tallies the decks keep
+* up to date, so it costs the same at any size and can be left on in
+* long runs; a lost, doubled or changed card shows up as a different sum
+*
+* returns 1 if the cards are all there, 0 if not
+*/
+
+int Game_checkCards(const Game* game)
+{
+	return game->hidden.tally + game->played.tally + game->p1.tally + game->p2.tally == game->shoe;
+}
+
+/*
+* Game_free
+*
+* frees all cards of the game, the Game struct itself belongs to the caller
+*/
+
+void Game_free(Game* game)
+{
+	CardDeck_destroy(&game->hidden);
+	PlayedPile_destroy(&game->played);
+	CardDeck_destroy(&game->p1);
+	CardDeck_destroy(&game->p2);
+	free(game->hands);
+	game->hands = NULL;
+}
+
+/*
+* Game_setStrategy
+*
+* sets how both players pick the card they play
+* every strategy but first match asks suit-grouped copies of the hands,
+* which are built from the hands here and from then on kept up to date
+* by Game_deal and Game_finishTurn, first-match games do without them
+*
+* returns noMemory if the copies cannot be allocated, the strategy is
+* unchanged then
+*/
+
+deckError Game_setStrategy(Game* game, GameStrategy strategy)
+{
+	if (strategy != strategyFirstMatch && game->hands == NULL)
+	{
+		game->hands = (SuitHand*)malloc(2 * sizeof(SuitHand));
+		if (game->hands == NULL)
+		{
+			return noMemory;
+		}
+		SuitHand_fromDeck(&game->hands[0], &game->p1);
+		SuitHand_fromDeck(&game->hands[1], &game->p2);
+	}
+	game->strategy = strategy;
+	return ok;
+}
 
 /*
 * Game_deal
-* 
-* deals the first 8 cards of the game
+*
+* deals the first 8 cards of the game, 4 to each player, see Game_dealHands
+*
+*/
+
+deckError Game_deal(Game* game)
+{
+	return Game_dealHands(game, GAME_HAND_SIZE);
+}
+
+/*
+* Game_dealHands
+*
+* deals handSize cards to each player
 * always takes cards from the hidden deck and alternates betweeen player 1 and 2
-* so cards 0,2,4,6 go to player 1
-* cards 1,3,5,7 go to player 2
-* 
+* so cards 0,2,4,... go to player 1
+* cards 1,3,5,... go to player 2
+* then the next hidden card is turned over to start the played deck
+*
 * if anything goes wrong while using the deck functions it returns the error code straight away
-* 
+*
 */
 
-deckError Game_deal(Game* game)
+deckError Game_dealHands(Game* game, int handSize)
 {
+	TRACE_SCOPE(Game_deal);
 	deckError err = ok;
 	int i;
 
-	// deals 8 cards total
-	for (i = 0; i < 8; i++)
+	// deals 2 * handSize cards total
+	for (i = 0; i < 2 * handSize; i++)
 	{
 		// take the top card from the hidden deck
 		Card* takenCard;
@@ -49,6 +214,11 @@ deckError Game_deal(Game* game)
 			// put card on top of player 2s deck
 			err = CardDeck_insertToTop(&game->p2, *takenCard);
 		}
+		if (err == ok && game->hands != NULL)
+		{
+			SuitHand_add(&game->hands[i % 2], *takenCard);
+		}
+		free(takenCard);
 
 		if (err != ok)
 		{
@@ -57,26 +227,66 @@ deckError Game_deal(Game* game)
 		}
 	}
 
-	return ok;
+	// turn over the starting card, otherwise there is nothing to match against
+	Card* starter = CardDeck_useTop(&game->hidden, &err);
+	if (err != ok)
+	{
+		return err;
+	}
+	err = PlayedPile_push(&game->played, *starter);
+	free(starter);
+
+	return err;
 }
 
 
+/*
+* Game_findMatch<Name>
+*
+* one hand scan per rule variant, generated from RULES_VARIANTS in Rules.h
+* each has the match test of its variant compiled into the loop, so the
+* loop never checks which variant is played
+*
+* It returns:
+* -the index of the first matching card
+* -or -1 if no match is found
+*/
+
+#define GAME_FIND_MATCH(name, text, match) \
+static int Game_findMatch##name(CardDeckIter hand, const Card* target) \
+{ \
+	const Card* currentCard; \
+	while ((currentCard = CardDeckIter_next(&hand)) != NULL) \
+	{ \
+		if (Rules_match##name(currentCard, target)) \
+		{ \
+			return hand.index - 1; \
+		} \
+		INSTR_NODE(CardDeck_findMatch); \
+	} \
+	return -1; \
+}
+RULES_VARIANTS(GAME_FIND_MATCH)
+#undef GAME_FIND_MATCH
+
 /*
 * CardDeck_findMatch
-* 
-* This function looks for a card in player 1s hand
-* that matches either the suit or the rank of the top card on
-* the played deck
-* 
+*
+* This function looks for a card in the hand of the player whose turn it is
+* that matches the top card on the played deck under the rules of the game
+* (for the standard rules: either the suit or the rank)
+* The game is only read, never changed.
+*
 * It returns:
 * -the index of the first matching card
 * -or -1 if no match is found
 */
 
-int CardDeck_findMatch(Game* game)
+int CardDeck_findMatch(const Game* game)
 {
+	INSTR_FUNC(CardDeck_findMatch);
 	// look at the top card on the played deck
-	Card* target = CardDeck_seeTop(&game->played);
+	const Card* target = PlayedPile_top(&game->played);
 	if (target == NULL)
 	{
 		// nothing to match against
@@ -84,133 +294,197 @@ int CardDeck_findMatch(Game* game)
 
 	}
 
-	// start from the top of player 1s deck
-	deckError err = CardDeck_gotoTop(&game->p1);
-	if (err != ok)
+	// we walk through the players hand with an iterator, so the hand itself is not changed
+	// and other threads can scan the same game at the same time
+	CardDeckIter hand = CardDeck_iter(game->turn == 0 ? &game->p1 : &game->p2);
 
+	// the variant is picked once per turn, not once per card
+	switch (game->rules)
 	{
-		// if the deck is empty
+#define GAME_FIND_CASE(name, text, match) case rules##name: return Game_findMatch##name(hand, target);
+		RULES_VARIANTS(GAME_FIND_CASE)
+#undef GAME_FIND_CASE
+	default:
+		// unknown variant, nothing matches
 		return -1;
 	}
 
-	int index = 0;
+}
+
+/*
+* Game_chooseMatch
+*
+* This function picks the card to play with the strategy of the game
+* -first match: the first matching card, as CardDeck_findMatch finds it
+* -the other strategies ask the suit-grouped hand which card to play, which
+*  takes no walk over the hand, and then look for the position of that card
+*  in the hand, which stops at the card like CardDeck_findMatch stops at
+*  the first match
+* The game is only read, never changed.
+*
+* It returns:
+* -the index of the card to play
+* -or -1 if no card matches
+*/
+
+int Game_chooseMatch(const Game* game)
+{
+	if (game->strategy == strategyFirstMatch || game->hands == NULL)
+	{
+		return CardDeck_findMatch(game);
+	}
 
-	// we walk through the linked list using current + gotoNextCard
-	while (game->p1.current != NULL)
+	const Card* target = PlayedPile_top(&game->played);
+	if (target == NULL)
 	{
-		Card currentCard = game->p1.current->card;
+		// nothing to match against
+		return -1;
+	}
 
-		// check for same suit or rank
-		if (currentCard.suit == target->suit || currentCard.rank == target->rank)
-		{
-			// first match found return its index
-			return index;
-		}
-		// move to next card
-		err = CardDeck_gotoNextCard(&game->p1);
-		if (err != ok)
+	Card chosen;
+	int found;
+	if (game->strategy == strategyHighest)
+	{
+		found = SuitHand_highestMatch(&game->hands[game->turn], game->rules, target, &chosen);
+	}
+	else
+	{
+		found = SuitHand_longestSuitMatch(&game->hands[game->turn], game->rules, target, &chosen);
+	}
+	if (!found)
+	{
+		return -1;
+	}
+
+	CardDeckIter hand = CardDeck_iter(game->turn == 0 ? &game->p1 : &game->p2);
+	const Card* currentCard;
+	while ((currentCard = CardDeckIter_next(&hand)) != NULL)
+	{
+		if (currentCard->suit == chosen.suit && currentCard->rank == chosen.rank)
 		{
-			break;
+			return hand.index - 1;
 		}
-
-		index++;
 	}
 
+	// the suit-grouped hand is out of date with the hand
 	return -1;
-
 }
 
 /*
-* Game_playTurn
-* 
-* This function plays one turn for player 1
-* 
+* Game_finishTurn
+*
+* This function does the second half of a turn, once CardDeck_findMatch
+* (or anything else that scanned the hand the same way) has picked the card
+*
 * Steps:
-* 1. Try to find a matching card in player 1s hand using CardDeck_findMatch
-* 2. if no match is found:
+* 1. if no match was found (matchIndex is -1):
 * -if the hidden deck is empty recycle from played back to hidden
-* -then draw one card from player 1s hand 
-* 3. If a match is found:
-* -remove that card from player 1s hand at the given index
+* -then draw one card from the hidden deck into the players hand
+* 2. If a match was found:
+* -remove that card from the players hand at the given index
 * -put that card into the played deck
+* -if the hand is now empty the player has won
+* 3. the other player has the next turn
 */
 
-void Game_playTurn(Game* game)
+void Game_finishTurn(Game* game, int matchIndex)
 {
-	// try to find a playable card in player 1s hand
-	int matchIndex = CardDeck_findMatch(game);
+	CardDeck* hand = game->turn == 0 ? &game->p1 : &game->p2;
+	int player = game->turn + 1;
 
 	if (matchIndex == -1)
 	{
-		// no matching card so player 1 has to draw
+		// no matching card so the player has to draw
 
-		// check if hidden deck is empty using the head pointer
-		if (game->hidden.head == NULL)
+		// check if hidden deck is empty
+		if (game->hidden.head->successor == NULL)
 		{
 			// if hidden is empty recycle from played back into hidden
-			CardDeck_recycleHidden(&game->hidden, &game->played);
+			PlayedPile_recycleInto(&game->played, &game->hidden, game->rng != NULL ? game->rng : Rng_default());
+			game->recycles++;
 		}
 
 		// draw one card from hidden if there is atleast one card there
-		if (game->hidden.head != NULL)
+		if (game->hidden.head->successor != NULL)
 		{
 			deckError err = ok;
 			Card* drawnCard = CardDeck_useTop(&game->hidden, &err);
 			if (err == ok)
 			{
-				CardDeck_insertToTop(&game->p1, *drawnCard);
-				printf("Player 1 had no match and drew a card.\n");
+				if (CardDeck_insertToTop(hand, *drawnCard) == ok && game->hands != NULL)
+				{
+					SuitHand_add(&game->hands[game->turn], *drawnCard);
+				}
+				free(drawnCard);
+				if (game->verbose) printf("Player %d had no match and drew a card.\n", player);
 			}
 			else
 			{
-				printf("Error: could not draw card from hidden decl\n");
+				printf("Error: could not draw card from hidden deck\n");
 
 			}
 		}
 		else
 		{
 			// nothing to draw even after recycling
-			printf("No cards left to draw.\n");
+			if (game->verbose) printf("No cards left to draw.\n");
 		}
-	 
-		// turn ends here
-		return;
-	}   
+	}
 	else
 	{
 		// we found a matching card at matchIndex so we want to play it
 		deckError err = ok;
-		Card* playedCard;
-		
-		playedCard = CardDeck_removeAt(&game->p1, matchIndex, &err);
+		CardNode* playedNode;
+
+		// the node itself moves to the played pile, which reuses it when recycling
+		playedNode = CardDeck_unlinkAt(hand, matchIndex, &err);
 		if (err != ok)
 		{
-			printf("Error: could not remove matching card from player 1s hand.\n");
+			printf("Error: could not remove matching card from player %ds hand.\n", player);
 			return;
 		}
+		if (game->hands != NULL)
+		{
+			SuitHand_remove(&game->hands[game->turn], playedNode->card);
+		}
+
 		// put the removed card on top of the played deck
-		 CardDeck_insertToTop(&game->played, *playedCard);
+		err = PlayedPile_pushNode(&game->played, playedNode);
 		if (err != ok)
 		{
 			printf("Error: could not place on played deck.\n");
 			return;
 		}
 
-		printf("Player 1 played a matching card.\n");
-
+		if (game->verbose) printf("Player %d played a matching card.\n", player);
 
+		if (hand->head->successor == NULL)
+		{
+			// no cards left, the player whose turn it is wins
+			game->status = win;
+			if (game->verbose) printf("Player %d has won the game.\n", player);
+			return;
+		}
 	}
 
-
-
+	// turn ends here, the other player is next
+	game->turn = 1 - game->turn;
 }
 
+/*
+* Game_playTurn
+*
+* This function plays one turn for the player whose turn it is:
+* it picks a matching card with Game_chooseMatch and then
+* draws or plays with Game_finishTurn
+*/
 
+void Game_playTurn(Game* game)
+{
+	INSTR_FUNC(Game_playTurn);
+	TRACE_SCOPE(Game_playTurn);
+	// try to find a playable card in the players hand
+	int matchIndex = Game_chooseMatch(game);
 
-
-
-
-
-
-
-  
\ No newline at end of file
+	Game_finishTurn(game, matchIndex);
+}
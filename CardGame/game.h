@@ -10,24 +10,56 @@
 #ifndef GAME_H
 #define GAME_H
 #include "CardDeck.h"
+#include "PlayedPile.h"
+#include "Rng.h"
+#include "Rules.h"
+#include "SuitHand.h"
+
+#define GAME_HAND_SIZE 4 // cards Game_deal deals to each player
 
 typedef enum { // enum used to indicate current status of a game.
 	ongoing,
 	win
 } GameStatus;
 
+typedef enum { // how a player picks which matching card to play
+	strategyFirstMatch, // the first matching card in the hand, see CardDeck_findMatch
+	strategyHighest, // the matching card of the highest rank
+	strategyLongestSuit, // the highest matching card of the suit the player holds most of
+	strategyCount // number of strategies
+} GameStrategy;
+
 typedef struct { // struct containing all components of a game.
 	CardDeck hidden;
-	CardDeck played;
+	PlayedPile played; // only the top card is read, see PlayedPile.h
 	CardDeck p1;
 	CardDeck p2;
 	GameStatus status; // set as ongoing initially. when its set to win, end the game
+	int turn; // player whose turn it is, 0 for p1 and 1 for p2. once status is win this is the winner
+	int verbose; // print every move when not 0
+	Rng* rng; // generator for the shuffles, NULL uses Rng_default()
+	RuleVariant rules; // which cards match the top card, rulesStandard unless set after Game_initDecks
+	GameStrategy strategy; // how both players pick a card, set with Game_setStrategy
+	SuitHand* hands; // p1 and p2 grouped by suit and kept up to date, NULL for strategyFirstMatch
+	int recycles; // times the played pile was shuffled back into the empty hidden deck
+	uint64_t shoe; // tally of all cards the game was set up with, see Game_checkCards
 } Game;
 
 //function declarations
+//setup
+deckError Game_initDecks(Game* game, Rng* rng);
+deckError Game_init(Game* game, int numPacks, Rng* rng);
+void Game_free(Game* game);
+deckError Game_setStrategy(Game* game, GameStrategy strategy);
+void Game_recordShoe(Game* game);
+int Game_checkCards(const Game* game);
+
 //game loop
-//deckError Game_deal(Game* game);
-//int CardDeck_findMatch(Game* game);
-//void Game_playTurn(Game* game);
+deckError Game_deal(Game* game);
+deckError Game_dealHands(Game* game, int handSize);
+int CardDeck_findMatch(const Game* game);
+int Game_chooseMatch(const Game* game);
+void Game_finishTurn(Game* game, int matchIndex);
+void Game_playTurn(Game* game);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1340 @@
+/**
+* @file test_deck.c
+* Tests for the deck operations.
+* Every test prints one PASS/FAIL line and returns the number of failures.
+*
+* @date 19.10.2026
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "test_deck.h"
+#include "CardDeck.h"
+#include "ChunkDeck.h"
+#include "IndexedDeck.h"
+#include "Rng.h"
+#include "SharedShoe.h"
+#include "Simulator.h"
+#include "GameServer.h"
+#include "LoadGen.h"
+#include "Scenario.h"
+#include "CardFormat.h"
+#include "Campaign.h"
+#include "PlayedPile.h"
+#include "Solver.h"
+#include "Rules.h"
+#include "SuitHand.h"
+#include "Sweep.h"
+#include "ResultFile.h"
+#include "DeckDiff.h"
+#include "Regress.h"
+
+#define CHI_SQUARE_23_P001 49.73 // chi-square critical value, 23 degrees of freedom, p = 0.001
+
+/**
+* Prints the result of one check.
+*
+* @return 0 if passed, 1 if failed
+*/
+static int TestDeck_check(int passed, const char* name) {
+	printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+	return passed ? 0 : 1;
+}
+
+/**
+* Ranks a permutation of 4 distinct cards (TWO..FIVE) as 0..23.
+*/
+static int TestDeck_permutationIndex(CardDeck* deck) {
+	int rank[4];
+	CardNode* node = deck->head->successor;
+	for (int i = 0; i < 4; i++) {
+		rank[i] = node->card.rank;
+		node = node->successor;
+	}
+
+	// Lehmer code: count smaller ranks to the right of each position
+	int index = 0;
+	for (int i = 0; i < 4; i++) {
+		int smaller = 0;
+		for (int j = i + 1; j < 4; j++) {
+			if (rank[j] < rank[i]) smaller++;
+		}
+		index = index * (4 - i) + smaller;
+	}
+	return index;
+}
+
+/**
+* Shuffles a 4-card deck many times and runs a chi-square test
+* over how often each of the 24 orders came up.
+*
+* @param parallel Use CardDeck_shuffleParallel with 3 threads instead of the sequential shuffle
+*/
+static int TestDeck_shuffleUniformity(int parallel) {
+	const int trials = 24000;
+	int seen[24] = { 0 };
+	Rng rng;
+	Rng_seed(&rng, parallel ? 30 : 29);
+
+	CardDeck* deck = CardDeck_create();
+	Card cards[4] = { { HEART, TWO }, { HEART, THREE }, { HEART, FOUR }, { HEART, FIVE } };
+	CardDeck_insertCardsAfter(deck, cards, 4);
+
+	for (int t = 0; t < trials; t++) {
+		if (parallel) {
+			CardDeck_shuffleParallel(deck, &rng, 3);
+		}
+		else {
+			CardDeck_shuffleWith(deck, &rng);
+		}
+		seen[TestDeck_permutationIndex(deck)]++;
+	}
+	CardDeck_delete(deck);
+
+	double expected = trials / 24.0;
+	double chi = 0;
+	for (int i = 0; i < 24; i++) {
+		chi += (seen[i] - expected) * (seen[i] - expected) / expected;
+	}
+	printf("      chi-square %.2f (critical %.2f)\n", chi, CHI_SQUARE_23_P001);
+	return TestDeck_check(chi < CHI_SQUARE_23_P001,
+		parallel ? "parallel shuffle gives uniform permutations" : "shuffle gives uniform permutations");
+}
+
+/**
+* Shuffles a multi-pack shoe in parallel and checks no card was lost or duplicated,
+* and that the same generator and thread count give the same order.
+*/
+static int TestDeck_shuffleParallelKeepsCards(void) {
+	CardDeck* a = CardDeck_createOrdered(40);
+	CardDeck* b = CardDeck_createOrdered(40);
+	Rng rngA, rngB;
+	Rng_seed(&rngA, 31);
+	Rng_seed(&rngB, 31);
+	CardDeck_shuffleParallel(a, &rngA, 4);
+	CardDeck_shuffleParallel(b, &rngB, 4);
+
+	int counts[PACK_SIZE] = { 0 };
+	int same = 1;
+	CardNode* nodeB = b->head->successor;
+	for (CardNode* node = a->head->successor; node != NULL; node = node->successor) {
+		counts[node->card.suit * 13 + node->card.rank]++;
+		if (node->card.suit != nodeB->card.suit || node->card.rank != nodeB->card.rank) same = 0;
+		nodeB = nodeB->successor;
+	}
+	int kept = CardDeck_count(a) == 40 * PACK_SIZE;
+	for (int i = 0; i < PACK_SIZE; i++) {
+		if (counts[i] != 40) kept = 0;
+	}
+	CardDeck_delete(a);
+	CardDeck_delete(b);
+	return TestDeck_check(kept && same, "parallel shuffle keeps every card and is reproducible");
+}
+
+/**
+* Checks that a chunked deck holds the same cards in the same order as a list deck.
+*/
+static int TestDeck_sameCards(CardDeck* list, ChunkDeck* chunked) {
+	if (CardDeck_count(list) != ChunkDeck_count(chunked)) return 0;
+
+	int index = 0;
+	for (CardNode* node = list->head->successor; node != NULL; node = node->successor) {
+		Card card = ChunkDeck_cardAt(chunked, index++, NULL);
+		if (card.suit != node->card.suit || card.rank != node->card.rank) return 0;
+	}
+	return 1;
+}
+
+/**
+* Applies the same random inserts, draws, removals and cursor edits to a
+* CardDeck and a ChunkDeck and checks they always hold the same cards.
+*/
+static int TestDeck_chunkDeckMatchesList(void) {
+	CardDeck* list = CardDeck_createOrdered(3);
+	ChunkDeck* chunked = ChunkDeck_create();
+	ChunkDeck_fillDeck(chunked, 3);
+	Rng rng;
+	Rng_seed(&rng, 32);
+	int same = TestDeck_sameCards(list, chunked);
+
+	for (int op = 0; op < 20000 && same; op++) {
+		int count = CardDeck_count(list);
+		Card card = orderedPack[Rng_bounded(&rng, PACK_SIZE)];
+		deckError err;
+
+		switch (Rng_bounded(&rng, 4)) {
+		case 0:
+			CardDeck_insertToTop(list, card);
+			ChunkDeck_insertToTop(chunked, card);
+			break;
+		case 1:
+			if (count > 0) {
+				free(CardDeck_useTop(list, &err));
+				ChunkDeck_useTop(chunked, &err);
+			}
+			break;
+		case 2:
+			if (count > 0) {
+				int index = (int)Rng_bounded(&rng, (uint32_t)count);
+				free(CardDeck_removeAt(list, index, &err));
+				ChunkDeck_removeAt(chunked, index, &err);
+			}
+			break;
+		default: {
+			// walk the cursor to a random card, then insert or delete after it
+			int steps = count > 0 ? (int)Rng_bounded(&rng, (uint32_t)count) : 0;
+			list->current = list->head;
+			chunked->current = NULL;
+			for (int i = 0; i < steps; i++) {
+				list->current = list->current->successor;
+				ChunkDeck_gotoNextCard(chunked);
+			}
+			if (Rng_bounded(&rng, 2) == 0) {
+				CardDeck_insertAfter(&card, list);
+				ChunkDeck_insertAfter(&card, chunked);
+			}
+			else if (list->current->successor != NULL) {
+				CardDeck_deleteNext(list);
+				ChunkDeck_deleteNext(chunked);
+			}
+			break;
+		}
+		}
+		same = TestDeck_sameCards(list, chunked);
+	}
+
+	CardDeck_delete(list);
+	ChunkDeck_delete(chunked);
+	return TestDeck_check(same, "chunked deck matches the list deck");
+}
+
+/**
+* Applies the same random inserts and removals by position to a CardDeck
+* and an IndexedDeck and checks they always hold the same cards.
+*/
+static int TestDeck_indexedDeckMatchesList(void) {
+	CardDeck* list = CardDeck_createOrdered(2);
+	IndexedDeck* indexed = IndexedDeck_create();
+	IndexedDeck_fillDeck(indexed, 2);
+	Rng rng;
+	Rng_seed(&rng, 33);
+	int same = 1;
+
+	for (int op = 0; op < 20000 && same; op++) {
+		int count = CardDeck_count(list);
+		Card card = orderedPack[Rng_bounded(&rng, PACK_SIZE)];
+		deckError err;
+
+		if (count == 0 || Rng_bounded(&rng, 2) == 0) {
+			int index = (int)Rng_bounded(&rng, (uint32_t)count + 1);
+			list->current = index == 0 ? list->head : CardDeck_cardNodeAt(list, index - 1, &err);
+			CardDeck_insertAfter(&card, list);
+			IndexedDeck_insertAt(indexed, index, card);
+		}
+		else {
+			int index = (int)Rng_bounded(&rng, (uint32_t)count);
+			free(CardDeck_removeAt(list, index, &err));
+			IndexedDeck_removeAt(indexed, index, &err);
+		}
+
+		same = CardDeck_count(list) == IndexedDeck_count(indexed);
+		int index = 0;
+		for (CardNode* node = list->head->successor; node != NULL && same; node = node->successor) {
+			Card other = IndexedDeck_cardAt(indexed, index++, NULL);
+			same = other.suit == node->card.suit && other.rank == node->card.rank;
+		}
+	}
+
+	IndexedDeck_sort(indexed);
+	for (int i = 1; i < IndexedDeck_count(indexed) && same; i++) {
+		Card a = IndexedDeck_cardAt(indexed, i - 1, NULL);
+		Card b = IndexedDeck_cardAt(indexed, i, NULL);
+		same = Card_pack(a) <= Card_pack(b);
+	}
+
+	CardDeck_delete(list);
+	IndexedDeck_delete(indexed);
+	return TestDeck_check(same, "indexed deck matches the list deck");
+}
+
+/**
+* Iterating, counting and printing a deck must not move its current node,
+* and the iterator must visit every card in order.
+*/
+static int TestDeck_iteratorKeepsCurrent(void) {
+	CardDeck* deck = CardDeck_createOrdered(2);
+	CardDeck_gotoTop(deck);
+	CardDeck_gotoNextCard(deck);
+	CardNode* before = deck->current;
+
+	int inOrder = 1;
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		const Card* expected = &orderedPack[(it.index - 1) % PACK_SIZE];
+		inOrder &= card->suit == expected->suit && card->rank == expected->rank;
+	}
+	inOrder &= it.index == 2 * PACK_SIZE && CardDeck_count(deck) == 2 * PACK_SIZE;
+
+	int same = deck->current == before;
+	CardDeck_delete(deck);
+	return TestDeck_check(inOrder && same, "iterating a deck keeps its current node");
+}
+
+#define SHOE_TEST_THREADS 4
+#define SHOE_TEST_GENERATIONS 5
+
+typedef struct {
+	SharedShoe* shoe;
+	int quota; // cards this thread draws
+	int batch; // largest batch it asks for
+	int seen[PACK_SIZE]; // how often each card was drawn
+} ShoeDrawer;
+
+/**
+* Draws exactly quota cards in batches of 1..batch cards.
+*/
+static int TestDeck_shoeDrawer(void* arg) {
+	ShoeDrawer* drawer = (ShoeDrawer*)arg;
+	Card cards[8];
+	for (int drawn = 0, want = 1; drawn < drawer->quota; want = want % drawer->batch + 1) {
+		int left = drawer->quota - drawn;
+		int got = SharedShoe_drawBatch(drawer->shoe, cards, want < left ? want : left);
+		for (int i = 0; i < got; i++) {
+			drawer->seen[Card_pack(cards[i])]++;
+		}
+		drawn += got;
+	}
+	return 0;
+}
+
+/**
+* Several threads empty a 2-pack shared shoe exactly SHOE_TEST_GENERATIONS
+* times. Every generation holds every card once, so every card must have
+* been drawn 2 * SHOE_TEST_GENERATIONS times, no matter how the draws and
+* reshuffles interleaved.
+*/
+static int TestDeck_sharedShoeDealsEveryCard(void) {
+	CardDeck* deck = CardDeck_createOrdered(2);
+	SharedShoe* shoe = SharedShoe_create(deck, 11);
+	CardDeck_delete(deck);
+	if (shoe == NULL) return TestDeck_check(0, "shared shoe deals every card once per generation");
+
+	ShoeDrawer drawers[SHOE_TEST_THREADS];
+	thrd_t threads[SHOE_TEST_THREADS];
+	int total = 2 * PACK_SIZE * SHOE_TEST_GENERATIONS;
+	for (int t = 0; t < SHOE_TEST_THREADS; t++) {
+		drawers[t] = (ShoeDrawer){ shoe, total * (t + 1) / SHOE_TEST_THREADS - total * t / SHOE_TEST_THREADS, t + 2, { 0 } };
+		thrd_create(&threads[t], TestDeck_shoeDrawer, &drawers[t]);
+	}
+	for (int t = 0; t < SHOE_TEST_THREADS; t++) {
+		thrd_join(threads[t], NULL);
+	}
+
+	int passed = SharedShoe_generation(shoe) == SHOE_TEST_GENERATIONS - 1 && SharedShoe_remaining(shoe) == 0;
+	for (int c = 0; c < PACK_SIZE; c++) {
+		int seen = 0;
+		for (int t = 0; t < SHOE_TEST_THREADS; t++) seen += drawers[t].seen[c];
+		passed &= seen == 2 * SHOE_TEST_GENERATIONS;
+	}
+	SharedShoe_delete(shoe);
+	return TestDeck_check(passed, "shared shoe deals every card once per generation");
+}
+
+/**
+* Returns the number of cards in all decks of a game.
+*/
+static int TestDeck_gameCards(const Game* game) {
+	return CardDeck_count(&game->hidden) + PlayedPile_count(&game->played) +
+		CardDeck_count(&game->p1) + CardDeck_count(&game->p2);
+}
+
+/**
+* Interleaving games must not change how they are played: every game ends
+* with the same winner, turn count and hands as when it runs on its own,
+* and no game loses or gains a card.
+*/
+static int TestDeck_interleavedGamesMatchSequential(void) {
+	const int numGames = 200;
+	Simulator* sequential = Simulator_create(numGames, 1, 21, 300);
+	Simulator* interleaved = Simulator_create(numGames, 1, 21, 300);
+	if (sequential == NULL || interleaved == NULL) {
+		Simulator_delete(sequential);
+		Simulator_delete(interleaved);
+		return TestDeck_check(0, "interleaved games play like sequential games");
+	}
+
+	long long turns = Simulator_runSequential(sequential);
+	int same = Simulator_runInterleaved(interleaved, 16) == turns;
+	int wins = 0;
+	for (int i = 0; i < numGames; i++) {
+		const Game* a = &sequential->games[i].game;
+		const Game* b = &interleaved->games[i].game;
+		same &= sequential->games[i].turns == interleaved->games[i].turns;
+		same &= a->status == b->status && a->turn == b->turn;
+		same &= CardDeck_count(&a->p1) == CardDeck_count(&b->p1) && CardDeck_count(&a->p2) == CardDeck_count(&b->p2);
+		same &= TestDeck_gameCards(a) == PACK_SIZE && TestDeck_gameCards(b) == PACK_SIZE;
+		wins += a->status == win;
+	}
+
+	Simulator_delete(sequential);
+	Simulator_delete(interleaved);
+	return TestDeck_check(same && wins > 0, "interleaved games play like sequential games");
+}
+
+/**
+* Plays a game until somebody wins or maxTurns turns are played.
+*
+* @return number of turns played
+*/
+static int TestDeck_playOut(Game* game, int maxTurns) {
+	int turns = 0;
+	while (game->status == ongoing && turns < maxTurns) {
+		Game_playTurn(game);
+		turns++;
+	}
+	return turns;
+}
+
+/**
+* Games saved to a scenario file come back exactly as they were, replaying
+* a scenario twice plays the same game, games of several packs fit into
+* records with room for them, and a record claiming more room than its
+* file gives it or a file with a wrong header is refused.
+*/
+static int TestDeck_scenarioRoundTrip(void) {
+	enum { count = 100 };
+	static const int packCounts[] = { 1, 3 };
+	const char* path = "cardgame_test_scenarios.bin";
+	Rng rng;
+	Rng_seed(&rng, 31);
+
+	int passed = 1;
+	for (int p = 0; p < 2; p++) {
+		int packs = packCounts[p];
+		ScenarioRecord* records = (ScenarioRecord*)malloc(count * Scenario_recordSize(packs));
+		ScenarioRecord* again = (ScenarioRecord*)malloc(Scenario_recordSize(packs));
+		if (records == NULL || again == NULL) {
+			free(records);
+			free(again);
+			return TestDeck_check(0, "scenario files replay the saved games");
+		}
+		for (int i = 0; i < count; i++) {
+			Game game;
+			passed &= Game_init(&game, packs, &rng) == ok;
+			TestDeck_playOut(&game, i % 7); // some scenarios start in the middle of a game
+			passed &= Scenario_capture(&game, 1000 + i, packs, ScenarioRecord_at(records, packs, i)) == ok;
+			// a record with room for fewer packs than the game has is refused
+			if (packs > 1) passed &= Scenario_capture(&game, 1000 + i, packs - 1, again) == illegalCard;
+			Game_free(&game);
+		}
+		passed &= ScenarioFile_write(path, records, count, packs) == 0;
+		free(records);
+
+		ScenarioFile* file = ScenarioFile_open(path);
+		passed &= file != NULL && file->count == count && file->packs == packs;
+		for (int i = 0; passed && i < count; i++) {
+			const ScenarioRecord* record = ScenarioFile_at(file, i);
+			Game first, second;
+			Rng firstRng, secondRng;
+			passed &= Scenario_newGame(record, &first, &firstRng) == ok;
+			passed &= Scenario_newGame(record, &second, &secondRng) == ok;
+			passed &= Scenario_capture(&first, record->seed, packs, again) == ok &&
+				memcmp(again, record, Scenario_recordSize(packs)) == 0;
+			passed &= TestDeck_playOut(&first, 500) == TestDeck_playOut(&second, 500);
+			passed &= first.status == second.status && first.turn == second.turn;
+			Game_free(&first);
+			Game_free(&second);
+		}
+		ScenarioFile_close(file);
+		free(again);
+	}
+
+	// a record claiming more packs than the file has room for
+	FILE* corrupt = fopen(path, "r+b");
+	if (corrupt != NULL) {
+		fseek(corrupt, (long)(sizeof(ScenarioFileHeader) + offsetof(ScenarioRecord, packs)), SEEK_SET);
+		fputc(SCENARIO_MAX_PACKS, corrupt);
+		fclose(corrupt);
+		ScenarioFile* file = ScenarioFile_open(path);
+		passed &= file != NULL && ScenarioFile_at(file, 0) == NULL && ScenarioFile_at(file, 1) != NULL;
+		ScenarioFile_close(file);
+	}
+
+	// a byte of the magic number changed
+	corrupt = fopen(path, "r+b");
+	if (corrupt != NULL) {
+		fputc('X', corrupt);
+		fclose(corrupt);
+		passed &= ScenarioFile_open(path) == NULL;
+	}
+	remove(path);
+	return TestDeck_check(passed, "scenario files replay the saved games");
+}
+
+/**
+* The formatter writes the same text as one printf per card did, the short
+* form and ranges are right, and a text cut to a small buffer stays terminated.
+*/
+static int TestDeck_formatMatchesPrintf(void) {
+	CardDeck* deck = CardDeck_create();
+	Rng rng;
+	Rng_seed(&rng, 38);
+	int passed = deck != NULL && CardDeck_fillDeck(deck, 2) != NULL && CardDeck_shuffleWith(deck, &rng) == ok;
+	if (!passed) {
+		CardDeck_delete(deck);
+		return TestDeck_check(0, "formatter writes what printf wrote");
+	}
+
+	static char expected[4096];
+	static char text[4096];
+	PackedCard packed[2 * PACK_SIZE];
+	size_t length = 0;
+	CardDeckIter it = CardDeck_iter(deck);
+	const Card* card;
+	while ((card = CardDeckIter_next(&it)) != NULL) {
+		length += (size_t)snprintf(expected + length, sizeof(expected) - length, "%s%s-%s",
+			it.index > 1 ? ", " : "", suitNames[card->suit], rankNames[card->rank]);
+		packed[it.index - 1] = Card_pack(*card);
+	}
+	passed &= CardFormat_deck(deck, 0, -1, formatLong, text, sizeof(text)) == length && strcmp(text, expected) == 0;
+	passed &= CardFormat_packed(packed, it.index, formatLong, text, sizeof(text)) == length && strcmp(text, expected) == 0;
+	passed &= CardFormat_deck(deck, 0, -1, formatLong, NULL, 0) == length;
+
+	char small[8];
+	passed &= CardFormat_deck(deck, 0, -1, formatLong, small, sizeof(small)) == length &&
+		strncmp(small, expected, sizeof(small) - 1) == 0 && small[sizeof(small) - 1] == '\0';
+
+	Card cards[3] = { { HEART, ACE }, { SPADE, TEN }, { CLUB, TWO } };
+	passed &= CardFormat_cards(cards, 3, formatShort, text, sizeof(text)) == 14 && strcmp(text, "H-A, S-10, C-2") == 0;
+	passed &= CardFormat_card(INVALID_CARD, formatShort, text, sizeof(text)) == 1 && strcmp(text, "?") == 0;
+
+	char range[64];
+	CardFormat_deck(deck, 1, 2, formatShort, range, sizeof(range));
+	CardFormat_packed(packed + 1, 2, formatShort, text, sizeof(text));
+	passed &= strcmp(range, text) == 0;
+
+	CardDeck_delete(deck);
+	return TestDeck_check(passed, "formatter writes what printf wrote");
+}
+
+/**
+* A campaign stopped after a few batches and resumed from its checkpoint,
+* with other batch sizes, ends with the same totals as one run straight
+* through, and a damaged checkpoint is refused.
+*/
+static int TestDeck_campaignResumes(void) {
+	const char* path = "cardgame_test_campaign.ckpt";
+	Campaign straight;
+	Campaign_init(&straight, 39, 2000, 1, 500);
+	int passed = Campaign_run(&straight, 300, NULL, 0) == 0;
+
+	Campaign stopped;
+	Campaign_init(&stopped, 39, 2000, 1, 500);
+	passed &= Campaign_playBatch(&stopped, 250) == 250 && Campaign_playBatch(&stopped, 250) == 250;
+	passed &= Campaign_save(&stopped, path) == 0;
+
+	Campaign resumed;
+	passed &= Campaign_load(&resumed, path) == 0 && resumed.nextGame == 500;
+	passed &= Campaign_run(&resumed, 400, path, 0) == 0;
+	passed &= memcmp(&resumed.stats, &straight.stats, sizeof(CampaignStats)) == 0;
+	passed &= straight.stats.games == 2000 &&
+		straight.stats.wins[0] + straight.stats.wins[1] + straight.stats.unfinished == 2000;
+
+	Campaign finished;
+	passed &= Campaign_load(&finished, path) == 0 && finished.nextGame == 2000 &&
+		memcmp(&finished.stats, &straight.stats, sizeof(CampaignStats)) == 0;
+
+	FILE* file = fopen(path, "r+b");
+	if (file != NULL) {
+		fseek(file, 40, SEEK_SET);
+		fputc(0xFF, file);
+		fclose(file);
+	}
+	passed &= file != NULL && Campaign_load(&finished, path) != 0;
+	remove(path);
+	return TestDeck_check(passed, "campaign resumes from its checkpoint with the same totals");
+}
+
+/**
+* Returns whether two games hold the same cards in the same order in every deck.
+*/
+static int TestDeck_sameGame(const Game* a, const Game* b) {
+	if (a->played.count != b->played.count || (a->played.count > 0 && a->played.top != b->played.top) ||
+		(a->played.count > 1 && memcmp(a->played.cards, b->played.cards, (size_t)a->played.count - 1) != 0)) return 0;
+	const CardDeck* decksA[3] = { &a->hidden, &a->p1, &a->p2 };
+	const CardDeck* decksB[3] = { &b->hidden, &b->p1, &b->p2 };
+	for (int d = 0; d < 3; d++) {
+		CardDeckIter itA = CardDeck_iter(decksA[d]);
+		CardDeckIter itB = CardDeck_iter(decksB[d]);
+		const Card* cardA;
+		const Card* cardB;
+		do {
+			cardA = CardDeckIter_next(&itA);
+			cardB = CardDeckIter_next(&itB);
+			if ((cardA == NULL) != (cardB == NULL)) return 0;
+			if (cardA != NULL && (cardA->suit != cardB->suit || cardA->rank != cardB->rank)) return 0;
+		} while (cardA != NULL);
+	}
+	return a->status == b->status && a->turn == b->turn;
+}
+
+/**
+* Recycling a played pile leaves the hidden deck exactly as recycling a
+* linked played deck with the same cards and generator does, with and
+* without spare nodes, and keeps the top card.
+*/
+static int TestDeck_playedPileRecyclesLikeList(void) {
+	CardDeck hiddenList, hiddenPile, played, hand;
+	PlayedPile pile;
+	int passed = CardDeck_init(&hiddenList) == ok && CardDeck_init(&hiddenPile) == ok && CardDeck_init(&played) == ok &&
+		CardDeck_init(&hand) == ok && PlayedPile_init(&pile) == ok;
+
+	Rng rng;
+	Rng_seed(&rng, 41);
+	for (int round = 0; round < 3 && passed; round++) {
+		for (int c = 0; c < 40; c++) {
+			Card card = orderedPack[(c * 7 + round) % PACK_SIZE];
+			passed &= CardDeck_insertToTop(&played, card) == ok;
+			if (c % 2 == 0) {
+				passed &= PlayedPile_push(&pile, card) == ok;
+			}
+			else { // half the cards come with a node, like cards played from a hand
+				passed &= CardDeck_insertToTop(&hand, card) == ok;
+				deckError err = ok;
+				CardNode* node = CardDeck_unlinkAt(&hand, 0, &err);
+				passed &= err == ok && PlayedPile_pushNode(&pile, node) == ok;
+			}
+		}
+		Rng listRng = rng;
+		passed &= CardDeck_recycleHiddenWith(&hiddenList, &played, &listRng) == ok;
+		passed &= PlayedPile_recycleInto(&pile, &hiddenPile, &rng) == ok;
+
+		CardDeckIter list = CardDeck_iter(&hiddenList);
+		CardDeckIter packed = CardDeck_iter(&hiddenPile);
+		const Card* a;
+		const Card* b;
+		while ((a = CardDeckIter_next(&list)) != NULL) {
+			b = CardDeckIter_next(&packed);
+			passed &= b != NULL && a->suit == b->suit && a->rank == b->rank;
+		}
+		passed &= CardDeckIter_next(&packed) == NULL;
+		const Card* top = PlayedPile_top(&pile);
+		passed &= PlayedPile_count(&pile) == 1 && CardDeck_count(&played) == 1 && top != NULL &&
+			top->suit == played.head->successor->card.suit && top->rank == played.head->successor->card.rank;
+	}
+
+	CardDeck_destroy(&hiddenList);
+	CardDeck_destroy(&hiddenPile);
+	CardDeck_destroy(&played);
+	CardDeck_destroy(&hand);
+	PlayedPile_destroy(&pile);
+	return TestDeck_check(passed, "played pile recycles like the linked played deck");
+}
+
+/**
+* Games give the same results on 1 or 4 threads, and a part of the games
+* replayed on its own gives the same results as in the whole simulation.
+*/
+static int TestDeck_streamsIndependentOfThreads(void) {
+	const int count = 600;
+	Simulator* one = Simulator_create(count, 1, 40, 500);
+	Simulator* four = Simulator_create(count, 1, 40, 500);
+	Simulator* part = Simulator_createRange(250, 100, 1, 40, 500);
+	int passed = one != NULL && four != NULL && part != NULL;
+	if (passed) {
+		passed &= Simulator_runParallel(one, 1) == Simulator_runParallel(four, 4);
+		Simulator_runSequential(part);
+		for (int i = 0; i < count && passed; i++) {
+			passed &= one->games[i].turns == four->games[i].turns && TestDeck_sameGame(&one->games[i].game, &four->games[i].game);
+		}
+		for (int i = 0; i < part->count && passed; i++) {
+			passed &= part->games[i].turns == one->games[250 + i].turns && TestDeck_sameGame(&part->games[i].game, &one->games[250 + i].game);
+		}
+	}
+	Simulator_delete(one);
+	Simulator_delete(four);
+	Simulator_delete(part);
+	return TestDeck_check(passed, "games play the same on any number of threads and on their own");
+}
+
+/**
+* The solver finds sure wins, refuses illegal plays, never rates a legal
+* card above its own best move, and gets the same values from a table
+* too small to hold anything as from a large one.
+*/
+static int TestDeck_solverFindsBestPlay(void) {
+	SolverTable* table = SolverTable_create(20);
+	SolverTable* tiny = SolverTable_create(2);
+	if (table == NULL || tiny == NULL) {
+		SolverTable_delete(table);
+		SolverTable_delete(tiny);
+		return TestDeck_check(0, "solver finds the best play");
+	}
+
+	// the five of clubs on top, the other player holds the jack of hearts
+	SolverState state = { { 1ull << 0, 1ull << 35 }, (1ull << 20) | (1ull << 40), 3, 0, rulesStandard };
+	SolverResult result = Solver_solve(table, &state, 10, NULL);
+	int passed = result.winChance == 1.0 && result.exact && result.bestCard == 0;
+	state.hand[0] |= 1ull << 1; // two clubs win whatever the other player draws
+	result = Solver_solve(table, &state, 10, NULL);
+	passed &= result.winChance == 1.0 && result.exact && result.bestCard >= 0;
+	SolverState next;
+	passed &= Solver_play(&state, 35, &next) == illegalCard && Solver_play(&state, 20, &next) == illegalCard;
+
+	Rng rng;
+	Rng_seed(&rng, 42);
+	for (int i = 0; i < 20 && passed; i++) {
+		Game game;
+		passed &= Game_init(&game, 1, &rng) == ok;
+		TestDeck_playOut(&game, 1 + i % 5);
+		if (game.status == ongoing) {
+			passed &= Solver_stateFromGame(&game, &state) == ok;
+			SolverTable_clear(table);
+			SolverStats stats;
+			result = Solver_solve(table, &state, 4, &stats);
+			passed &= stats.nodes > 0 && result.winChance >= 0.0 && result.winChance <= 1.0;
+			passed &= fabs(Solver_solve(tiny, &state, 4, NULL).winChance - result.winChance) < 1e-6;
+			for (int card = 0; card < PACK_SIZE; card++) {
+				if (Solver_play(&state, card, &next) != ok) continue;
+				double played = 1.0 - Solver_solve(table, &next, 3, NULL).winChance;
+				passed &= played <= result.winChance + 1e-6;
+				if (card == result.bestCard) passed &= fabs(played - result.winChance) < 1e-6;
+			}
+		}
+		Game_free(&game);
+	}
+
+	SolverTable_delete(table);
+	SolverTable_delete(tiny);
+	return TestDeck_check(passed, "solver finds the best play");
+}
+
+/**
+* Under every rule variant CardDeck_findMatch finds the first card that
+* Rules_matches accepts, no card is lost, and every variant is found by
+* its name.
+*/
+static int TestDeck_ruleVariantsFindFirstMatch(void) {
+	Rng rng;
+	Rng_seed(&rng, 43);
+	int passed = Rules_fromName("no-such-rules") == -1;
+	int wins = 0; // suit-only and rank-only games seldom end, the top card keeps its suit or rank
+	for (int rules = 0; rules < rulesCount; rules++) {
+		passed &= Rules_fromName(ruleNames[rules]) == rules;
+		for (int i = 0; i < 50; i++) {
+			Game game;
+			passed &= Game_init(&game, 1, &rng) == ok;
+			game.rules = (RuleVariant)rules;
+			for (int t = 0; t < 500 && game.status == ongoing; t++) {
+				int expected = -1;
+				CardDeckIter hand = CardDeck_iter(game.turn == 0 ? &game.p1 : &game.p2);
+				const Card* card;
+				while (expected < 0 && (card = CardDeckIter_next(&hand)) != NULL) {
+					if (Rules_matches(game.rules, card, PlayedPile_top(&game.played))) expected = hand.index - 1;
+				}
+				passed &= CardDeck_findMatch(&game) == expected;
+				Game_playTurn(&game);
+			}
+			passed &= TestDeck_gameCards(&game) == PACK_SIZE;
+			wins += game.status == win;
+			Game_free(&game);
+		}
+	}
+	passed &= wins > 0;
+	return TestDeck_check(passed, "rule variants play the first card their rule accepts");
+}
+
+/**
+* The suit-grouped hands stay equal to the hands they follow, and the
+* highest-card strategy plays a matching card no other matching card in
+* the hand outranks.
+*/
+static int TestDeck_suitHandFollowsHands(void) {
+	Rng rng;
+	Rng_seed(&rng, 44);
+	int passed = 1;
+	int wins = 0;
+	for (int i = 0; i < 60; i++) {
+		Game game;
+		passed &= Game_init(&game, 1 + i % 3, &rng) == ok;
+		passed &= Game_setStrategy(&game, (GameStrategy)(i % 3)) == ok;
+		game.rules = (RuleVariant)(i % rulesCount);
+		for (int t = 0; t < 300 && game.status == ongoing && passed; t++) {
+			int index = Game_chooseMatch(&game);
+			const CardDeck* deck = game.turn == 0 ? &game.p1 : &game.p2;
+			const Card* top = PlayedPile_top(&game.played);
+			int highest = -1;
+			const Card* chosen = NULL;
+			CardDeckIter hand = CardDeck_iter(deck);
+			const Card* card;
+			while ((card = CardDeckIter_next(&hand)) != NULL) {
+				if (Rules_matches(game.rules, card, top) && (int)card->rank > highest) highest = card->rank;
+				if (hand.index - 1 == index) chosen = card;
+			}
+			passed &= (index < 0) == (highest < 0);
+			passed &= index < 0 || (chosen != NULL && Rules_matches(game.rules, chosen, top));
+			if (game.strategy == strategyHighest) passed &= index < 0 || (int)chosen->rank == highest;
+
+			Game_playTurn(&game);
+			for (int p = 0; p < 2 && game.hands != NULL; p++) {
+				SuitHand expected;
+				SuitHand_fromDeck(&expected, p == 0 ? &game.p1 : &game.p2);
+				passed &= memcmp(&expected, &game.hands[p], sizeof(expected)) == 0;
+			}
+		}
+		wins += game.status == win;
+		Game_free(&game);
+	}
+	return TestDeck_check(passed && wins > 0, "suit-grouped hands follow the hands and strategies play matching cards");
+}
+
+/**
+* A sweep gives the same totals on 1 or 3 threads, a cell gives the same
+* totals when it is swept on its own, every game of a cell is counted
+* once, and the rows of its result file agree with the totals and name
+* each game's cell and stream.
+*/
+static int TestDeck_sweepIndependentOfThreads(void) {
+	SweepConfig config;
+	Sweep_defaults(&config);
+	config.minPacks = 1;
+	config.maxPacks = 2;
+	config.minHand = 3;
+	config.maxHand = 4;
+	config.rulesMask = (1u << rulesStandard) | (1u << rulesWildEights);
+	config.strategyMask = (1u << strategyFirstMatch) | (1u << strategyHighest);
+	config.gamesPerCell = SWEEP_CHUNK + 1000; // two tasks per cell
+	config.maxTurns = 300;
+
+	int countOne, countThree, countAlone;
+	config.numThreads = 1;
+	SweepCell* one = Sweep_run(&config, NULL, &countOne);
+	config.numThreads = 3;
+	const char* path = "cardgame_test_sweep.bin";
+	config.results = ResultWriter_open(path, config.seed, RESULT_VARINT);
+	SweepCell* three = Sweep_run(&config, NULL, &countThree);
+	int written = ResultWriter_close(config.results) == 0;
+	config.results = NULL;
+	config.minPacks = config.maxPacks = 2;
+	config.minHand = config.maxHand = 4;
+	config.rulesMask = 1u << rulesWildEights;
+	config.strategyMask = 1u << strategyHighest;
+	SweepCell* alone = Sweep_run(&config, NULL, &countAlone);
+
+	int passed = one != NULL && three != NULL && alone != NULL && countOne == 16 && countThree == 16 && countAlone == 1;
+	if (passed) {
+		passed &= memcmp(one, three, (size_t)countOne * sizeof(SweepCell)) == 0;
+		passed &= memcmp(&one[countOne - 1], alone, sizeof(SweepCell)) == 0; // the last cell of the grid
+		for (int c = 0; c < countOne; c++) {
+			passed &= one[c].games == config.gamesPerCell && one[c].wins[0] + one[c].wins[1] + one[c].unfinished == one[c].games;
+		}
+	}
+
+	// the rows of every cell add up to its totals, and every game lies in its task's chunk
+	ResultFile* file = written ? ResultFile_open(path) : NULL;
+	passed &= file != NULL && file->rows == (uint64_t)countOne * config.gamesPerCell;
+	static uint64_t columns[4][RESULT_BLOCK_ROWS];
+	uint64_t games[16] = { 0 };
+	uint64_t turns[16] = { 0 };
+	for (int b = 0; passed && b < file->count; b++) {
+		int rows = ResultFile_readColumn(file, b, resultCell, columns[0]);
+		passed &= ResultFile_readColumn(file, b, resultGame, columns[1]) == rows;
+		passed &= ResultFile_readColumn(file, b, resultStream, columns[2]) == rows;
+		passed &= ResultFile_readColumn(file, b, resultTurns, columns[3]) == rows;
+		for (int i = 0; passed && i < rows; i++) {
+			int c = 0;
+			while (c < countOne && Sweep_cellKey(&one[c]) != columns[0][i]) c++;
+			passed &= c < countOne && columns[1][i] / SWEEP_CHUNK == columns[2][i];
+			if (c < countOne) {
+				games[c]++;
+				turns[c] += columns[3][i];
+			}
+		}
+	}
+	for (int c = 0; passed && c < countOne; c++) {
+		passed &= games[c] == one[c].games && turns[c] == one[c].turns;
+	}
+	ResultFile_close(file);
+	remove(path);
+	free(one);
+	free(three);
+	free(alone);
+	return TestDeck_check(passed, "sweeps give the same totals on any number of threads and for any grid");
+}
+
+/**
+* Results written with and without varints come back exactly, the block
+* headers hold the minimum and maximum of every column, a campaign writes
+* one row per game that agrees with its totals, a block cut short is left
+* out and a file with a wrong header is refused.
+*/
+static int TestDeck_resultFileRoundTrip(void) {
+	enum { count = RESULT_BLOCK_ROWS + 1000 };
+	const char* path = "cardgame_test_results.bin";
+	static uint64_t values[RESULT_BLOCK_ROWS];
+	GameResult* results = (GameResult*)malloc(count * sizeof(GameResult));
+	if (results == NULL) return TestDeck_check(0, "result files read back what was written");
+	for (int i = 0; i < count; i++) {
+		results[i].game = (1ull << 40) + (uint64_t)i;
+		results[i].winner = i % 3;
+		results[i].turns = (i * 7919) % 5000;
+		results[i].recycles = i % 5;
+		results[i].handSizes[0] = i % 17;
+		results[i].handSizes[1] = 300 + i % 2;
+		results[i].cell = (uint64_t)i / 4096;
+		results[i].stream = (uint64_t)i * 3;
+	}
+
+	int passed = 1;
+	for (int flags = 0; flags <= RESULT_VARINT; flags += RESULT_VARINT) {
+		ResultWriter* writer = ResultWriter_open(path, 77, flags);
+		passed &= writer != NULL;
+		for (int i = 0; passed && i < count; i += 777) {
+			passed &= ResultWriter_add(writer, results + i, count - i < 777 ? count - i : 777) == 0;
+		}
+		passed &= ResultWriter_close(writer) == 0;
+
+		ResultFile* file = ResultFile_open(path);
+		passed &= file != NULL && file->count == 2 && file->rows == count && file->header->seed == 77;
+		for (int b = 0, first = 0; passed && b < file->count; b++) {
+			const ResultBlockHeader* block = ResultFile_block(file, b);
+			passed &= block->columns[resultGame].encoding == (flags ? resultVarint : resultFixed);
+			for (int c = 0; c < resultColumns; c++) {
+				int rows = ResultFile_readColumn(file, b, (ResultColumn)c, values);
+				passed &= rows == (int)block->rows;
+				for (int i = 0; passed && i < rows; i++) {
+					const GameResult* result = &results[first + i];
+					uint64_t expected[resultColumns] = { result->game, (uint64_t)result->winner, (uint64_t)result->turns,
+						(uint64_t)result->recycles, (uint64_t)result->handSizes[0], (uint64_t)result->handSizes[1],
+						result->cell, result->stream };
+					passed &= values[i] == expected[c] && values[i] >= block->columns[c].min && values[i] <= block->columns[c].max;
+				}
+			}
+			first += (int)block->rows;
+		}
+		ResultFile_close(file);
+	}
+	free(results);
+
+	Campaign campaign;
+	Campaign_init(&campaign, 5, 3000, 1, 1000);
+	campaign.results = ResultWriter_open(path, campaign.seed, RESULT_VARINT);
+	passed &= campaign.results != NULL && Campaign_run(&campaign, 1000, NULL, 0) == 0;
+	passed &= ResultWriter_close(campaign.results) == 0;
+	ResultFile* file = ResultFile_open(path);
+	passed &= file != NULL && file->count == 1 && file->rows == 3000;
+	if (passed) {
+		uint64_t wins[3] = { 0, 0, 0 };
+		uint64_t turns = 0;
+		passed &= ResultFile_readColumn(file, 0, resultWinner, values) == 3000;
+		for (int i = 0; i < 3000; i++) wins[values[i] < 3 ? values[i] : 2]++;
+		passed &= ResultFile_readColumn(file, 0, resultTurns, values) == 3000;
+		for (int i = 0; i < 3000; i++) turns += values[i];
+		passed &= wins[0] == campaign.stats.wins[0] && wins[1] == campaign.stats.wins[1] &&
+			wins[2] == campaign.stats.unfinished && turns == campaign.stats.turns;
+		passed &= ResultFile_readColumn(file, 0, resultGame, values) == 3000 && values[0] == 0 && values[2999] == 2999;
+	}
+	ResultFile_close(file);
+
+	// the last 8 bytes cut off, then a byte of the magic number changed
+	static unsigned char bytes[1 << 16];
+	FILE* in = fopen(path, "rb");
+	size_t size = in != NULL ? fread(bytes, 1, sizeof(bytes), in) : 0;
+	if (in != NULL) fclose(in);
+	FILE* out = fopen(path, "wb");
+	passed &= out != NULL && size > 8 && fwrite(bytes, 1, size - 8, out) == size - 8;
+	if (out != NULL) fclose(out);
+	file = ResultFile_open(path);
+	passed &= file != NULL && file->count == 0 && file->rows == 0;
+	ResultFile_close(file);
+	FILE* corrupt = fopen(path, "r+b");
+	if (corrupt != NULL) {
+		fputc('X', corrupt);
+		fclose(corrupt);
+		passed &= ResultFile_open(path) == NULL;
+	}
+	remove(path);
+	return TestDeck_check(passed, "result files read back what was written");
+}
+
+/**
+* The same random operations give the same cards on every deck backend,
+* and the shuffle of every backend passes the chi-square test.
+*/
+static int TestDeck_backendsAgree(void) {
+	DiffReport report;
+	int passed = 1;
+	for (int packs = 1; packs <= 3; packs += 2) {
+		passed &= DeckDiff_run(47 + (uint64_t)packs, 100000, packs, &report) == 0;
+		for (int b = 0; b < diffBackends; b++) {
+			passed &= report.backends[b].ops == 100000;
+			if (report.backends[b].mismatch >= 0) {
+				printf("      %s differs from %s after operation %lld\n", report.backends[b].name,
+					report.backends[diffList].name, report.backends[b].mismatch);
+			}
+		}
+	}
+	for (int b = 0; b < diffBackends; b++) {
+		double chi = DeckDiff_shuffleChiSquare((DiffBackend)b, 24 * 1000, 470 + (uint64_t)b);
+		passed &= chi >= 0 && chi < CHI_SQUARE_23_P001;
+		printf("      %s shuffle chi-square %.2f (critical %.2f)\n", report.backends[b].name, chi, CHI_SQUARE_23_P001);
+	}
+	return TestDeck_check(passed, "deck backends agree on every operation and shuffle uniformly");
+}
+
+/**
+* The tallies stay equal to the cards they stand for through whole games
+* of every strategy and rule variant, recycles included, and losing,
+* doubling or changing a card fails the check.
+*/
+static int TestDeck_cardsAreConserved(void) {
+	Rng rng;
+	Rng_seed(&rng, 48);
+	int passed = 1;
+	int recycles = 0;
+	for (int i = 0; i < 60; i++) {
+		Game game;
+		passed &= Game_init(&game, 1 + i % 4, &rng) == ok;
+		passed &= Game_setStrategy(&game, (GameStrategy)(i % strategyCount)) == ok;
+		game.rules = (RuleVariant)(i % rulesCount);
+		for (int t = 0; t < 500 && game.status == ongoing && passed; t++) {
+			Game_playTurn(&game);
+			uint64_t played = game.played.count > 0 ? cardKeys[game.played.top] : 0;
+			for (int c = 0; c < game.played.count - 1; c++) played += cardKeys[game.played.cards[c]];
+			passed &= Game_checkCards(&game) && played == game.played.tally;
+			passed &= CardDeck_checkTally(&game.hidden) && CardDeck_checkTally(&game.p1) && CardDeck_checkTally(&game.p2);
+		}
+		recycles += game.recycles;
+
+		if (game.p1.head->successor != NULL) {
+			Card card = game.p1.head->successor->card;
+			passed &= CardDeck_insertToTop(&game.p2, card) == ok && !Game_checkCards(&game);
+			free(CardDeck_useTop(&game.p2, NULL));
+			passed &= Game_checkCards(&game);
+			free(CardDeck_useTop(&game.p1, NULL));
+			passed &= !Game_checkCards(&game);
+			passed &= CardDeck_insertToTop(&game.p1, card) == ok && Game_checkCards(&game);
+			game.p1.head->successor->card.rank = (Rank)((card.rank + 1) % 13);
+			passed &= !CardDeck_checkTally(&game.p1);
+		}
+		Game_free(&game);
+	}
+	return TestDeck_check(passed && recycles > 0, "games keep every card they are dealt");
+}
+
+/**
+* Fills a result with samples of 1 ms times scale, spread by up to 2% in
+* an order that depends on run.
+*/
+static void TestDeck_regressSamples(RegressResult* result, int run, double scale) {
+	snprintf(result->name, sizeof(result->name), "kernel");
+	result->count = REGRESS_SAMPLES;
+	for (int i = 0; i < REGRESS_SAMPLES; i++) {
+		result->samples[i] = 1e-3 * scale * (1.0 + 0.001 * ((i * 7 + run * 3) % 21));
+	}
+	Regress_summarize(result);
+}
+
+/**
+* The median and its interval come from the right order statistics, a
+* run like the baseline runs is not flagged while one that is 50% slower
+* or faster is, and baseline files read back the runs written to them.
+*/
+static int TestDeck_regressionsAreFlagged(void) {
+	const char* path = "cardgame_test_baseline.txt";
+	int passed = 1;
+	RegressResult result;
+	result.count = 21;
+	for (int i = 0; i < 21; i++) result.samples[i] = (double)((i * 8) % 21 + 1);
+	Regress_summarize(&result);
+	passed &= result.median == 11.0 && result.low == 6.0 && result.high == 16.0;
+
+	RegressResult runs[5];
+	for (int r = 0; r < 5; r++) TestDeck_regressSamples(&runs[r], r, 1.0 + 0.01 * r);
+	RegressComparison comparison;
+	static const double scales[] = { 1.02, 1.5, 0.6 };
+	static const RegressVerdict verdicts[] = { regressSame, regressSlower, regressFaster };
+	for (int c = 0; c < 3; c++) {
+		TestDeck_regressSamples(&result, 5, scales[c]);
+		Regress_compare(runs, 5, &result, &comparison);
+		passed &= comparison.verdict == verdicts[c] && comparison.noise >= REGRESS_MIN_CHANGE;
+	}
+	Regress_compare(runs, 0, &result, &comparison);
+	passed &= comparison.verdict == regressNew;
+	Regress_pool(runs, 5, &result);
+	Regress_compare(runs, 5, &result, &comparison);
+	passed &= result.count == 5 * REGRESS_SAMPLES && comparison.verdict == regressSame;
+
+	remove(path);
+	passed &= Regress_append(path, runs, 2) == 0 && Regress_append(path, runs + 2, 3) == 0;
+	int count = 0;
+	RegressResult* loaded = Regress_load(path, &count);
+	passed &= loaded != NULL && count == 5;
+	for (int r = 0; r < count && passed; r++) {
+		passed &= strcmp(loaded[r].name, runs[r].name) == 0 && loaded[r].count == runs[r].count;
+		for (int i = 0; i < runs[r].count; i++) {
+			passed &= fabs(loaded[r].samples[i] / runs[r].samples[i] - 1.0) < 1e-8;
+		}
+	}
+	free(loaded);
+	remove(path);
+	return TestDeck_check(passed, "regressions against a baseline are flagged and baselines read back");
+}
+
+#define POOL_TEST_THREADS 200 // threads started one after another by the pool test
+
+static int TestDeck_poolThread(void* arg) {
+	CardDeck* deck = CardDeck_createOrdered(2);
+	if (deck == NULL) return 1;
+	Card* card = CardDeck_useTop(deck, NULL);
+	free(card);
+	CardDeck_delete(deck);
+	return 0;
+}
+
+static int TestDeck_poolReusesExitedThreads(void) {
+	thrd_t thread;
+	int failed = 0;
+	long long before = 0;
+	for (int t = 0; t < POOL_TEST_THREADS; t++) {
+		if (t == 1) before = CardDeck_poolNodes();
+		int result = 1;
+		if (thrd_create(&thread, TestDeck_poolThread, NULL) != thrd_success) return TestDeck_check(0, "node pool reuses the nodes of exited threads");
+		thrd_join(thread, &result);
+		failed |= result;
+	}
+	// every thread after the first finds the nodes the previous one left
+	return TestDeck_check(!failed && CardDeck_poolNodes() == before, "node pool reuses the nodes of exited threads");
+}
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define WRITER_TEST_PRODUCERS 8 // threads adding results at once
+#define WRITER_TEST_BATCHES 16 // calls of ResultWriter_add per thread
+#define WRITER_TEST_BATCH 4096 // results per call
+
+typedef struct {
+	const char* fifo; // the writer's output
+	const char* copy; // receives what comes through the fifo
+	int failed;
+} SlowReader;
+
+typedef struct {
+	ResultWriter* writer;
+	int producer;
+	int failed;
+} ResultProducer;
+
+/**
+* Copies the fifo to a file slowly, so the writer's thread stalls and the producers fill both buffers.
+*/
+static int TestDeck_slowReader(void* arg) {
+	SlowReader* reader = (SlowReader*)arg;
+	static unsigned char chunk[1 << 16];
+	FILE* in = fopen(reader->fifo, "rb");
+	FILE* out = fopen(reader->copy, "wb");
+	size_t got;
+	reader->failed = in == NULL || out == NULL;
+	while (!reader->failed && (got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+		reader->failed = fwrite(chunk, 1, got, out) != got;
+		thrd_sleep(&(struct timespec){ .tv_sec = 0, .tv_nsec = 2000000 }, NULL);
+	}
+	if (in != NULL) fclose(in);
+	if (out != NULL) reader->failed |= fclose(out) != 0;
+	return 0;
+}
+
+static int TestDeck_resultProducer(void* arg) {
+	ResultProducer* producer = (ResultProducer*)arg;
+	static _Thread_local GameResult results[WRITER_TEST_BATCH];
+	for (int b = 0; b < WRITER_TEST_BATCHES && !producer->failed; b++) {
+		for (int i = 0; i < WRITER_TEST_BATCH; i++) {
+			memset(&results[i], 0, sizeof(results[i]));
+			results[i].game = ((uint64_t)producer->producer << 32) | (uint64_t)(b * WRITER_TEST_BATCH + i);
+		}
+		producer->failed = ResultWriter_add(producer->writer, results, WRITER_TEST_BATCH) != 0;
+	}
+	return 0;
+}
+
+/**
+* Several threads adding to a writer whose output is slow lose no rows,
+* and the rows of every call stay together and in order.
+*/
+static int TestDeck_resultWriterProducers(void) {
+	const char* fifo = "cardgame_test_results.fifo";
+	SlowReader reader = { fifo, "cardgame_test_results_copy.bin", 0 };
+	remove(fifo);
+	if (mkfifo(fifo, 0600) != 0) return TestDeck_check(0, "result writer takes rows from many threads at once");
+	thrd_t readerThread;
+	thrd_create(&readerThread, TestDeck_slowReader, &reader);
+
+	ResultWriter* writer = ResultWriter_open(fifo, 1, RESULT_VARINT);
+	int passed = writer != NULL;
+	ResultProducer producers[WRITER_TEST_PRODUCERS];
+	thrd_t threads[WRITER_TEST_PRODUCERS];
+	for (int t = 0; passed && t < WRITER_TEST_PRODUCERS; t++) {
+		producers[t] = (ResultProducer){ writer, t, 0 };
+		thrd_create(&threads[t], TestDeck_resultProducer, &producers[t]);
+	}
+	for (int t = 0; passed && t < WRITER_TEST_PRODUCERS; t++) {
+		thrd_join(threads[t], NULL);
+		passed &= !producers[t].failed;
+	}
+	passed &= ResultWriter_close(writer) == 0;
+	if (writer == NULL) fclose(fopen(fifo, "wb")); // lets the reader finish
+	thrd_join(readerThread, NULL);
+	passed &= !reader.failed;
+
+	ResultFile* file = passed ? ResultFile_open(reader.copy) : NULL;
+	passed &= file != NULL && file->rows == (uint64_t)WRITER_TEST_PRODUCERS * WRITER_TEST_BATCHES * WRITER_TEST_BATCH;
+	static uint64_t values[RESULT_BLOCK_ROWS];
+	uint64_t next[WRITER_TEST_PRODUCERS] = { 0 };
+	uint64_t previous = 0;
+	for (int b = 0; passed && b < file->count; b++) {
+		int rows = ResultFile_readColumn(file, b, resultGame, values);
+		for (int i = 0; passed && i < rows; i++) {
+			uint64_t producer = values[i] >> 32;
+			uint64_t index = values[i] & 0xFFFFFFFFu;
+			passed &= producer < WRITER_TEST_PRODUCERS && index == next[producer]++;
+			// a row that does not start a call follows the row before it in the same call
+			passed &= index % WRITER_TEST_BATCH == 0 || values[i] == previous + 1;
+			previous = values[i];
+		}
+	}
+	ResultFile_close(file);
+	remove(fifo);
+	remove(reader.copy);
+	return TestDeck_check(passed, "result writer takes rows from many threads at once");
+}
+
+/**
+* A sweep on eight threads writes every game to a result file whose output
+* is slow, and the rows of every cell add up to the cell's totals.
+*/
+static int TestDeck_sweepWritesFromThreads(void) {
+	const char* fifo = "cardgame_test_sweep.fifo";
+	SlowReader reader = { fifo, "cardgame_test_sweep_copy.bin", 0 };
+	remove(fifo);
+	if (mkfifo(fifo, 0600) != 0) return TestDeck_check(0, "sweeps on many threads write every game");
+	thrd_t readerThread;
+	thrd_create(&readerThread, TestDeck_slowReader, &reader);
+
+	SweepConfig config;
+	Sweep_defaults(&config);
+	config.minPacks = config.maxPacks = 1;
+	config.minHand = 3;
+	config.maxHand = 4;
+	config.rulesMask = 1u << rulesStandard;
+	config.strategyMask = (1u << strategyFirstMatch) | (1u << strategyHighest);
+	config.gamesPerCell = 12 * SWEEP_CHUNK; // 3 blocks of rows in all, in 48 calls
+	config.maxTurns = 300;
+	config.numThreads = 8;
+	config.results = ResultWriter_open(fifo, config.seed, RESULT_VARINT);
+	int numCells = 0;
+	SweepCell* cells = config.results != NULL ? Sweep_run(&config, NULL, &numCells) : NULL;
+	int passed = cells != NULL && numCells == 4;
+	passed &= ResultWriter_close(config.results) == 0;
+	if (config.results == NULL) fclose(fopen(fifo, "wb")); // lets the reader finish
+	thrd_join(readerThread, NULL);
+	passed &= !reader.failed;
+
+	ResultFile* file = passed ? ResultFile_open(reader.copy) : NULL;
+	passed &= file != NULL && file->rows == 4 * config.gamesPerCell;
+	static uint64_t cellKeys[RESULT_BLOCK_ROWS];
+	static uint64_t turns[RESULT_BLOCK_ROWS];
+	uint64_t cellGames[4] = { 0 };
+	uint64_t cellTurns[4] = { 0 };
+	for (int b = 0; passed && b < file->count; b++) {
+		int rows = ResultFile_readColumn(file, b, resultCell, cellKeys);
+		passed &= ResultFile_readColumn(file, b, resultTurns, turns) == rows;
+		for (int i = 0; passed && i < rows; i++) {
+			int c = 0;
+			while (c < numCells && Sweep_cellKey(&cells[c]) != cellKeys[i]) c++;
+			passed &= c < numCells;
+			if (c < numCells) {
+				cellGames[c]++;
+				cellTurns[c] += turns[i];
+			}
+		}
+	}
+	for (int c = 0; passed && c < numCells; c++) {
+		passed &= cellGames[c] == cells[c].games && cellTurns[c] == cells[c].turns;
+	}
+	ResultFile_close(file);
+	free(cells);
+	remove(fifo);
+	remove(reader.copy);
+	return TestDeck_check(passed, "sweeps on many threads write every game");
+}
+
+static int TestDeck_serverThread(void* address) {
+	return GameServer_run((const char*)address);
+}
+
+/**
+* A load generator plays whole games on a server on another thread,
+* and every request it sends is accepted.
+*/
+static int TestDeck_serverPlaysGames(void) {
+	char address[64];
+	snprintf(address, sizeof(address), "/tmp/cardgame_test_%d.sock", (int)getpid());
+	thrd_t server;
+	if (thrd_create(&server, TestDeck_serverThread, address) != thrd_success) {
+		return TestDeck_check(0, "server plays games for the load generator");
+	}
+
+	LoadGenResult result;
+	int passed = LoadGen_run(address, 32, 2, 20000, &result) == EXIT_SUCCESS;
+	passed &= LoadGen_shutdown(address) == EXIT_SUCCESS;
+	int serverStatus = EXIT_FAILURE;
+	thrd_join(server, &serverStatus);
+	passed &= serverStatus == EXIT_SUCCESS && result.turns >= 20000 - 32 && result.games > 0 && result.errors == 0;
+	return TestDeck_check(passed, "server plays games for the load generator");
+}
+#endif
+
+/**
+* Runs every deck test.
+*
+* @return EXIT_SUCCESS if all passed, otherwise EXIT_FAILURE
+*/
+int TestDeck_runAll(void) {
+	int failures = 0;
+	failures += TestDeck_shuffleUniformity(0);
+	failures += TestDeck_shuffleUniformity(1);
+	failures += TestDeck_shuffleParallelKeepsCards();
+	failures += TestDeck_chunkDeckMatchesList();
+	failures += TestDeck_indexedDeckMatchesList();
+	failures += TestDeck_iteratorKeepsCurrent();
+	failures += TestDeck_sharedShoeDealsEveryCard();
+	failures += TestDeck_interleavedGamesMatchSequential();
+	failures += TestDeck_scenarioRoundTrip();
+	failures += TestDeck_formatMatchesPrintf();
+	failures += TestDeck_campaignResumes();
+	failures += TestDeck_streamsIndependentOfThreads();
+	failures += TestDeck_playedPileRecyclesLikeList();
+	failures += TestDeck_solverFindsBestPlay();
+	failures += TestDeck_ruleVariantsFindFirstMatch();
+	failures += TestDeck_suitHandFollowsHands();
+	failures += TestDeck_sweepIndependentOfThreads();
+	failures += TestDeck_resultFileRoundTrip();
+	failures += TestDeck_backendsAgree();
+	failures += TestDeck_cardsAreConserved();
+	failures += TestDeck_regressionsAreFlagged();
+	failures += TestDeck_poolReusesExitedThreads();
+#ifdef __linux__
+	failures += TestDeck_resultWriterProducers();
+	failures += TestDeck_sweepWritesFromThreads();
+	failures += TestDeck_serverPlaysGames();
+#endif
+
+	printf("%d test(s) failed\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file test_deck.h
+ * Provides interface for the deck tests.
+ * Run them with "<program> test".
+ *
+ * @date 19.10.2026
+*/
+
+#ifndef TEST_DECK_H
+#define TEST_DECK_H
+
+int TestDeck_runAll(void);
+
+#endif
@@ -1,10 +1,135 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "Card.h"
 #include "CardDeck.h"
+#include "bench.h"
+#include "test_deck.h"
+#include "GameServer.h"
+#include "LoadGen.h"
+#include "Campaign.h"
+#include "Sweep.h"
+#include "Rules.h"
+#include "Regress.h"
+#include "Train.h"
 
 
-int main(void){
+int main(int argc, char* argv[]){
+	// "bench [name]" runs the micro benchmarks instead of the interactive demo
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		return Bench_run(argc > 2 ? argv[2] : NULL);
+	}
+	// "regress <baseline> [save | <runs>]" times the regression kernels and compares them with the baseline file,
+	// storing the run as the baseline if there is none yet or save is given; given a second baseline file, its
+	// runs are compared instead of timing a new one, see Regress.h
+	if (argc > 2 && strcmp(argv[1], "regress") == 0) {
+		int save = argc > 3 && strcmp(argv[3], "save") == 0;
+		return Regress_run(argv[2], save, argc > 3 && !save ? argv[3] : NULL);
+	}
+	// "train [rounds]" plays the training workload of profile-guided builds, see Train.h
+	if (argc > 1 && strcmp(argv[1], "train") == 0) {
+		TrainReport report;
+		int status = Train_run(argc > 2 ? atoi(argv[2]) : TRAIN_ROUNDS, &report);
+		printf("train: %lld games, %lld turns, %lld recycles, %lld shuffles, %lld sorts, %lld hand operations in %.2f s\n",
+			report.games, report.turns, report.recycles, report.shuffles, report.sorts, report.handOps, report.seconds);
+		return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	// "test" runs the deck tests
+	if (argc > 1 && strcmp(argv[1], "test") == 0) {
+		return TestDeck_runAll();
+	}
+	// "serve [address]" hosts game tables until stopped, see GameServer.h for addresses
+	if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+		return GameServer_run(argc > 2 ? argv[2] : SERVER_DEFAULT_ADDRESS);
+	}
+	// "loadgen [address] [tables] [connections] [turns]" plays tables on a running server
+	if (argc > 1 && strcmp(argv[1], "loadgen") == 0) {
+		const char* address = argc > 2 ? argv[2] : SERVER_DEFAULT_ADDRESS;
+		int tables = argc > 3 ? atoi(argv[3]) : 1024;
+		int connections = argc > 4 ? atoi(argv[4]) : 4;
+		long long turns = argc > 5 ? atoll(argv[5]) : 2000000;
+		LoadGenResult result;
+		int status = LoadGen_run(address, tables, connections, turns, &result);
+		printf("loadgen: %lld turns, %lld games won, %lld errors in %.2f s\n",
+			result.turns, result.games, result.errors, result.seconds);
+		printf("loadgen: %d tables  %.0f turns/s  p50 %.1f us  p99 %.1f us\n",
+			tables, result.turns / (result.seconds > 0 ? result.seconds : 1), result.p50, result.p99);
+		return status;
+	}
+	// "campaign <checkpoint> [games] [seed] [results]" plays a long campaign, resuming from the checkpoint if it
+	// exists, and writes the result of every game it plays to a result file (see ResultFile.h) if one is given
+	if (argc > 2 && strcmp(argv[1], "campaign") == 0) {
+		Campaign campaign;
+		if (Campaign_load(&campaign, argv[2]) == 0) {
+			printf("campaign: resuming at game %llu of %llu\n",
+				(unsigned long long)campaign.nextGame, (unsigned long long)campaign.numGames);
+		}
+		else {
+			uint64_t games = argc > 3 ? strtoull(argv[3], NULL, 10) : 100000000;
+			uint64_t seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+			Campaign_init(&campaign, seed, games, 1, 1000);
+		}
+		if (argc > 5 && (campaign.results = ResultWriter_open(argv[5], campaign.seed, RESULT_VARINT)) == NULL) {
+			printf("campaign: cannot create %s\n", argv[5]);
+			return EXIT_FAILURE;
+		}
+		int status = Campaign_run(&campaign, 0, argv[2], 60.0);
+		status |= ResultWriter_close(campaign.results);
+		CampaignStats* stats = &campaign.stats;
+		printf("campaign: %llu games, %llu turns, won by player 1 %llu, player 2 %llu, unfinished %llu, longest %llu turns\n",
+			(unsigned long long)stats->games, (unsigned long long)stats->turns, (unsigned long long)stats->wins[0],
+			(unsigned long long)stats->wins[1], (unsigned long long)stats->unfinished, (unsigned long long)stats->longest);
+		return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// "sweep <results.tsv> [games per cell] [threads] [games] [rules...]" plays every pack count, hand size and
+	// strategy under the given rule variants (see Rules.h), or under the default ones of Sweep_defaults, and writes
+	// the result of every game to the result file games (see ResultFile.h) unless it is "-"
+	if (argc > 2 && strcmp(argv[1], "sweep") == 0) {
+		SweepConfig config;
+		Sweep_defaults(&config);
+		if (argc > 3) config.gamesPerCell = strtoull(argv[3], NULL, 10);
+		if (argc > 4) config.numThreads = atoi(argv[4]);
+		if (argc > 6) config.rulesMask = 0;
+		for (int i = 6; i < argc; i++) {
+			int rules = Rules_fromName(argv[i]);
+			if (rules < 0) {
+				printf("sweep: unknown rules %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+			config.rulesMask |= 1u << rules;
+		}
+		FILE* out = fopen(argv[2], "w");
+		if (out == NULL) {
+			printf("sweep: cannot write %s\n", argv[2]);
+			return EXIT_FAILURE;
+		}
+		if (argc > 5 && strcmp(argv[5], "-") != 0 &&
+			(config.results = ResultWriter_open(argv[5], config.seed, RESULT_VARINT)) == NULL) {
+			printf("sweep: cannot write %s\n", argv[5]);
+			fclose(out);
+			return EXIT_FAILURE;
+		}
+		int numCells;
+		double start = Bench_seconds();
+		SweepCell* cells = Sweep_run(&config, out, &numCells);
+		double elapsed = Bench_seconds() - start;
+		fclose(out);
+		if (ResultWriter_close(config.results) != 0) {
+			free(cells);
+			cells = NULL;
+		}
+		if (cells == NULL) {
+			printf("sweep: failed\n");
+			return EXIT_FAILURE;
+		}
+		unsigned long long games = 0;
+		for (int c = 0; c < numCells; c++) games += cells[c].games;
+		printf("sweep: %d cells, %llu games in %.1f s, %.0f games/s\n", numCells, games, elapsed, games / elapsed);
+		free(cells);
+		return EXIT_SUCCESS;
+	}
+
 	/*
 	// creates an ace of hearts
 	Card card1;